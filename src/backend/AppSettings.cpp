@@ -204,8 +204,9 @@ void AppSettings::save_config()
 {
     appsettings::SaveContext().save();
 
-    ScriptRunner::run(ScriptEvent::CONFIG_CHANGED);
-    ScriptRunner::run(ScriptEvent::SETTINGS_CHANGED);
+    ScriptRunner::run_async(ScriptEvent::CONFIG_CHANGED, {}, [](){
+        ScriptRunner::run_async(ScriptEvent::SETTINGS_CHANGED, {});
+    });
 }
 
 void AppSettings::load_providers()
@@ -44,6 +44,9 @@ struct General {
     bool verify_files = true;
     bool scan_on_launch = true;
     bool show_missing_games = false;
+    bool watch_game_dirs = false;
+    bool keep_frontend_alive = false;
+    int script_timeout_sec = 0; // 0 means no limit
     QString locale;
     QString theme;
 
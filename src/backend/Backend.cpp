@@ -98,11 +98,16 @@ void register_api_classes()
     qqsfpm::registerQQmlSortFilterProxyModelTypes();
 }
 
-void on_app_close(AppCloseType type)
+void on_app_close(AppCloseType type, model::Memory& theme_memory)
 {
     if (type == AppCloseType::SUSPEND) {
         return platform::power::suspend();
     }
+
+    // On reboot and shutdown the destructors may not get to run,
+    // so the delayed writes of the theme are done here
+    theme_memory.flush();
+
     ScriptRunner::run(ScriptEvent::QUIT);
     switch (type) {
         case AppCloseType::REBOOT:
@@ -148,6 +153,9 @@ Backend::~Backend()
 #if defined(WITH_SDL_GAMEPAD) || defined(WITH_SDL_POWER)
     SDL_Quit();
 #endif
+
+    // in case the app was closed by other means than the menu
+    Log::close();
 }
 
 Backend::Backend(const CliArgs& args)
@@ -213,9 +221,11 @@ Backend::Backend(const CliArgs& args)
                      m_api_public->keysPtr(), &model::Keys::refresh_keys);
     QObject::connect(m_api_private->settingsPtr(), &model::Settings::providerReloadingRequested,
                      [this](){ onScanRequested(true); });
+    QObject::connect(m_api_private->settingsPtr(), &model::Settings::watchGameDirsChanged,
+                     [this](){ m_providerman->setWatching(AppSettings::general.watch_game_dirs); });
 
-    QObject::connect(m_api_public, &model::ApiObject::favoritesChanged,
-                     [this](){ onFavoritesChanged(); });
+    QObject::connect(m_api_public, &model::ApiObject::gameFavoriteChanged,
+                     [this](model::Game* const game){ onFavoriteChanged(game); });
 
     // Loading progress
     QObject::connect(m_providerman, &ProviderManager::scanStarted,
@@ -229,18 +239,24 @@ Backend::Backend(const CliArgs& args)
     QObject::connect(m_api_public, &model::ApiObject::gamedataReady,
                      m_api_private->scannerPtr(), &model::ScannerState::onUiReady);
 
+    // live updates are prepared in the background, but applied on the main thread
+    QObject::connect(m_providerman, &ProviderManager::liveUpdateReady,
+                     m_providerman, [this](){ onLiveUpdateReady(); });
+
     // partial QML reload
     QObject::connect(&m_api_private->meta(), &model::Meta::qmlClearCacheRequested,
                      m_frontend, &FrontendLayer::clearCache);
 
     // quit/reboot/shutdown request
-    QObject::connect(&m_api_private->system(), &model::System::appCloseRequested, on_app_close);
+    QObject::connect(&m_api_private->system(), &model::System::appCloseRequested,
+                     [this](AppCloseType type){ on_app_close(type, m_api_public->memory()); });
 }
 
 void Backend::start()
 {
     m_api_private->settings().postInit();
     onProcessFinished();
+    m_providerman->setWatching(AppSettings::general.watch_game_dirs);
     onScanRequested(AppSettings::general.scan_on_launch);
 }
 
@@ -261,20 +277,43 @@ void Backend::onScanFinished()
     m_api_public->setGameData(std::move(colls), std::move(games));
 }
 
-void Backend::onFavoritesChanged()
+void Backend::onLiveUpdateReady()
 {
-    m_providerman->onFavoritesChanged(m_api_public->allGames()->entries());
+    LibraryPatch patch;
+    const bool can_patch = m_providerman->takeLiveUpdate(
+        m_api_public->collections()->entries(),
+        m_api_public->allGames()->entries(),
+        patch);
+
+    if (can_patch)
+        m_api_public->patchGameData(std::move(patch));
+    else
+        onScanRequested(true);
+}
+
+void Backend::onFavoriteChanged(model::Game* const game)
+{
+    m_providerman->onFavoriteChanged(game);
 }
 
 void Backend::onProcessLaunched()
 {
-    m_frontend->teardown();
+    if (AppSettings::general.keep_frontend_alive)
+        m_frontend->suspend();
+    else
+        m_frontend->teardown();
+
     m_api_private->gamepad().stop();
 }
 
 void Backend::onProcessFinished()
 {
-    m_frontend->rebuild();
+    // the setting may have changed since the launch
+    if (m_frontend->isSuspended())
+        m_frontend->resume();
+    else
+        m_frontend->rebuild();
+
     m_api_private->gamepad().start(m_args);
 }
 
@@ -21,6 +21,7 @@
 
 namespace model { class ApiObject; }
 namespace model { class Internal; }
+namespace model { class Game; }
 class FrontendLayer;
 class ProcessLauncher;
 class ProviderManager;
@@ -52,7 +53,8 @@ private:
 
     void onScanRequested(bool force_refresh = false);
     void onScanFinished();
-    void onFavoritesChanged();
+    void onLiveUpdateReady();
+    void onFavoriteChanged(model::Game* const);
     void onProcessLaunched();
     void onProcessFinished();
 };
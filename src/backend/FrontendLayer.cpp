@@ -17,6 +17,7 @@
 
 #include "FrontendLayer.h"
 
+#include "Log.h"
 #include "Paths.h"
 #include "imggen/BlurhashProvider.h"
 #include "utils/DiskCachedNAM.h"
@@ -25,9 +26,12 @@
 #include "platform/AndroidAppIconProvider.h"
 #endif
 
+#include <QPixmapCache>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <QQmlNetworkAccessManagerFactory>
+#include <QQuickWindow>
+#include <memory>
 
 
 namespace {
@@ -42,6 +46,45 @@ QNetworkAccessManager* DiskCachedNAMFactory::create(QObject* parent)
     return utils::create_disc_cached_nam(parent);
 }
 
+// Most QML types have no public class, so they are recognized by name
+bool inherits_class(const QMetaObject* meta, const char* const class_name)
+{
+    for (; meta; meta = meta->superClass()) {
+        if (qstrcmp(meta->className(), class_name) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool is_running_timer(const QObject& obj)
+{
+    return qstrcmp(obj.metaObject()->className(), "QQmlTimer") == 0
+        && obj.property("running").toBool();
+}
+
+// Animations and AnimatedImage keep running in hidden windows, but both can be paused
+bool is_pausable_running(const QObject& obj)
+{
+    const QMetaObject* const meta = obj.metaObject();
+    if (inherits_class(meta, "QQuickAbstractAnimation"))
+        return obj.property("running").toBool() && !obj.property("paused").toBool();
+    if (inherits_class(meta, "QQuickAnimatedImage"))
+        return obj.property("playing").toBool() && !obj.property("paused").toBool();
+    return false;
+}
+
+// Audio, MediaPlayer and the player of Video, in both Qt 5 and 6
+bool is_playing_media(const QObject& obj)
+{
+    constexpr int PLAYING_STATE = 1;
+
+    const QMetaObject* const meta = obj.metaObject();
+    return meta->indexOfProperty("playbackState") >= 0
+        && meta->indexOfMethod("play()") >= 0
+        && meta->indexOfMethod("pause()") >= 0
+        && obj.property("playbackState").toInt() == PLAYING_STATE;
+}
+
 } // namespace
 
 
@@ -50,6 +93,7 @@ FrontendLayer::FrontendLayer(QObject* const api_public, QObject* const api_priva
     , m_api_public(api_public)
     , m_api_private(api_private)
     , m_engine(nullptr)
+    , m_suspended(false)
 {
     // Note: the pointer to the Api is non-owning and constant during the runtime
 }
@@ -57,6 +101,7 @@ FrontendLayer::FrontendLayer(QObject* const api_public, QObject* const api_priva
 void FrontendLayer::rebuild()
 {
     Q_ASSERT(!m_engine);
+    m_transition_timer.start();
 
     m_engine = new QQmlApplicationEngine(this);
     m_engine->addImportPath(QStringLiteral("lib/qml"));
@@ -73,21 +118,127 @@ void FrontendLayer::rebuild()
     m_engine->rootContext()->setContextProperty(QStringLiteral("Internal"), m_api_private);
     m_engine->load(QUrl(QStringLiteral("qrc:/frontend/main.qml")));
 
+    Log::info(LOGMSG("Loading the frontend took %1ms").arg(m_transition_timer.elapsed()));
+    log_first_frame(QStringLiteral("rebuilding"));
     emit rebuildComplete();
 }
 
 void FrontendLayer::teardown()
 {
     Q_ASSERT(m_engine);
+    m_transition_timer.start();
 
     // signal forwarding
     connect(m_engine, &QQmlApplicationEngine::destroyed,
-            this, &FrontendLayer::teardownComplete);
+            this, [this]{
+                Log::info(LOGMSG("Tearing down the frontend took %1ms").arg(m_transition_timer.elapsed()));
+                emit teardownComplete();
+            });
 
     m_engine->deleteLater();
     m_engine = nullptr;
 }
 
+void FrontendLayer::suspend()
+{
+    Q_ASSERT(m_engine);
+    Q_ASSERT(!m_suspended);
+    m_transition_timer.start();
+    m_suspended = true;
+
+    for (QObject* const root : m_engine->rootObjects()) {
+        for (QObject* const child : root->findChildren<QObject*>()) {
+            if (is_running_timer(*child)) {
+                child->setProperty("running", false);
+                m_stopped_timers.emplace_back(child);
+            }
+            else if (is_pausable_running(*child)) {
+                child->setProperty("paused", true);
+                m_paused_objects.emplace_back(child);
+            }
+            else if (is_playing_media(*child)) {
+                QMetaObject::invokeMethod(child, "pause");
+                m_paused_players.emplace_back(child);
+            }
+        }
+
+        // Hiding the window only stops the rendering, the animations are paused above
+        auto* const window = qobject_cast<QQuickWindow*>(root);
+        if (window && window->isVisible()) {
+            m_hidden_windows.emplace_back(window, window->visibility());
+            window->setPersistentSceneGraph(false);
+            window->setPersistentOpenGLContext(false);
+            window->hide();
+            window->releaseResources();
+        }
+    }
+
+    QPixmapCache::clear();
+    m_engine->trimComponentCache();
+    m_engine->collectGarbage();
+
+    Log::info(LOGMSG("Suspending the frontend took %1ms").arg(m_transition_timer.elapsed()));
+
+    // asynchronous like the teardown, so the callers can be the same
+    QMetaObject::invokeMethod(this, "teardownComplete", Qt::QueuedConnection);
+}
+
+void FrontendLayer::resume()
+{
+    Q_ASSERT(m_engine);
+    Q_ASSERT(m_suspended);
+    m_transition_timer.start();
+    m_suspended = false;
+
+    for (const auto& entry : m_hidden_windows) {
+        if (entry.first) {
+            entry.first->setVisibility(entry.second);
+            entry.first->requestActivate();
+        }
+    }
+    m_hidden_windows.clear();
+
+    for (const QPointer<QObject>& timer : m_stopped_timers) {
+        if (timer)
+            timer->setProperty("running", true);
+    }
+    m_stopped_timers.clear();
+
+    for (const QPointer<QObject>& obj : m_paused_objects) {
+        if (obj)
+            obj->setProperty("paused", false);
+    }
+    m_paused_objects.clear();
+
+    for (const QPointer<QObject>& player : m_paused_players) {
+        if (player)
+            QMetaObject::invokeMethod(player, "play");
+    }
+    m_paused_players.clear();
+
+    log_first_frame(QStringLiteral("resuming"));
+    emit rebuildComplete();
+}
+
+void FrontendLayer::log_first_frame(const QString& action)
+{
+    QQuickWindow* window = nullptr;
+    for (QObject* const root : m_engine->rootObjects()) {
+        window = qobject_cast<QQuickWindow*>(root);
+        if (window)
+            break;
+    }
+    if (!window)
+        return;
+
+    auto connection = std::make_shared<QMetaObject::Connection>();
+    *connection = connect(window, &QQuickWindow::frameSwapped, this, [this, connection, action]{
+        QObject::disconnect(*connection);
+        Log::info(LOGMSG("The first frame after %1 the frontend was shown after %2ms")
+            .arg(action, QString::number(m_transition_timer.elapsed())));
+    });
+}
+
 void FrontendLayer::clearCache()
 {
     Q_ASSERT(m_engine);
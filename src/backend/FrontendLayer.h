@@ -17,9 +17,14 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QPointer>
+#include <QWindow>
+#include <vector>
 
 class QQmlApplicationEngine;
+class QQuickWindow;
 
 
 /// Manages the dynamic reload of the frontend layer
@@ -29,6 +34,11 @@ class QQmlApplicationEngine;
 /// When it's done, the relevant signal will be triggered. After the actual
 /// execution is finished, the frontend layer can be rebuilt again.
 ///
+/// Alternatively, the frontend can be suspended instead: the engine stays
+/// alive with the windows hidden, their graphics resources released, and the
+/// timers, animations and media players paused, then resumed in place,
+/// keeping the theme's state.
+///
 /// Some funtions require a pointer to the API object, to connect and make
 /// it accessible to the frontend.
 class FrontendLayer : public QObject {
@@ -40,6 +50,10 @@ public:
     void rebuild();
     void teardown();
 
+    void suspend();
+    void resume();
+    bool isSuspended() const { return m_suspended; }
+
     void clearCache();
 
 signals:
@@ -50,4 +64,13 @@ private:
     QObject* const m_api_public;
     QObject* const m_api_private;
     QQmlApplicationEngine* m_engine;
+
+    bool m_suspended;
+    std::vector<std::pair<QPointer<QQuickWindow>, QWindow::Visibility>> m_hidden_windows;
+    std::vector<QPointer<QObject>> m_stopped_timers;
+    std::vector<QPointer<QObject>> m_paused_objects; // animations and animated images
+    std::vector<QPointer<QObject>> m_paused_players;
+
+    QElapsedTimer m_transition_timer;
+    void log_first_frame(const QString&);
 };
@@ -19,11 +19,19 @@
 
 #include "AppSettings.h"
 #include "Paths.h"
+#include "utils/HashMap.h"
+#include "utils/MpscQueue.h"
 
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QMutex>
+#include <QRecursiveMutex>
 #include <QTextStream>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
 
 #if defined(Q_OS_ANDROID) && defined(QT_DEBUG)
 #include <android/log.h>
@@ -67,6 +75,9 @@ public:
     void error(const QString& msg) override {
         colorlog(m_pre_error, msg);
     }
+    void flush() override {
+        m_stream.flush();
+    }
 
 private:
     QTextStream m_stream;
@@ -84,7 +95,7 @@ private:
 #endif
 
     void colorlog(const char* const prefix, const QString& msg) {
-        m_stream << prefix << QChar(' ') << msg << m_fmt_reset << Qt::endl;
+        m_stream << prefix << QChar(' ') << msg << m_fmt_reset << QChar('\n');
     }
 };
 
@@ -115,13 +126,17 @@ public:
             return;
 
         datelog(m_marker_warning, msg);
-        m_stream.flush();
     }
     void error(const QString& msg) override {
         if (Q_UNLIKELY(!m_file.isOpen()))
             return;
 
         datelog(m_marker_error, msg);
+    }
+    void flush() override {
+        if (Q_UNLIKELY(!m_file.isOpen()))
+            return;
+
         m_stream.flush();
     }
 
@@ -129,6 +144,10 @@ private:
     QFile m_file;
     QTextStream m_stream;
 
+    // the date is formatted only once per second
+    qint64 m_timestamp_secs = -1;
+    QString m_timestamp;
+
     static constexpr auto m_marker_info = "[i]";
     static constexpr auto m_marker_warning = "[w]";
     static constexpr auto m_marker_error = "[e]";
@@ -137,8 +156,18 @@ private:
         return paths::writableConfigDir() + QLatin1String("/lastrun.log");
     }
 
+    const QString& timestamp() {
+        const qint64 now_msecs = QDateTime::currentMSecsSinceEpoch();
+        const qint64 now_secs = now_msecs / 1000;
+        if (now_secs != m_timestamp_secs) {
+            m_timestamp_secs = now_secs;
+            m_timestamp = QDateTime::fromMSecsSinceEpoch(now_msecs).toString(Qt::ISODate);
+        }
+        return m_timestamp;
+    }
+
     void datelog(const char* const marker, const QString& msg) {
-        m_stream << QDateTime::currentDateTime().toString(Qt::ISODate) << QChar(' ')
+        m_stream << timestamp() << QChar(' ')
                  << marker << QChar(' ')
                  << msg << QChar('\n');
     }
@@ -175,6 +204,239 @@ private:
 
 
 namespace {
+// At most this many messages are logged per second with the same tag;
+// errors are always logged
+constexpr int TAG_RATE_LIMIT = 200;
+constexpr size_t QUEUE_CAPACITY = 4096;
+
+using SinkMethod = void (LogSink::*)(const QString&);
+
+struct QueuedMessage {
+    SinkMethod method = nullptr;
+    QString text;
+};
+
+
+/// Writes the queued messages to the sinks on a background thread,
+/// flushing the sinks once per batch, and right after every error
+class AsyncWriter {
+public:
+    explicit AsyncWriter(const std::vector<std::unique_ptr<LogSink>>& sinks)
+        : m_sinks(sinks)
+        , m_pushed(0)
+        , m_sleeping(false)
+        , m_written(0)
+        , m_stopping(false)
+        , m_thread(QThread::create([this](){ run(); }))
+    {
+        m_thread->setObjectName(QStringLiteral("Log writer"));
+        m_thread->start(QThread::LowPriority);
+    }
+    ~AsyncWriter()
+    {
+        {
+            QMutexLocker lock(&m_mutex);
+            m_stopping = true;
+            m_sleeping.store(false);
+            m_wakeup.wakeOne();
+        }
+        m_thread->wait();
+    }
+    NO_COPY_NO_MOVE(AsyncWriter)
+
+    void push(SinkMethod method, const QString& text)
+    {
+        QueuedMessage msg;
+        msg.method = method;
+        msg.text = text;
+
+        while (!m_queue.push(std::move(msg))) {
+            // a sink has logged something while the queue is full; the writer can't wait for itself
+            if (QThread::currentThread() == m_thread.get())
+                return;
+
+            wake_writer();
+            QThread::yieldCurrentThread();
+        }
+
+        // NOTE: the writer sets `m_sleeping` before checking `m_pushed`,
+        //       so one of the two threads always notices the other
+        m_pushed.fetch_add(1);
+        if (m_sleeping.load())
+            wake_writer();
+    }
+
+    void flush()
+    {
+        if (QThread::currentThread() == m_thread.get())
+            return;
+
+        const size_t target = m_pushed.load();
+
+        QMutexLocker lock(&m_mutex);
+        while (m_written < target)
+            m_written_cond.wait(&m_mutex);
+    }
+
+private:
+    const std::vector<std::unique_ptr<LogSink>>& m_sinks;
+    utils::MpscQueue<QueuedMessage, QUEUE_CAPACITY> m_queue;
+    std::atomic<size_t> m_pushed;
+    std::atomic<bool> m_sleeping;
+
+    QMutex m_mutex;
+    QWaitCondition m_wakeup;
+    QWaitCondition m_written_cond;
+    size_t m_written;
+    bool m_stopping;
+
+    const std::unique_ptr<QThread> m_thread;
+
+    void wake_writer()
+    {
+        if (m_sleeping.exchange(false)) {
+            QMutexLocker lock(&m_mutex);
+            m_wakeup.wakeOne();
+        }
+    }
+
+    void run()
+    {
+        size_t written_total = 0;
+        QueuedMessage msg;
+
+        while (true) {
+            size_t batch_size = 0;
+            while (m_queue.pop(msg)) {
+                for (const auto& sink : m_sinks)
+                    (sink.get()->*msg.method)(msg.text);
+                batch_size++;
+
+                // errors may come right before a crash, they don't wait for the rest of the batch
+                if (msg.method == &LogSink::error) {
+                    for (const auto& sink : m_sinks)
+                        sink->flush();
+                }
+            }
+
+            if (batch_size > 0) {
+                for (const auto& sink : m_sinks)
+                    sink->flush();
+
+                written_total += batch_size;
+                QMutexLocker lock(&m_mutex);
+                m_written = written_total;
+                m_written_cond.wakeAll();
+                continue;
+            }
+
+            QMutexLocker lock(&m_mutex);
+            m_sleeping.store(true);
+            if (m_pushed.load() != written_total) {
+                // a message is on its way
+                m_sleeping.store(false);
+                continue;
+            }
+            if (m_stopping)
+                break;
+
+            while (m_sleeping.load())
+                m_wakeup.wait(&m_mutex);
+        }
+    }
+};
+
+// NOTE: only set between Log::init() and Log::close()
+std::atomic<AsyncWriter*> s_writer(nullptr);
+// NOTE: the number of callers that may be using the writer right now;
+//       Log::close() waits for them before deleting it
+std::atomic<int> s_writer_users(0);
+
+/// Keeps the current writer, if any, alive during a logging call
+class WriterRef {
+public:
+    WriterRef()
+    {
+        // NOTE: counted before loading the writer, so Log::close() either
+        //       sees this caller, or this caller sees no writer
+        s_writer_users.fetch_add(1);
+        m_writer = s_writer.load();
+    }
+    ~WriterRef()
+    {
+        s_writer_users.fetch_sub(1);
+    }
+    NO_COPY_NO_MOVE(WriterRef)
+
+    AsyncWriter* get() const { return m_writer; }
+
+private:
+    AsyncWriter* m_writer;
+};
+
+// NOTE: messages may arrive from multiple scanner threads at the same time;
+//       recursive because a sink may trigger a Qt message itself
+QRecursiveMutex s_sink_mutex;
+
+
+struct TagRate {
+    qint64 window_start = 0;
+    int count = 0;
+    int suppressed = 0;
+};
+
+QMutex s_rate_mutex;
+QElapsedTimer s_rate_clock;
+HashMap<QString, TagRate> s_tag_rates;
+
+// Returns false if the message should be dropped; `suppressed_before` is set to
+// the number of messages dropped in the tag's previous time window
+bool tag_rate_allows(const QString& tag, int& suppressed_before)
+{
+    if (!s_writer.load(std::memory_order_acquire))
+        return true;
+
+    const qint64 now = s_rate_clock.elapsed();
+
+    QMutexLocker lock(&s_rate_mutex);
+    TagRate& rate = s_tag_rates[tag];
+    if (now - rate.window_start >= 1000) {
+        suppressed_before = rate.suppressed;
+        rate.window_start = now;
+        rate.count = 0;
+        rate.suppressed = 0;
+    }
+
+    if (rate.count >= TAG_RATE_LIMIT) {
+        rate.suppressed++;
+        return false;
+    }
+
+    rate.count++;
+    return true;
+}
+
+QString suppressed_message(const QString& tag, int count)
+{
+    return LOGMSG("%1: %2 more messages were not logged, the limit is %3 per second")
+        .arg(tag, QString::number(count), QString::number(TAG_RATE_LIMIT));
+}
+
+void report_suppressed()
+{
+    std::vector<std::pair<QString, int>> counts;
+    {
+        QMutexLocker lock(&s_rate_mutex);
+        for (auto& entry : s_tag_rates) {
+            if (entry.second.suppressed > 0)
+                counts.emplace_back(entry.first, entry.second.suppressed);
+        }
+        s_tag_rates.clear();
+    }
+
+    for (const auto& entry : counts)
+        Log::warning(suppressed_message(entry.first, entry.second));
+}
 
 void on_qt_message(QtMsgType type, const QMessageLogContext& context, const QString& msg)
 {
@@ -188,8 +450,12 @@ void on_qt_message(QtMsgType type, const QMessageLogContext& context, const QStr
             Log::warning(prepared_msg);
             break;
         case QtMsgType::QtCriticalMsg:
+            Log::error(prepared_msg);
+            break;
         case QtMsgType::QtFatalMsg:
+            // the application is about to abort
             Log::error(prepared_msg);
+            Log::flush();
             break;
         default:
             Q_UNREACHABLE();
@@ -213,6 +479,9 @@ void Log::init(bool silent)
 
     m_sinks.emplace_back(new logsinks::LogFile());
 
+    s_rate_clock.start();
+    s_writer.store(new AsyncWriter(m_sinks), std::memory_order_release);
+
     // redirect Qt messages to the Log too
     qInstallMessageHandler(on_qt_message);
 }
@@ -225,20 +494,54 @@ void Log::init_qttest()
 
 void Log::close()
 {
+    report_suppressed();
+
+    // new messages are written directly from now on, but other threads
+    // may still be pushing to the writer
+    AsyncWriter* const writer = s_writer.exchange(nullptr);
+    while (s_writer_users.load() > 0)
+        QThread::yieldCurrentThread();
+
+    // the remaining messages are written before the writer stops
+    delete writer;
+
+    QMutexLocker lock(&s_sink_mutex);
     m_sinks.clear();
 }
 
-#define FORALLSINK_CALLER(method) \
+void Log::flush()
+{
+    const WriterRef writer;
+    if (writer.get())
+        writer.get()->flush();
+}
+
+#define FORALLSINK_CALLER(method, rate_limited) \
     void Log::method(const QString& message) \
     { \
-        for (const auto& sink : m_sinks) \
+        { \
+            const WriterRef writer; \
+            if (writer.get()) { \
+                writer.get()->push(&LogSink::method, message); \
+                return; \
+            } \
+        } \
+        QMutexLocker lock(&s_sink_mutex); \
+        for (const auto& sink : m_sinks) { \
             sink->method(message); \
+            sink->flush(); \
+        } \
     } \
     void Log::method(const QString& tag, const QString& message) \
     { \
+        int suppressed = 0; \
+        if (rate_limited && !tag_rate_allows(tag, suppressed)) \
+            return; \
+        if (suppressed > 0) \
+            Log::method(suppressed_message(tag, suppressed)); \
         const QString combi_msg = QStringLiteral("%1: %2").arg(tag, message); \
         Log::method(combi_msg); \
     }
-FORALLSINK_CALLER(info)
-FORALLSINK_CALLER(warning)
-FORALLSINK_CALLER(error)
+FORALLSINK_CALLER(info, true)
+FORALLSINK_CALLER(warning, true)
+FORALLSINK_CALLER(error, false)
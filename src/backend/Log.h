@@ -35,9 +35,16 @@ public:
     virtual void info(const QString&) = 0;
     virtual void warning(const QString&) = 0;
     virtual void error(const QString&) = 0;
+    /// Called after a batch of messages
+    virtual void flush() {}
 };
 
 
+/// Logs to the terminal and to a file
+///
+/// After init(), messages are queued and written on a background thread,
+/// so logging doesn't block the caller. Tagged messages are rate limited per tag.
+/// With init_qttest(), messages are written right away, as QtTest expects.
 class Log {
 public:
     Log() = delete;
@@ -46,6 +53,8 @@ public:
     static void init(bool silent = false);
     static void init_qttest();
     static void close();
+    /// Waits until the messages logged so far are written
+    static void flush();
 
     static void info(const QString& message);
     static void warning(const QString& message);
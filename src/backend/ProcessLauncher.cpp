@@ -30,12 +30,16 @@
 #endif
 
 #include <QDir>
-#include <QUrl>
+#include <QPointer>
 #include <QRegularExpression>
+#include <QTimer>
+#include <QUrl>
 
 
 namespace {
 static constexpr auto SEPARATOR = "----------------------------------------";
+// The process is considered failed if it's not running after this
+static constexpr int PROCESS_START_TIMEOUT_MS = 30000;
 
 void replace_env_vars(QString& param)
 {
@@ -154,12 +158,31 @@ QString abs_workdir(const QString& workdir, const QString& base_dir, const QStri
 ProcessLauncher::ProcessLauncher(QObject* parent)
     : QObject(parent)
     , m_process(nullptr)
-{}
+    , m_start_timer(new QTimer(this))
+    , m_busy(false)
+    , m_launch_ok(false)
+    , m_run_finished(false)
+    , m_teardown_finished(false)
+{
+    m_start_timer->setSingleShot(true);
+    m_start_timer->setInterval(PROCESS_START_TIMEOUT_MS);
+    connect(m_start_timer, &QTimer::timeout, this, &ProcessLauncher::onProcessStartTimeout);
+}
 
 void ProcessLauncher::onLaunchRequested(const model::GameFile* q_gamefile)
 {
     Q_ASSERT(q_gamefile);
 
+    if (m_busy) {
+        // the scripts of the previous launch may still be running
+        const QString message = LOGMSG("Cannot launch a game while the previous one is still being handled");
+        Log::warning(message);
+        emit processLaunchError(message);
+        return;
+    }
+
+    m_phase_timer.start();
+
     const model::GameFile& gamefile = *q_gamefile;
     const model::Game& game = *gamefile.parentGame();
 
@@ -218,9 +241,19 @@ void ProcessLauncher::onLaunchRequested(const model::GameFile* q_gamefile)
     replace_variables(workdir, gamefile.fileinfo());
     workdir = helpers::abs_workdir(workdir, game.launchCmdBasedir(), default_workdir);
 
+    Log::info(LOGMSG("Preparing the launch command took %1ms").arg(m_phase_timer.elapsed()));
+
+
+    m_busy = true;
+    m_launch_ok = false;
+    m_run_finished = false;
+    m_teardown_finished = false;
 
-    beforeRun(gamefile.fileinfo().absoluteFilePath());
-    runProcess(command, args, workdir);
+    QPointer<ProcessLauncher> self(this);
+    beforeRun(gamefile.fileinfo().absoluteFilePath(), [self, command, args, workdir](){
+        if (self)
+            self->runProcess(command, args, workdir);
+    });
 }
 
 void ProcessLauncher::runProcess(const QString& command, const QStringList& args, const QString& workdir)
@@ -228,6 +261,8 @@ void ProcessLauncher::runProcess(const QString& command, const QStringList& args
     Log::info(LOGMSG("Executing command: [`%1`]").arg(serialize_command(command, args)));
     Log::info(LOGMSG("Working directory: `%3`").arg(::pretty_path(workdir)));
 
+    m_phase_timer.restart();
+
 #ifndef Q_OS_ANDROID
     Q_ASSERT(!m_process);
     m_process = new QProcess(this);
@@ -242,12 +277,15 @@ void ProcessLauncher::runProcess(const QString& command, const QStringList& args
     m_process->setProcessChannelMode(QProcess::ForwardedChannels);
     m_process->setInputChannelMode(QProcess::ForwardedInputChannel);
     m_process->setWorkingDirectory(workdir);
+    m_start_timer->start();
     m_process->start(command, args, QProcess::ReadOnly);
-    m_process->waitForStarted(-1);
 
 #else // Q_OS_ANDROID
     const QString result = android::run_am_call(args);
     if (result.isEmpty()) {
+        // the activity runs on its own, there is nothing to wait for
+        m_launch_ok = true;
+        m_run_finished = true;
         emit processLaunchOk();
         Log::info(LOGMSG("Activity finished"));
     }
@@ -263,24 +301,41 @@ void ProcessLauncher::runProcess(const QString& command, const QStringList& args
 
 void ProcessLauncher::onTeardownComplete()
 {
-#ifndef Q_OS_ANDROID
-    Q_ASSERT(m_process);
-    m_process->waitForFinished(-1);
-#endif
-    emit processFinished();
+    Log::info(LOGMSG("The frontend was unloaded %1ms after the game has started").arg(m_phase_timer.elapsed()));
+
+    m_teardown_finished = true;
+    finishIfDone();
 }
 
 void ProcessLauncher::onProcessStarted()
 {
     Q_ASSERT(m_process);
-    Log::info(LOGMSG("Process %1 started").arg(m_process->processId()));
+    m_start_timer->stop();
+    Log::info(LOGMSG("Process %1 started in %2ms")
+        .arg(QString::number(m_process->processId()), QString::number(m_phase_timer.elapsed())));
     Log::info(SEPARATOR);
+
+    m_phase_timer.restart();
+    m_launch_ok = true;
     emit processLaunchOk();
 }
 
+void ProcessLauncher::onProcessStartTimeout()
+{
+    Q_ASSERT(m_process);
+    if (m_process->state() != QProcess::Starting)
+        return;
+
+    // the late signals of the abandoned process are not relevant anymore
+    m_process->disconnect(this);
+    m_process->kill();
+    onProcessError(QProcess::Timedout);
+}
+
 void ProcessLauncher::onProcessError(QProcess::ProcessError error)
 {
     Q_ASSERT(m_process);
+    m_start_timer->stop();
 
     const QString message = processerror_to_string(error).arg(m_process->program());
 
@@ -318,10 +373,10 @@ void ProcessLauncher::onProcessFinished(int exitcode, QProcess::ExitStatus exits
     afterRun();
 }
 
-void ProcessLauncher::beforeRun(const QString& game_path)
+void ProcessLauncher::beforeRun(const QString& game_path, std::function<void()> on_ready)
 {
     TerminalKbd::enable();
-    ScriptRunner::run(ScriptEvent::PROCESS_STARTED, { game_path });
+    ScriptRunner::run_async(ScriptEvent::PROCESS_STARTED, { game_path }, std::move(on_ready));
 }
 
 void ProcessLauncher::afterRun()
@@ -332,6 +387,25 @@ void ProcessLauncher::afterRun()
     m_process = nullptr;
 #endif
 
-    ScriptRunner::run(ScriptEvent::PROCESS_FINISHED);
-    TerminalKbd::disable();
+    QPointer<ProcessLauncher> self(this);
+    ScriptRunner::run_async(ScriptEvent::PROCESS_FINISHED, {}, [self](){
+        TerminalKbd::disable();
+        if (!self)
+            return;
+
+        self->m_run_finished = true;
+        self->finishIfDone();
+    });
+}
+
+void ProcessLauncher::finishIfDone()
+{
+    if (!m_run_finished)
+        return;
+    if (m_launch_ok && !m_teardown_finished)
+        return;
+
+    m_busy = false;
+    if (m_launch_ok)
+        emit processFinished();
 }
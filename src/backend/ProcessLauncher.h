@@ -17,8 +17,12 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QProcess>
+#include <functional>
+
+class QTimer;
 
 namespace model { class GameFile; }
 
@@ -32,6 +36,8 @@ QString abs_workdir(const QString& workdir, const QString& base_dir, const QStri
 /// Launches and manages external processes
 ///
 /// Launches external processes and detects their success or failure.
+/// None of the steps block the event loop: the scripts run in the background,
+/// and the process is expected to start in a limited amount of time.
 class ProcessLauncher : public QObject {
     Q_OBJECT
 
@@ -50,14 +56,26 @@ public slots:
 
 private slots:
     void onProcessStarted();
+    void onProcessStartTimeout();
     void onProcessError(QProcess::ProcessError);
     void onProcessFinished(int, QProcess::ExitStatus);
 
 private:
     QProcess* m_process;
+    QTimer* const m_start_timer;
+
+    // the launch is in progress until both the run and the teardown have finished,
+    // or until the launch fails
+    bool m_busy;
+    bool m_launch_ok;
+    bool m_run_finished;
+    bool m_teardown_finished;
+
+    QElapsedTimer m_phase_timer;
 
     void runProcess(const QString&, const QStringList&, const QString&);
 
-    void beforeRun(const QString&);
+    void beforeRun(const QString&, std::function<void()>);
     void afterRun();
+    void finishIfDone();
 };
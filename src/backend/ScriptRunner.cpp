@@ -17,67 +17,137 @@
 
 #include "ScriptRunner.h"
 
+#include "AppSettings.h"
 #include "Log.h"
 #include "Paths.h"
 #include "utils/HashMap.h"
 
+#include <QDateTime>
 #include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QProcess>
 #include <QString>
 #include <QStringBuilder>
+#include <QTimer>
+#include <algorithm>
+#include <deque>
+#include <memory>
 #include <vector>
 
 
 namespace {
-std::vector<QString> find_scripts_in(const QString& dirname)
+// Scripts running longer than this are terminated; there is no limit by default
+int script_timeout_ms()
 {
-    constexpr auto filters = QDir::Files | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot;
+    return qMax(AppSettings::general.script_timeout_sec, 0) * 1000;
+}
+
+struct ScriptList {
+    std::vector<QString> serial;
+    std::vector<QString> parallel;
+
+    size_t size() const { return serial.size() + parallel.size(); }
+};
+
+// The files found under the script dirs of an event, and the modification time
+// of every directory listed, including the missing ones
+struct ScriptDirListing {
+    std::vector<std::pair<QString, QDateTime>> dir_stamps;
+    std::vector<QString> serial_files;
+    std::vector<QString> parallel_files;
+};
+
+bool listing_up_to_date(const ScriptDirListing& listing)
+{
+    for (const auto& stamp : listing.dir_stamps) {
+        if (QFileInfo(stamp.first).lastModified() != stamp.second)
+            return false;
+    }
+    return true;
+}
+
+ScriptDirListing list_script_dirs(const QString& dirname)
+{
+    constexpr auto filters = QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot;
     constexpr auto flags = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
 
     Q_ASSERT(!dirname.isEmpty());
 
-    std::vector<QString> all_scripts;
+    ScriptDirListing listing;
 
     for (const QString& configdir : paths::configDirs()) {
         const QString scriptdir = configdir % QStringLiteral("/scripts/") % dirname;
+        const QDir base_dir(scriptdir);
+        listing.dir_stamps.emplace_back(scriptdir, QFileInfo(scriptdir).lastModified());
+
+        std::vector<QString> local_serial;
+        std::vector<QString> local_parallel;
 
-        std::vector<QString> local_scripts;
-        QDirIterator scripdir_it(scriptdir, filters, flags);
-        while (scripdir_it.hasNext())
-            local_scripts.emplace_back(scripdir_it.next());
+        QDirIterator scriptdir_it(scriptdir, filters, flags);
+        while (scriptdir_it.hasNext()) {
+            QString path = scriptdir_it.next();
+            const QFileInfo finfo = scriptdir_it.fileInfo();
 
-        std::sort(local_scripts.begin(), local_scripts.end());
-        all_scripts.insert(all_scripts.end(),
-                           std::make_move_iterator(local_scripts.begin()),
-                           std::make_move_iterator(local_scripts.end()));
+            if (finfo.isDir()) {
+                listing.dir_stamps.emplace_back(path, finfo.lastModified());
+                continue;
+            }
+
+            if (base_dir.relativeFilePath(path).startsWith(QLatin1String("parallel/")))
+                local_parallel.emplace_back(std::move(path));
+            else
+                local_serial.emplace_back(std::move(path));
+        }
+
+        std::sort(local_serial.begin(), local_serial.end());
+        std::sort(local_parallel.begin(), local_parallel.end());
+        listing.serial_files.insert(listing.serial_files.end(),
+                                    std::make_move_iterator(local_serial.begin()),
+                                    std::make_move_iterator(local_serial.end()));
+        listing.parallel_files.insert(listing.parallel_files.end(),
+                                      std::make_move_iterator(local_parallel.begin()),
+                                      std::make_move_iterator(local_parallel.end()));
     }
 
-    return all_scripts;
+    return listing;
 }
 
-void execute_all(const std::vector<QString>& paths, const QStringList& args)
+std::vector<QString> runnable_only(const std::vector<QString>& paths)
 {
-    Q_ASSERT(!paths.empty());
-
-    const int num_field_width = QString::number(paths.size()).length();
-
-    for (size_t i = 0; i < paths.size(); i++) {
-        Log::info(LOGMSG("[%1/%2] Running `%3`")
-            .arg(i + 1, num_field_width)
-            .arg(paths.size())
-            .arg(paths[i]));
-        QProcess::execute(paths[i], args);
+    std::vector<QString> result;
+    for (const QString& path : paths) {
+        const QFileInfo finfo(path);
+        if (finfo.isReadable() && finfo.isExecutable())
+            result.emplace_back(path);
     }
+    return result;
 }
-} // namespace
 
-
-void ScriptRunner::run(ScriptEvent event)
+// The script dirs are listed again only when one of the directories has changed;
+// the permissions of the files can change without that, so they are checked every time
+ScriptList find_scripts_in(const QString& dirname)
 {
-    run(event, {});
+    static QMutex cache_lock;
+    static HashMap<QString, ScriptDirListing> cache;
+
+    QMutexLocker lock(&cache_lock);
+
+    auto it = cache.find(dirname);
+    if (it == cache.end())
+        it = cache.emplace(dirname, list_script_dirs(dirname)).first;
+    else if (!listing_up_to_date(it->second))
+        it->second = list_script_dirs(dirname);
+
+    ScriptList scripts;
+    scripts.serial = runnable_only(it->second.serial_files);
+    scripts.parallel = runnable_only(it->second.parallel_files);
+    return scripts;
 }
 
-void ScriptRunner::run(ScriptEvent event, const QStringList& args)
+const QString& script_dir_of(ScriptEvent event)
 {
     static const HashMap<ScriptEvent, QString, EnumHash> SCRIPT_DIRS {
         { ScriptEvent::QUIT, QStringLiteral("quit") },
@@ -91,13 +161,241 @@ void ScriptRunner::run(ScriptEvent event, const QStringList& args)
     };
     Q_ASSERT(SCRIPT_DIRS.count(event));
 
+    return SCRIPT_DIRS.at(event);
+}
+
+void log_script_start(size_t idx, size_t count, const QString& path)
+{
+    const int num_field_width = QString::number(count).length();
+
+    Log::info(LOGMSG("[%1/%2] Running `%3`")
+        .arg(idx + 1, num_field_width)
+        .arg(count)
+        .arg(path));
+}
+
+void log_script_timeout(const QString& path, int timeout_ms)
+{
+    Log::warning(LOGMSG("The script `%1` did not finish in %2 seconds and was terminated")
+        .arg(path, QString::number(timeout_ms / 1000)));
+}
 
-    const QString& dirname = SCRIPT_DIRS.at(event);
-    const std::vector<QString> scripts = find_scripts_in(dirname);
+QProcess* create_process(const QString& path, const QStringList& args)
+{
+    auto process = new QProcess();
+    process->setProcessChannelMode(QProcess::ForwardedChannels);
+    process->setProgram(path);
+    process->setArguments(args);
+    return process;
+}
+
+void wait_for(QProcess& process, const QString& path)
+{
+    const int timeout_ms = script_timeout_ms();
+    if (timeout_ms == 0) {
+        process.waitForFinished(-1);
+        return;
+    }
 
-    if (scripts.empty())
+    if (process.waitForFinished(timeout_ms) || process.state() == QProcess::NotRunning)
+        return;
+
+    log_script_timeout(path, timeout_ms);
+    process.kill();
+    process.waitForFinished(-1);
+}
+
+void execute_all(const ScriptList& scripts, const QStringList& args)
+{
+    Q_ASSERT(scripts.size() > 0);
+
+    size_t started = 0;
+
+    std::vector<std::unique_ptr<QProcess>> parallel_processes;
+    for (const QString& path : scripts.parallel) {
+        log_script_start(started++, scripts.size(), path);
+        parallel_processes.emplace_back(create_process(path, args));
+        parallel_processes.back()->start(QProcess::ReadOnly);
+    }
+
+    for (const QString& path : scripts.serial) {
+        log_script_start(started++, scripts.size(), path);
+        const std::unique_ptr<QProcess> process(create_process(path, args));
+        process->start(QProcess::ReadOnly);
+        wait_for(*process, path);
+    }
+
+    for (size_t i = 0; i < parallel_processes.size(); i++)
+        wait_for(*parallel_processes[i], scripts.parallel[i]);
+}
+
+
+// The async runs of an event wait for the previous one to finish, so the scripts
+// of quick successive changes don't overlap. Only used from the main thread.
+struct QueuedRun {
+    QStringList args;
+    std::function<void()> on_finished;
+};
+
+std::deque<QueuedRun>& async_queue_of(ScriptEvent event)
+{
+    static HashMap<ScriptEvent, std::deque<QueuedRun>, EnumHash> queues;
+    return queues[event];
+}
+
+void start_queued(ScriptEvent);
+void finish_queued(ScriptEvent);
+
+
+struct AsyncRun {
+    ScriptEvent event;
+    QString dirname;
+    QStringList args;
+    ScriptList scripts;
+    std::function<void()> on_finished;
+
+    size_t started = 0;
+    size_t next_serial = 0;
+    size_t pending_groups = 0;
+    QElapsedTimer timer;
+};
+
+void start_async(const QString& path, const QStringList& args, std::function<void()> on_done)
+{
+    QProcess* const process = create_process(path, args);
+
+    const int timeout_ms = script_timeout_ms();
+    auto timeout = new QTimer(process);
+    timeout->setSingleShot(true);
+    QObject::connect(timeout, &QTimer::timeout, process, [process, path, timeout_ms](){
+        log_script_timeout(path, timeout_ms);
+        process->kill();
+    });
+
+    // either `finished` or a start failure is reported, never both
+    auto on_end = [process, timeout, on_done](){
+        timeout->stop();
+        process->deleteLater();
+        on_done();
+    };
+    QObject::connect(process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                     process, on_end);
+    QObject::connect(process, &QProcess::errorOccurred, process, [on_end](QProcess::ProcessError error){
+        if (error == QProcess::FailedToStart)
+            on_end();
+    });
+
+    if (timeout_ms > 0)
+        timeout->start(timeout_ms);
+    process->start(QProcess::ReadOnly);
+}
+
+void finish_group(const std::shared_ptr<AsyncRun>& run)
+{
+    Q_ASSERT(run->pending_groups > 0);
+    run->pending_groups--;
+    if (run->pending_groups > 0)
+        return;
+
+    Log::info(LOGMSG("Finished running `%1` scripts in %2ms")
+        .arg(run->dirname, QString::number(run->timer.elapsed())));
+
+    if (run->on_finished)
+        run->on_finished();
+
+    finish_queued(run->event);
+}
+
+void start_next_serial(const std::shared_ptr<AsyncRun>& run)
+{
+    Q_ASSERT(run->next_serial < run->scripts.serial.size());
+
+    const QString& path = run->scripts.serial[run->next_serial++];
+    log_script_start(run->started++, run->scripts.size(), path);
+
+    start_async(path, run->args, [run](){
+        if (run->next_serial < run->scripts.serial.size())
+            start_next_serial(run);
+        else
+            finish_group(run);
+    });
+}
+
+// Starts the run at the front of the queue of the event
+void start_queued(ScriptEvent event)
+{
+    const std::deque<QueuedRun>& queue = async_queue_of(event);
+    Q_ASSERT(!queue.empty());
+
+    const QString& dirname = script_dir_of(event);
+    ScriptList scripts = find_scripts_in(dirname);
+
+    if (scripts.size() == 0) {
+        if (queue.front().on_finished)
+            queue.front().on_finished();
+        finish_queued(event);
+        return;
+    }
+
+    Log::info(LOGMSG("Running `%1` scripts...").arg(dirname));
+
+    const auto run = std::make_shared<AsyncRun>();
+    run->event = event;
+    run->dirname = dirname;
+    run->args = queue.front().args;
+    run->scripts = std::move(scripts);
+    run->on_finished = queue.front().on_finished;
+    run->pending_groups = run->scripts.parallel.size() + (run->scripts.serial.empty() ? 0 : 1);
+    run->timer.start();
+
+    for (const QString& path : run->scripts.parallel) {
+        log_script_start(run->started++, run->scripts.size(), path);
+        start_async(path, run->args, [run](){ finish_group(run); });
+    }
+
+    if (!run->scripts.serial.empty())
+        start_next_serial(run);
+}
+
+// Removes the finished run from the queue, and starts the next one.
+// The callback of the finished run was called before, so a run it starts waits too.
+void finish_queued(ScriptEvent event)
+{
+    std::deque<QueuedRun>& queue = async_queue_of(event);
+    Q_ASSERT(!queue.empty());
+
+    queue.pop_front();
+    if (!queue.empty())
+        start_queued(event);
+}
+} // namespace
+
+
+void ScriptRunner::run(ScriptEvent event)
+{
+    run(event, {});
+}
+
+void ScriptRunner::run(ScriptEvent event, const QStringList& args)
+{
+    const QString& dirname = script_dir_of(event);
+    const ScriptList scripts = find_scripts_in(dirname);
+
+    if (scripts.size() == 0)
         return;
 
     Log::info(LOGMSG("Running `%1` scripts...").arg(dirname));
     execute_all(scripts, args);
 }
+
+void ScriptRunner::run_async(ScriptEvent event, const QStringList& args, std::function<void()> on_finished)
+{
+    std::deque<QueuedRun>& queue = async_queue_of(event);
+    queue.push_back({ args, std::move(on_finished) });
+
+    // an earlier run of the event is still in progress
+    if (queue.size() > 1)
+        return;
+
+    start_queued(event);
+}
@@ -17,7 +17,8 @@
 
 #pragma once
 
-class QStringList;
+#include <QStringList>
+#include <functional>
 
 
 enum class ScriptEvent : unsigned char {
@@ -33,8 +34,18 @@ enum class ScriptEvent : unsigned char {
 
 
 /// A utility class for finding and running external scripts
+///
+/// The scripts of an event run one after the other, in alphabetical order,
+/// except the ones in a `parallel` subdirectory, which are started together.
+/// If a script timeout is set in the settings, the scripts running longer are terminated.
 class ScriptRunner {
 public:
+    /// Runs the scripts and waits for them to finish
     static void run(ScriptEvent);
     static void run(ScriptEvent, const QStringList&);
+    /// Starts the scripts and returns; the callback is called on the calling thread
+    /// after all of them have finished, or right away if there are none.
+    /// If the scripts of the event are already running, they are started again
+    /// only after those have finished. Should be called from the main thread only.
+    static void run_async(ScriptEvent, const QStringList&, std::function<void()> on_finished = nullptr);
 };
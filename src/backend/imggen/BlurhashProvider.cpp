@@ -19,6 +19,7 @@
 
 #include "utils/HashMap.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 
@@ -36,6 +37,8 @@ constexpr std::array<char, 83> BASE83 {
     '-', '.', ':', ';', '=', '?', '@', '[', ']', '^', '_', '{', '|', '}', '~',
 };
 constexpr int BLURHASH_MIN_LEN = 6;
+constexpr int CACHE_MAX_BYTES = 16 * 1024 * 1024;
+constexpr int SRGB_LUT_SIZE = 4096;
 
 
 struct FpColor {
@@ -84,7 +87,27 @@ uint8_t linear_to_srgb(float linear_val)
     const float g = u <= 0.0031308f
         ? u * 12.92
         : 1.055 * std::pow(u, 1.f / 2.4f) - 0.055f;
-    return std::round(g * 255.f + 0.5f);
+    return std::min(255.f, std::round(g * 255.f + 0.5f));
+}
+
+
+// Replaces the `std::pow` call of each pixel channel
+const std::array<uint8_t, SRGB_LUT_SIZE>& linear_to_srgb_lut()
+{
+    static const std::array<uint8_t, SRGB_LUT_SIZE> lut = [](){
+        std::array<uint8_t, SRGB_LUT_SIZE> out;
+        for (int i = 0; i < SRGB_LUT_SIZE; i++)
+            out[i] = linear_to_srgb(static_cast<float>(i) / (SRGB_LUT_SIZE - 1));
+        return out;
+    }();
+    return lut;
+}
+
+
+uint8_t linear_to_srgb_fast(const std::array<uint8_t, SRGB_LUT_SIZE>& lut, float linear_val)
+{
+    const float u = std::max(0.f, std::min(linear_val, 1.f));
+    return lut[static_cast<int>(u * (SRGB_LUT_SIZE - 1) + 0.5f)];
 }
 
 
@@ -126,24 +149,12 @@ std::vector<float> create_cos_table(unsigned components, unsigned image_dim)
         out[i] = std::cos(M_PI * i / image_dim);
     return out;
 }
-} // namespace
-
-
-BlurhashProvider::BlurhashProvider()
-    : QQuickImageProvider(QQuickImageProvider::Image)
-{}
 
-
-QImage BlurhashProvider::requestImage(const QString& hash_url, QSize* out_size, const QSize& requested_size)
+// The basis functions are separable, so the sum is calculated in two passes:
+// first the horizontal sums for each row of components, then their weighted
+// sums for each image row. The inner loops run over contiguous arrays of floats.
+QImage decode_blurhash(const QString& hash, const QSize& img_size)
 {
-    const QString hash = QUrl::fromPercentEncoding(hash_url.toLatin1());
-    if (hash.length() < BLURHASH_MIN_LEN)
-        return {};
-
-    const QSize img_size = requested_size.isEmpty()
-        ? QSize(24, 24)
-        : requested_size;
-
     const unsigned components_raw = decode_base83(hash.leftRef(1));
     const unsigned components_x = (components_raw % 9) + 1;
     const unsigned components_y = (components_raw / 9) + 1;
@@ -170,35 +181,92 @@ QImage BlurhashProvider::requestImage(const QString& hash_url, QSize* out_size,
         return out;
     }();
 
-    const std::vector<float> cos_x_table = create_cos_table(components_x, img_size.width());
-    const std::vector<float> cos_y_table = create_cos_table(components_y, img_size.height());
+    const size_t width = img_size.width();
+    const size_t height = img_size.height();
+    const size_t row_len = width * 3;
+
+    const std::vector<float> cos_x_table = create_cos_table(components_x, width);
+    const std::vector<float> cos_y_table = create_cos_table(components_y, height);
+
+    // Horizontal pass: one interleaved RGB row for each component row
+    std::vector<float> row_sums(components_y * row_len, 0.f);
+    for (unsigned cy = 0; cy < components_y; cy++) {
+        float* const row = row_sums.data() + cy * row_len;
+        for (unsigned cx = 0; cx < components_x; cx++) {
+            const FpColor color = colors[cy * components_x + cx];
+            for (size_t img_x = 0; img_x < width; img_x++) {
+                const float basis = cos_x_table[img_x * cx];
+                row[img_x * 3 + 0] += color.r * basis;
+                row[img_x * 3 + 1] += color.g * basis;
+                row[img_x * 3 + 2] += color.b * basis;
+            }
+        }
+    }
+
+    const std::array<uint8_t, SRGB_LUT_SIZE>& lut = linear_to_srgb_lut();
 
     QImage out_img(img_size, QImage::Format_RGB888);
-    uchar* const out_img_data = out_img.bits();
-
-    for (int img_y = 0; img_y < img_size.height(); img_y++) {
-        for (int img_x = 0; img_x < img_size.width(); img_x++) {
-            FpColor out_color { 0, 0, 0 };
-
-            for (unsigned cy = 0; cy < components_y; cy++) {
-                for (unsigned cx = 0; cx < components_x; cx++) {
-                    const float basis = cos_x_table[img_x * cx] * cos_y_table[img_y * cy];
-                    const size_t color_idx = cy * components_x + cx;
-                    const FpColor color = colors[color_idx];
-
-                    out_color.r += color.r * basis;
-                    out_color.g += color.g * basis;
-                    out_color.b += color.b * basis;
-                }
-            }
+    std::vector<float> line(row_len);
+
+    // Vertical pass
+    for (size_t img_y = 0; img_y < height; img_y++) {
+        std::fill(line.begin(), line.end(), 0.f);
+        for (unsigned cy = 0; cy < components_y; cy++) {
+            const float basis = cos_y_table[img_y * cy];
+            const float* const row = row_sums.data() + cy * row_len;
+            float* const line_data = line.data();
+            for (size_t i = 0; i < row_len; i++)
+                line_data[i] += row[i] * basis;
+        }
+
+        uchar* const out_line = out_img.scanLine(static_cast<int>(img_y));
+        for (size_t i = 0; i < row_len; i++)
+            out_line[i] = linear_to_srgb_fast(lut, line[i]);
+    }
+
+    return out_img;
+}
+} // namespace
+
+
+BlurhashProvider::BlurhashProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+    , m_cache(CACHE_MAX_BYTES)
+{}
+
 
-            const size_t pixeldata_idx = (img_y * img_size.width() + img_x) * 3;
-            out_img_data[pixeldata_idx + 0] = linear_to_srgb(out_color.r);
-            out_img_data[pixeldata_idx + 1] = linear_to_srgb(out_color.g);
-            out_img_data[pixeldata_idx + 2] = linear_to_srgb(out_color.b);
+QImage BlurhashProvider::requestImage(const QString& hash_url, QSize* out_size, const QSize& requested_size)
+{
+    const QString hash = QUrl::fromPercentEncoding(hash_url.toLatin1());
+    if (hash.length() < BLURHASH_MIN_LEN)
+        return {};
+
+    const QSize img_size = requested_size.isEmpty()
+        ? QSize(24, 24)
+        : requested_size;
+
+    const QString cache_key = hash + QLatin1Char('@')
+        + QString::number(img_size.width()) + QLatin1Char('x') + QString::number(img_size.height());
+    {
+        const QMutexLocker lock(&m_cache_guard);
+        const QImage* const cached = m_cache.object(cache_key);
+        if (cached) {
+            if (out_size)
+                *out_size = img_size;
+            return *cached;
         }
     }
 
+    const QImage out_img = decode_blurhash(hash, img_size);
+    if (out_img.isNull())
+        return {};
+
+    {
+        const QMutexLocker lock(&m_cache_guard);
+        const int cost = static_cast<int>(std::min<qsizetype>(out_img.sizeInBytes(), CACHE_MAX_BYTES));
+        m_cache.insert(cache_key, new QImage(out_img), cost);
+    }
+
     if (out_size)
         *out_size = img_size;
     return out_img;
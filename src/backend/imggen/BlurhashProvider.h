@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <QCache>
+#include <QMutex>
 #include <QQuickImageProvider>
 
 
@@ -25,4 +27,9 @@ public:
     BlurhashProvider();
 
     QImage requestImage(const QString&, QSize*, const QSize&) override;
+
+private:
+    // Recently decoded images, keyed by hash and size
+    QMutex m_cache_guard;
+    QCache<QString, QImage> m_cache;
 };
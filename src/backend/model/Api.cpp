@@ -18,13 +18,98 @@
 #include "Api.h"
 
 #include "Log.h"
+#include "model/gaming/Assets.h"
 #include "model/gaming/GameFile.h"
+#include "model/gaming/SortRank.h"
+
+#include <unordered_set>
+
+
+namespace {
+bool same_files(const model::Game& a, const model::Game& b)
+{
+    const std::vector<model::GameFile*>& files_a = a.filesConst();
+    const std::vector<model::GameFile*>& files_b = b.filesConst();
+    if (files_a.size() != files_b.size())
+        return false;
+
+    for (size_t i = 0; i < files_a.size(); i++) {
+        const model::GameFile& file_a = *files_a[i];
+        const model::GameFile& file_b = *files_b[i];
+        if (file_a.path() != file_b.path() || file_a.name() != file_b.name() || file_a.uri() != file_b.uri())
+            return false;
+    }
+    return true;
+}
+
+bool same_collection_details(const model::Collection& a, const model::Collection& b)
+{
+    return a.name() == b.name()
+        && a.sortBy() == b.sortBy()
+        && a.shortName() == b.shortName()
+        && a.summary() == b.summary()
+        && a.description() == b.description()
+        && a.commonLaunchCmd() == b.commonLaunchCmd()
+        && a.commonLaunchWorkdir() == b.commonLaunchWorkdir()
+        && a.commonLaunchCmdBasedir() == b.commonLaunchCmdBasedir()
+        && a.extraMap() == b.extraMap()
+        && a.assets().same_as(b.assets());
+}
+
+bool same_game_details(const model::Game& a, const model::Game& b)
+{
+    return a.title() == b.title()
+        && a.sortBy() == b.sortBy()
+        && a.summary() == b.summary()
+        && a.description() == b.description()
+        && a.releaseDate() == b.releaseDate()
+        && a.playerCount() == b.playerCount()
+        && qFuzzyCompare(a.rating(), b.rating())
+        && a.developerListConst() == b.developerListConst()
+        && a.publisherListConst() == b.publisherListConst()
+        && a.genreListConst() == b.genreListConst()
+        && a.tagListConst() == b.tagListConst()
+        && a.playCount() == b.playCount()
+        && a.playTime() == b.playTime()
+        && a.lastPlayed() == b.lastPlayed()
+        && a.isFavorite() == b.isFavorite()
+        && a.isMissing() == b.isMissing()
+        && a.launchCmd() == b.launchCmd()
+        && a.launchWorkdir() == b.launchWorkdir()
+        && a.launchCmdBasedir() == b.launchCmdBasedir()
+        && a.extraMap() == b.extraMap()
+        && a.assets().same_as(b.assets())
+        && same_files(a, b);
+}
+
+// Games found by a live update are matched with the current ones by their first file,
+// using the URI for the entries not backed by a real file (eg. Steam or Android apps)
+QString game_key(const model::Game& game)
+{
+    const model::GameFile& gamefile = *game.filesConst().front();
+    const QString path = gamefile.path();
+    return path.isEmpty() ? gamefile.uri() : path;
+}
+
+template<typename T>
+std::vector<T*> remap_all(const std::vector<T*>& entries, const HashMap<T*, T*>& mapping)
+{
+    std::vector<T*> out;
+    out.reserve(entries.size());
+    for (T* const entry : entries) {
+        const auto it = mapping.find(entry);
+        out.emplace_back(it != mapping.cend() ? it->second : entry);
+    }
+    return out;
+}
+} // namespace
 
 
 namespace model {
 ApiObject::ApiObject(const backend::CliArgs&, QObject* parent)
     : QObject(parent)
     , m_launch_game_file(nullptr)
+    , m_removed_launch_game(nullptr)
     , m_collections(new CollectionListModel(this))
     , m_all_games(new GameListModel(this))
 {
@@ -46,20 +131,8 @@ void ApiObject::setGameData(std::vector<model::Collection*>&& collections, std::
     Q_ASSERT(m_all_games && m_all_games->entries().empty());
     Q_ASSERT(m_collections && m_collections->entries().empty());
 
-    for (model::Game* const game : qAsConst(games)) {
-        game->moveToThread(thread());
-        game->setParent(this);
-
-        connect(game, &model::Game::launchFileSelectorRequested,
-                this, &ApiObject::onGameFileSelectorRequested);
-        connect(game, &model::Game::favoriteChanged,
-                this, &ApiObject::onGameFavoriteChanged);
-
-        for (model::GameFile* const gamefile : game->filesModel()->entries()) {
-            connect(gamefile, &model::GameFile::launchRequested,
-                    this, &ApiObject::onGameFileLaunchRequested);
-        }
-    }
+    for (model::Game* const game : qAsConst(games))
+        connectGame(game);
 
     for (model::Collection* const coll : qAsConst(collections)) {
         coll->moveToThread(thread());
@@ -73,6 +146,144 @@ void ApiObject::setGameData(std::vector<model::Collection*>&& collections, std::
     emit gamedataReady();
 }
 
+void ApiObject::patchGameData(LibraryPatch&& patch)
+{
+    if (patch.old_collections.empty() && patch.new_collections.empty())
+        return;
+
+    // Collections are matched by name, games by their files
+    HashMap<model::Collection*, model::Collection*> coll_map;
+    HashMap<QString, model::Collection*> old_coll_by_name;
+    for (model::Collection* const coll : patch.old_collections)
+        old_coll_by_name.emplace(coll->name(), coll);
+
+    std::vector<model::Collection*> added_colls;
+    for (model::Collection* const coll : patch.new_collections) {
+        const auto it = old_coll_by_name.find(coll->name());
+        if (it != old_coll_by_name.cend() && same_collection_details(*it->second, *coll)) {
+            coll_map.emplace(coll, it->second);
+            old_coll_by_name.erase(it);
+            continue;
+        }
+        added_colls.emplace_back(coll);
+    }
+
+    HashMap<model::Game*, model::Game*> game_map;
+    HashMap<QString, model::Game*> old_game_by_file;
+    for (model::Game* const game : patch.old_games)
+        old_game_by_file.emplace(game_key(*game), game);
+
+    std::vector<model::Game*> added_games;
+    for (model::Game* const game : patch.new_games) {
+        const auto it = old_game_by_file.find(game_key(*game));
+        if (it != old_game_by_file.cend() && same_game_details(*it->second, *game)) {
+            // The old game can only stay if it stays in the same collections
+            const std::vector<model::Collection*> new_game_colls = remap_all(game->collectionsConst(), coll_map);
+            if (new_game_colls == it->second->collectionsConst()) {
+                game_map.emplace(game, it->second);
+                old_game_by_file.erase(it);
+                continue;
+            }
+        }
+        added_games.emplace_back(game);
+    }
+
+    std::unordered_set<model::Game*> removed_games;
+    for (const auto& pair : old_game_by_file)
+        removed_games.emplace(pair.second);
+
+    std::vector<model::Game*> all_games;
+    all_games.reserve(m_all_games->entries().size() + added_games.size());
+    for (model::Game* const game : m_all_games->entries()) {
+        if (!removed_games.count(game))
+            all_games.emplace_back(game);
+    }
+    all_games.insert(all_games.end(), added_games.cbegin(), added_games.cend());
+
+    std::unordered_set<model::Collection*> removed_colls;
+    for (const auto& pair : old_coll_by_name)
+        removed_colls.emplace(pair.second);
+
+    std::vector<model::Collection*> all_colls;
+    all_colls.reserve(m_collections->entries().size() + added_colls.size());
+    for (model::Collection* const coll : m_collections->entries()) {
+        if (!removed_colls.count(coll))
+            all_colls.emplace_back(coll);
+    }
+    all_colls.insert(all_colls.end(), added_colls.cbegin(), added_colls.cend());
+
+    // The old and new entries have to be ranked together before any sorting
+    model::assign_sort_ranks(all_games);
+    model::assign_sort_ranks(all_colls);
+
+
+    for (model::Game* const game : added_games) {
+        game->setCollections(remap_all(game->collectionsConst(), coll_map));
+        connectGame(game);
+    }
+
+    for (model::Collection* const coll : patch.new_collections) {
+        std::vector<model::Game*> coll_games = remap_all(coll->gameList()->entries(), game_map);
+
+        const auto it = coll_map.find(coll);
+        if (it == coll_map.cend()) {
+            coll->setGames(std::move(coll_games));
+            coll->moveToThread(thread());
+            coll->setParent(this);
+            continue;
+        }
+
+        std::sort(coll_games.begin(), coll_games.end(), model::sort_games);
+        it->second->gameList()->patch(std::move(coll_games));
+    }
+
+    m_all_games->patch(std::move(all_games));
+    m_collections->patch(std::move(all_colls));
+
+
+    // The new duplicates of the kept entries are not needed anymore
+    for (const auto& pair : game_map)
+        delete pair.first;
+    for (const auto& pair : coll_map)
+        delete pair.first;
+
+    // QML may still refer to the removed entries until the next event loop cycle.
+    // The providers may still be using a launched game after it has finished,
+    // so it's kept until an update finds it not running anymore.
+    const QObject* const launched_game = m_launch_game_file ? m_launch_game_file->parent() : nullptr;
+    if (m_removed_launch_game && m_removed_launch_game != launched_game) {
+        m_removed_launch_game->deleteLater();
+        m_removed_launch_game = nullptr;
+    }
+    for (model::Game* const game : removed_games) {
+        if (game == launched_game)
+            m_removed_launch_game = game;
+        else
+            game->deleteLater();
+    }
+    for (model::Collection* const coll : removed_colls)
+        coll->deleteLater();
+
+    Log::info(LOGMSG("Game list updated: %1 games added, %2 removed, %3 unchanged")
+        .arg(QString::number(added_games.size()), QString::number(removed_games.size()), QString::number(game_map.size())));
+}
+
+void ApiObject::connectGame(model::Game* const game)
+{
+    game->moveToThread(thread());
+    game->setParent(this);
+
+    connect(game, &model::Game::launchFileSelectorRequested,
+            this, &ApiObject::onGameFileSelectorRequested);
+    connect(game, &model::Game::favoriteChanged,
+            this, &ApiObject::onGameFavoriteChanged);
+
+    for (model::GameFile* const gamefile : game->filesConst()) {
+        connect(gamefile, &model::GameFile::launchRequested,
+                this, &ApiObject::onGameFileLaunchRequested);
+    }
+}
+
 void ApiObject::onGameFileSelectorRequested()
 {
     auto game = static_cast<model::Game*>(QObject::sender());
@@ -110,14 +321,43 @@ void ApiObject::onGameProcessFinished()
 
 void ApiObject::onGameFavoriteChanged()
 {
-    emit favoritesChanged();
+    auto game = static_cast<model::Game*>(QObject::sender());
+    emit gameFavoriteChanged(game);
 }
 
 void ApiObject::onLocaleChanged()
 {
+    resortGameData();
     emit retranslationRequested();
 }
 
+void ApiObject::resortGameData()
+{
+    if (!m_all_games || !m_collections)
+        return;
+
+    // The order depends on the collation rules of the locale
+    std::vector<model::Game*> all_games = m_all_games->entries();
+    std::vector<model::Collection*> all_colls = m_collections->entries();
+    model::assign_sort_ranks(all_games);
+    model::assign_sort_ranks(all_colls);
+
+    for (model::Collection* const coll : all_colls) {
+        std::vector<model::Game*> coll_games = coll->gameList()->entries();
+        std::sort(coll_games.begin(), coll_games.end(), model::sort_games);
+        coll->gameList()->patch(std::move(coll_games));
+    }
+    for (model::Game* const game : all_games) {
+        std::vector<model::Collection*> game_colls = game->collectionsConst();
+        std::sort(game_colls.begin(), game_colls.end(), model::sort_collections);
+        if (game_colls != game->collectionsConst())
+            game->setCollections(std::move(game_colls));
+    }
+
+    m_all_games->patch(std::move(all_games));
+    m_collections->patch(std::move(all_colls));
+}
+
 void ApiObject::onThemeChanged(QString theme_dir)
 {
     m_memory.changeTheme(theme_dir);
@@ -52,6 +52,9 @@ public:
     // scanning
     void clearGameData();
     void setGameData(std::vector<model::Collection*>&&, std::vector<model::Game*>&&);
+    /// Replaces a part of the game data without resetting the models.
+    /// Entries with unchanged details keep their current object.
+    void patchGameData(LibraryPatch&&);
 
     CollectionListModel* collections() const { return m_collections; }
     GameListModel* allGames() const { return m_all_games; }
@@ -65,7 +68,7 @@ signals:
     void launchFailed(QString);
     void gameFileFinished(model::GameFile* const);
     void gameFileLaunched(model::GameFile* const);
-    void favoritesChanged();
+    void gameFavoriteChanged(model::Game* const);
     void memoryChanged();
 
     // triggers translation update
@@ -92,8 +95,13 @@ private slots:
     void onGameFileLaunchRequested();
 
 private:
+    void connectGame(model::Game* const);
+    void resortGameData();
+
     // game launching
     model::GameFile* m_launch_game_file;
+    // removed by a live update while it was running, deleted with the next update
+    model::Game* m_removed_launch_game;
 
     // used to trigger re-rendering of texts on locale change
     QString emptyString() const { return QString(); }
@@ -17,7 +17,11 @@
 
 #pragma once
 
+#include "utils/HashMap.h"
+
 #include <QAbstractListModel>
+#include <algorithm>
+#include <unordered_set>
 
 
 namespace model {
@@ -59,6 +63,7 @@ public:
             QObject::disconnect(entry, nullptr, this, nullptr);
 
         m_entries = std::move(entries);
+        rebuildRowIndex();
 
         for (T* entry : m_entries)
             connectEntry(entry);
@@ -68,6 +73,81 @@ public:
             emit countChanged();
     }
 
+    /// Like update(), but signals the removed and inserted rows only, as long as
+    /// the entries kept are in the same relative order in the new list
+    void patch(std::vector<T*>&& entries) {
+        const std::unordered_set<T*> old_set(m_entries.cbegin(), m_entries.cend());
+        const std::unordered_set<T*> new_set(entries.cbegin(), entries.cend());
+
+        std::vector<T*> kept_in_old_order;
+        for (T* entry : m_entries) {
+            if (new_set.count(entry))
+                kept_in_old_order.push_back(entry);
+        }
+        std::vector<T*> kept_in_new_order;
+        for (T* entry : entries) {
+            if (old_set.count(entry))
+                kept_in_new_order.push_back(entry);
+        }
+        if (kept_in_old_order != kept_in_new_order) {
+            update(std::move(entries));
+            return;
+        }
+
+        const size_t old_count = m_entries.size();
+
+        // Remove in runs of rows, from the back so the indices stay valid
+        size_t run_end = m_entries.size();
+        while (run_end > 0) {
+            if (new_set.count(m_entries[run_end - 1])) {
+                run_end--;
+                continue;
+            }
+            size_t run_begin = run_end - 1;
+            while (run_begin > 0 && !new_set.count(m_entries[run_begin - 1]))
+                run_begin--;
+
+            beginRemoveRows(QModelIndex(), run_begin, run_end - 1);
+            for (size_t i = run_begin; i < run_end; i++) {
+                QObject::disconnect(m_entries[i], nullptr, this, nullptr);
+                m_row_index.erase(m_entries[i]);
+            }
+            m_entries.erase(m_entries.begin() + run_begin, m_entries.begin() + run_end);
+            updateRowIndex(run_begin);
+            endRemoveRows();
+
+            run_end = run_begin;
+        }
+
+        // The remaining entries are now a subsequence of the new list
+        size_t row = 0;
+        size_t idx = 0;
+        while (idx < entries.size()) {
+            if (row < m_entries.size() && m_entries[row] == entries[idx]) {
+                row++;
+                idx++;
+                continue;
+            }
+            size_t run_end_idx = idx + 1;
+            while (run_end_idx < entries.size() && !old_set.count(entries[run_end_idx]))
+                run_end_idx++;
+
+            const size_t run_len = run_end_idx - idx;
+            beginInsertRows(QModelIndex(), row, row + run_len - 1);
+            m_entries.insert(m_entries.begin() + row, entries.begin() + idx, entries.begin() + run_end_idx);
+            for (size_t i = row; i < row + run_len; i++)
+                connectEntry(m_entries[i]);
+            updateRowIndex(row);
+            endInsertRows();
+
+            row += run_len;
+            idx = run_end_idx;
+        }
+
+        if (old_count != m_entries.size())
+            emit countChanged();
+    }
+
     int rowCount(const QModelIndex& parent = QModelIndex()) const override {
         return parent.isValid() ? 0 : m_entries.size();
     }
@@ -79,10 +159,10 @@ public:
     }
 
     int indexOf(QObject* item) const override {
-        const auto it = std::find(m_entries.cbegin(), m_entries.cend(), item);
-        return it == m_entries.cend()
+        const auto it = m_row_index.find(item);
+        return it == m_row_index.cend()
             ? -1
-            : std::distance(m_entries.cbegin(), it);
+            : it->second;
     }
 
     bool isEmpty() const override { return m_entries.empty(); }
@@ -100,6 +180,70 @@ public:
 protected:
     virtual void connectEntry(T* const) {};
 
+    /// Must be called after changing `m_entries` directly
+    void rebuildRowIndex() {
+        m_row_index.clear();
+        m_row_index.reserve(m_entries.size());
+        for (size_t i = 0; i < m_entries.size(); i++)
+            m_row_index.emplace(m_entries[i], static_cast<int>(i));
+    }
+
+    /// Updates the row index of the entries starting at `first_row`, so that
+    /// indexOf() is already correct when the row change gets signaled
+    void updateRowIndex(size_t first_row) {
+        for (size_t i = first_row; i < m_entries.size(); i++)
+            m_row_index[m_entries[i]] = static_cast<int>(i);
+    }
+
+    /// Queues a dataChanged signal for the entry. The changes made during the
+    /// same event loop turn are signaled together, as ranges of rows.
+    void entryDataChanged(QObject* entry, const QVector<int>& roles) {
+        m_changed_entries.insert(entry);
+        for (const int role : roles) {
+            if (!m_changed_roles.contains(role))
+                m_changed_roles.append(role);
+        }
+
+        if (!m_change_flush_queued) {
+            m_change_flush_queued = true;
+            QMetaObject::invokeMethod(this, [this](){ flushChangedEntries(); }, Qt::QueuedConnection);
+        }
+    }
+
     std::vector<T*> m_entries;
+
+private:
+    HashMap<const QObject*, int> m_row_index;
+
+    std::unordered_set<const QObject*> m_changed_entries;
+    QVector<int> m_changed_roles;
+    bool m_change_flush_queued = false;
+
+    void flushChangedEntries() {
+        m_change_flush_queued = false;
+
+        std::vector<int> rows;
+        rows.reserve(m_changed_entries.size());
+        for (const QObject* entry : m_changed_entries) {
+            const auto it = m_row_index.find(entry);
+            if (it != m_row_index.cend())
+                rows.push_back(it->second);
+        }
+        m_changed_entries.clear();
+
+        QVector<int> roles;
+        roles.swap(m_changed_roles);
+
+        std::sort(rows.begin(), rows.end());
+        size_t range_begin = 0;
+        while (range_begin < rows.size()) {
+            size_t range_end = range_begin + 1;
+            while (range_end < rows.size() && rows[range_end] == rows[range_end - 1] + 1)
+                range_end++;
+
+            emit dataChanged(index(rows[range_begin]), index(rows[range_end - 1]), roles);
+            range_begin = range_end;
+        }
+    }
 };
 } // namespace model
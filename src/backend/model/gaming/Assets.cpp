@@ -62,4 +62,19 @@ Assets& Assets::add_uri(AssetType key, QString url)
     return *this;
 }
 
+Assets& Assets::add_all_from(const Assets& other)
+{
+    for (const auto& pair : other.m_asset_lists) {
+        for (const QString& uri : pair.second)
+            add_uri(pair.first, uri);
+    }
+
+    return *this;
+}
+
+bool Assets::same_as(const Assets& other) const
+{
+    return m_asset_lists == other.m_asset_lists;
+}
+
 } // namespace model
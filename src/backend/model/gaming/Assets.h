@@ -75,11 +75,15 @@ public:
 
     Assets& add_file(AssetType, QString);
     Assets& add_uri(AssetType, QString);
+    /// Appends the entries of the other one, like add_uri() would
+    Assets& add_all_from(const Assets&);
+    bool same_as(const Assets&) const;
 
-private:
     const QStringList& get(AssetType) const;
     const QString& getFirst(AssetType) const;
 
+private:
+
     HashMap<AssetType, QStringList, EnumHash> m_asset_lists;
 };
 
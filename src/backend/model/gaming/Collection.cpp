@@ -52,6 +52,9 @@ Collection& Collection::setGames(std::vector<model::Game*>&& games)
 }
 
 bool sort_collections(const model::Collection* const a, const model::Collection* const b) {
+    if (a->sortRank() > 0 && b->sortRank() > 0)
+        return a->sortRank() < b->sortRank();
+
     return QString::localeAwareCompare(a->sortBy(), b->sortBy()) < 0;
 }
 } // namespace model
@@ -36,6 +36,7 @@ struct CollectionData {
 
     const QString name;
     QString sort_by;
+    int sort_rank = 0; ///< position by sort_by, see assign_sort_ranks
 
     QString summary;
     QString description;
@@ -61,6 +62,7 @@ public:
 
     GETTER(const QString&, name, name)
     GETTER(const QString&, sortBy, sort_by)
+    GETTER(int, sortRank, sort_rank)
     GETTER(const QString&, shortName, short_name())
     GETTER(const QString&, summary, summary)
     GETTER(const QString&, description, description)
@@ -74,6 +76,7 @@ public:
     Collection& set##name(type val) { m_data.field = std::move(val); return *this; }
 
     SETTER(QString, SortBy, sort_by)
+    SETTER(int, SortRank, sort_rank)
     SETTER(QString, Summary, summary)
     SETTER(QString, Description, description)
     SETTER(QString, CommonLaunchCmd, common_launch_cmd)
@@ -21,6 +21,8 @@
 #include "model/gaming/Collection.h"
 #include "model/gaming/GameFile.h"
 
+#include <QThread>
+
 
 namespace {
 QString joined_list(const QStringList& list) { return list.join(QLatin1String(", ")); }
@@ -90,8 +92,7 @@ void Game::onEntryPlayStatsChanged()
     const auto prev_play_time = m_data.playstats.play_time;
     const auto prev_last_played = m_data.playstats.last_played;
 
-    Q_ASSERT(filesModel());
-    const std::vector<model::GameFile*>& filelist = filesModel()->entries();
+    const std::vector<model::GameFile*>& filelist = m_file_list;
 
     m_data.playstats.play_count = std::accumulate(filelist.cbegin(), filelist.cend(), 0,
         [](int sum, const model::GameFile* const gamefile){
@@ -115,10 +116,10 @@ void Game::onEntryPlayStatsChanged()
 
 void Game::launch()
 {
-    Q_ASSERT(m_files->count() > 0);
+    Q_ASSERT(!m_file_list.empty());
 
-    if (m_files->count() == 1)
-        m_files->entries().front()->launch();
+    if (m_file_list.size() == 1)
+        m_file_list.front()->launch();
     else
         emit launchFileSelectorRequested();
 }
@@ -132,9 +133,10 @@ Game& Game::setFiles(std::vector<model::GameFile*>&& files)
 
     std::sort(files.begin(), files.end(), model::sort_gamefiles);
 
-    Q_ASSERT(!m_files);
-    m_files = new GameFileListModel(this);
-    m_files->update(std::move(files));
+    Q_ASSERT(m_file_list.empty());
+    m_file_list = std::move(files);
+    if (m_files)
+        m_files->update(std::vector<model::GameFile*>(m_file_list));
 
     onEntryPlayStatsChanged();
 
@@ -145,13 +147,37 @@ Game& Game::setCollections(std::vector<model::Collection*>&& collections)
 {
     std::sort(collections.begin(), collections.end(), model::sort_collections);
 
-    Q_ASSERT(!m_collections);
-    m_collections = new CollectionListModel(this);
-    m_collections->update(std::move(collections));
+    m_collection_list = std::move(collections);
+    if (m_collections)
+        m_collections->update(std::vector<model::Collection*>(m_collection_list));
+
     return *this;
 }
 
+GameFileListModel* Game::filesModel() const
+{
+    if (!m_files) {
+        Q_ASSERT(thread() == QThread::currentThread());
+        m_files = new GameFileListModel(const_cast<Game*>(this));
+        m_files->update(std::vector<model::GameFile*>(m_file_list));
+    }
+    return m_files;
+}
+
+CollectionListModel* Game::collectionsModel() const
+{
+    if (!m_collections) {
+        Q_ASSERT(thread() == QThread::currentThread());
+        m_collections = new CollectionListModel(const_cast<Game*>(this));
+        m_collections->update(std::vector<model::Collection*>(m_collection_list));
+    }
+    return m_collections;
+}
+
 bool sort_games(const model::Game* const a, const model::Game* const b) {
+   if (a->sortRank() > 0 && b->sortRank() > 0)
+       return a->sortRank() < b->sortRank();
+
    return QString::localeAwareCompare(a->sortBy(), b->sortBy()) < 0;
 }
 } // namespace model
@@ -41,6 +41,7 @@ struct GameData {
 
     QString title;
     QString sort_by;
+    int sort_rank = 0; ///< position by sort_by, see assign_sort_ranks
     QString summary;
     QString description;
 
@@ -79,6 +80,7 @@ public:
 
     GETTER(const QString&, title, title)
     GETTER(const QString&, sortBy, sort_by)
+    GETTER(int, sortRank, sort_rank)
     GETTER(const QString&, summary, summary)
     GETTER(const QString&, description, description)
     GETTER(const QDate&, releaseDate, release_date)
@@ -111,6 +113,7 @@ public:
 
     Game& setTitle(QString);
     SETTER(QString, SortBy, sort_by)
+    SETTER(int, SortRank, sort_rank)
     SETTER(QString, Summary, summary)
     SETTER(QString, Description, description)
     SETTER(QDate, ReleaseDate, release_date)
@@ -168,11 +171,14 @@ public:
     Assets* assetsPtr() const { return m_assets; }
     Q_PROPERTY(model::Assets* assets READ assetsPtr CONSTANT)
 
-    CollectionListModel* collectionsModel() const { return m_collections; }
+    // NOTE: The list models are only created on first use, usually by QML
+    CollectionListModel* collectionsModel() const;
     Q_PROPERTY(ObjectListModel* collections READ collectionsModel CONSTANT)
+    const std::vector<model::Collection*>& collectionsConst() const { return m_collection_list; }
 
-    GameFileListModel* filesModel() const { return m_files; }
+    GameFileListModel* filesModel() const;
     Q_PROPERTY(ObjectListModel* files READ filesModel CONSTANT)
+    const std::vector<model::GameFile*>& filesConst() const { return m_file_list; }
 
     Game& setFiles(std::vector<model::GameFile*>&&);
     Game& setCollections(std::vector<model::Collection*>&&);
@@ -183,8 +189,10 @@ private:
     Assets* const m_assets;
     QVariantMap m_extra;
 
-    CollectionListModel* m_collections = nullptr;
-    GameFileListModel* m_files = nullptr;
+    std::vector<model::Collection*> m_collection_list;
+    std::vector<model::GameFile*> m_file_list;
+    mutable CollectionListModel* m_collections = nullptr;
+    mutable GameFileListModel* m_files = nullptr;
 
 signals:
     void launchFileSelectorRequested();
@@ -153,13 +153,6 @@ void GameListModel::connectEntry(model::Game* const game)
 
 void GameListModel::onGamePropertyChanged(const QVector<int>& roles)
 {
-    QObject* const game_ptr = sender();
-    const auto it = std::find(m_entries.cbegin(), m_entries.cend(), game_ptr);
-    if (it == m_entries.cend())
-       return;
-
-    const size_t data_idx = std::distance(m_entries.cbegin(), it);
-    const QModelIndex model_idx = index(data_idx);
-    emit dataChanged(model_idx, model_idx, roles);
+    entryDataChanged(sender(), roles);
 }
 } // namespace model
@@ -0,0 +1,43 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2022  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "SortRank.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+
+namespace {
+// The scanning runs in a separate thread
+QMutex g_sort_locale_mutex;
+QLocale g_sort_locale;
+} // namespace
+
+
+namespace model {
+void set_sort_locale(const QLocale& locale)
+{
+    QMutexLocker lock(&g_sort_locale_mutex);
+    g_sort_locale = locale;
+}
+
+QCollator sort_collator()
+{
+    QMutexLocker lock(&g_sort_locale_mutex);
+    return QCollator(g_sort_locale);
+}
+} // namespace model
@@ -0,0 +1,58 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2022  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <QCollator>
+#include <QLocale>
+#include <algorithm>
+#include <vector>
+
+
+namespace model {
+/// The locale used for ordering games and collections, the system locale by default
+void set_sort_locale(const QLocale&);
+QCollator sort_collator();
+
+/// Sorts the items by their sort name, then stores their position in this
+/// order, so later sorts can compare numbers instead of collating strings.
+/// The items of a list should be ranked together, as ranks of separate calls
+/// are not comparable. T must have `sortBy()` and `setSortRank(int)`.
+template<typename T>
+void assign_sort_ranks(std::vector<T*>& items)
+{
+    const QCollator collator = sort_collator();
+
+    std::vector<std::pair<QCollatorSortKey, T*>> keyed_items;
+    keyed_items.reserve(items.size());
+    for (T* const item : items)
+        keyed_items.emplace_back(collator.sortKey(item->sortBy()), item);
+
+    using KeyedItem = std::pair<QCollatorSortKey, T*>;
+    std::sort(keyed_items.begin(), keyed_items.end(),
+        [](const KeyedItem& a, const KeyedItem& b){ return a.first.compare(b.first) < 0; });
+
+    int rank = 0;
+    for (size_t i = 0; i < keyed_items.size(); i++) {
+        if (i == 0 || keyed_items[i - 1].first.compare(keyed_items[i].first) != 0)
+            rank++;
+
+        keyed_items[i].second->setSortRank(rank);
+        items[i] = keyed_items[i].second;
+    }
+}
+} // namespace model
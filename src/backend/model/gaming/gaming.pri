@@ -5,7 +5,8 @@ HEADERS += \
     $$PWD/Game.h \
     $$PWD/GameFile.h \
     $$PWD/GameFileListModel.h \
-    $$PWD/GameListModel.h
+    $$PWD/GameListModel.h \
+    $$PWD/SortRank.h
 
 SOURCES += \
     $$PWD/Assets.cpp \
@@ -14,4 +15,5 @@ SOURCES += \
     $$PWD/Game.cpp \
     $$PWD/GameFile.cpp \
     $$PWD/GameFileListModel.cpp \
-    $$PWD/GameListModel.cpp
+    $$PWD/GameListModel.cpp \
+    $$PWD/SortRank.cpp
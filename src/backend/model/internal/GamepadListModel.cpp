@@ -145,6 +145,7 @@ void GamepadListModel::append(model::Gamepad* item)
 {
     beginInsertRows(QModelIndex(), count(), count());
     m_entries.emplace_back(item);
+    rebuildRowIndex();
     endInsertRows();
 
     emit countChanged();
@@ -159,6 +160,7 @@ void GamepadListModel::remove(model::Gamepad* item)
 
     beginRemoveRows(QModelIndex(), data_idx, data_idx);
     m_entries.erase(m_entries.begin() + data_idx);
+    rebuildRowIndex();
     endRemoveRows();
 
     emit countChanged();
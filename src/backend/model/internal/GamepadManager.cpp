@@ -32,8 +32,9 @@
 namespace {
 void call_gamepad_reconfig_scripts()
 {
-    ScriptRunner::run(ScriptEvent::CONFIG_CHANGED);
-    ScriptRunner::run(ScriptEvent::CONTROLS_CHANGED);
+    ScriptRunner::run_async(ScriptEvent::CONFIG_CHANGED, {}, [](){
+        ScriptRunner::run_async(ScriptEvent::CONTROLS_CHANGED, {});
+    });
 }
 
 inline QString pretty_id(int device_id) {
@@ -26,6 +26,7 @@
 #include <QFileInfo>
 #include <QStringBuilder>
 #include <QTextStream>
+#include <algorithm>
 #include <array>
 
 
@@ -268,6 +269,24 @@ GamepadButton detect_trigger_axis(Uint8 axis)
     }
 }
 
+// The events handled on the main thread, anything else stays on the input thread
+bool is_handled_event(Uint32 type)
+{
+    switch (type) {
+        case SDL_CONTROLLERDEVICEREMOVED:
+        case SDL_JOYDEVICEADDED:
+        case SDL_CONTROLLERBUTTONUP:
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERAXISMOTION:
+        case SDL_JOYBUTTONDOWN:
+        case SDL_JOYHATMOTION:
+        case SDL_JOYAXISMOTION:
+            return true;
+        default:
+            return false;
+    }
+}
+
 std::string generate_hat_str(int hat_idx, int hat_value)
 {
     return 'h' + std::to_string(hat_idx) + '.' + std::to_string(hat_value);
@@ -330,22 +349,73 @@ void GamepadManagerSDL2::RecordingState::reset()
     first_frame = true;
 }
 
+GamepadManagerSDL2::LatencyStats::LatencyStats()
+    : m_total(0)
+{}
+
+void GamepadManagerSDL2::LatencyStats::add(std::chrono::nanoseconds latency)
+{
+    m_samples[m_total % MAX_SAMPLES] = latency.count();
+    m_total++;
+}
+
+size_t GamepadManagerSDL2::LatencyStats::count() const
+{
+    return m_total < MAX_SAMPLES ? m_total : MAX_SAMPLES;
+}
+
+std::chrono::nanoseconds GamepadManagerSDL2::LatencyStats::percentile(int pct) const
+{
+    const size_t sample_cnt = count();
+    if (sample_cnt == 0)
+        return std::chrono::nanoseconds::zero();
+
+    std::vector<std::chrono::nanoseconds::rep> sorted(m_samples.cbegin(), m_samples.cbegin() + sample_cnt);
+    const size_t idx = (sample_cnt - 1) * static_cast<size_t>(qBound(0, pct, 100)) / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+    return std::chrono::nanoseconds(sorted[idx]);
+}
+
+
 GamepadManagerSDL2::GamepadManagerSDL2(QObject* parent)
     : GamepadManagerBackend(parent)
     , m_sdl_version(linked_sdl_version())
+    , m_running(false)
+    , m_drain_pending(false)
+    , m_wakeup_event_type(static_cast<Uint32>(-1))
+{}
+
+GamepadManagerSDL2::~GamepadManagerSDL2()
 {
-    connect(&m_poll_timer, &QTimer::timeout, this, &GamepadManagerSDL2::poll);
+    stop_input_thread();
 }
 
 void GamepadManagerSDL2::start(const backend::CliArgs& args)
 {
-    if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) != 0) {
+    // the setup is done on the input thread, but waited for here,
+    // so the mappings are ready when the first devices show up
+    std::promise<bool> init_promise;
+    std::future<bool> init_result = init_promise.get_future();
+
+    m_running = true;
+    m_input_thread = std::thread(&GamepadManagerSDL2::run_input_thread, this,
+        std::ref(init_promise), args.enable_gamepad_autoconfig);
+
+    if (!init_result.get()) {
+        m_running = false;
+        m_input_thread.join();
         Log::info(LOGMSG("Failed to initialize SDL2. Gamepad support may not work."));
+    }
+}
+
+bool GamepadManagerSDL2::init_input_thread(bool enable_autoconfig)
+{
+    if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) != 0) {
         print_sdl_error();
-        return;
+        return false;
     }
 
-    if (args.enable_gamepad_autoconfig) {
+    if (enable_autoconfig) {
         if (Q_UNLIKELY(!load_internal_gamepaddb(m_sdl_version)))
             print_sdl_error();
     }
@@ -353,18 +423,33 @@ void GamepadManagerSDL2::start(const backend::CliArgs& args)
     for (const QString& dir : paths::configDirs())
         load_user_gamepaddb(dir);
 
-    m_poll_timer.start(16);
+    m_wakeup_event_type = SDL_RegisterEvents(1);
+    return true;
 }
 
 void GamepadManagerSDL2::stop()
 {
-    // Make sure the polling stops before the devices disappear
-    m_poll_timer.stop();
+    // The devices are closed by the input thread, before it shuts down SDL
+    for (const auto& entry : m_idx_to_device)
+        release_controller(entry.second);
     m_iid_to_idx.clear();
     m_idx_to_device.clear();
 
-    SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER);
-    SDL_QuitSubSystem(SDL_INIT_JOYSTICK);
+    stop_input_thread();
+
+    // events left over from this run should not be handled by the next one
+    TimedEvent timed_event;
+    while (m_event_queue.pop(timed_event)) {}
+
+    if (m_latency.count() > 0) {
+        using std::chrono::microseconds;
+        using std::chrono::duration_cast;
+        Log::info(LOGMSG("SDL2: input latency of the last %1 events: %2 us median, %3 us 90th, %4 us 99th percentile")
+            .arg(QString::number(m_latency.count()),
+                 QString::number(duration_cast<microseconds>(m_latency.percentile(50)).count()),
+                 QString::number(duration_cast<microseconds>(m_latency.percentile(90)).count()),
+                 QString::number(duration_cast<microseconds>(m_latency.percentile(99)).count())));
+    }
 }
 
 void GamepadManagerSDL2::load_user_gamepaddb(const QString& dir)
@@ -428,6 +513,7 @@ void GamepadManagerSDL2::start_recording(int device_idx, GamepadButton button)
     m_recording.reset();
     m_recording.device = device_idx;
     m_recording.target_button = button;
+    schedule_first_frame_end();
 }
 
 void GamepadManagerSDL2::start_recording(int device_idx, GamepadAxis axis)
@@ -435,6 +521,13 @@ void GamepadManagerSDL2::start_recording(int device_idx, GamepadAxis axis)
     m_recording.reset();
     m_recording.device = device_idx;
     m_recording.target_axis = axis;
+    schedule_first_frame_end();
+}
+
+void GamepadManagerSDL2::schedule_first_frame_end()
+{
+    // the events already waiting belong to the frame the recording was started in
+    QMetaObject::invokeMethod(this, [this]{ drain_events(); }, Qt::QueuedConnection);
 }
 
 void GamepadManagerSDL2::cancel_recording()
@@ -445,62 +538,145 @@ void GamepadManagerSDL2::cancel_recording()
     m_recording.reset();
 }
 
-void GamepadManagerSDL2::poll()
+void GamepadManagerSDL2::run_input_thread(std::promise<bool>& init_promise, bool enable_autoconfig)
 {
+    const bool init_ok = init_input_thread(enable_autoconfig);
+    init_promise.set_value(init_ok); // the promise is gone after this
+    if (!init_ok)
+        return;
+
     SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-        switch (event.type) {
-            case SDL_CONTROLLERDEVICEADDED:
-                // ignored in favor of SDL_JOYDEVICEADDED
-                break;
-            case SDL_CONTROLLERDEVICEREMOVED:
-                remove_pad_by_iid(event.cdevice.which);
-                break;
-            case SDL_CONTROLLERDEVICEREMAPPED:
-                // ignored, could be logged
-                break;
-            case SDL_JOYDEVICEADDED:
-                add_controller_by_idx(event.jdevice.which);
-                break;
-            case SDL_JOYDEVICEREMOVED:
-                // ignored in favor of SDL_CONTROLLERDEVICEREMOVED
-                break;
-            case SDL_CONTROLLERBUTTONUP:
-            case SDL_CONTROLLERBUTTONDOWN:
-                // also ignore input from other (non-recording) gamepads
-                if (!m_recording.is_active()) {
-                    const bool pressed = event.cbutton.state == SDL_PRESSED;
-                    fwd_button_event(event.cbutton.which, event.cbutton.button, pressed);
-                }
-                break;
-            case SDL_CONTROLLERAXISMOTION:
-                if (!m_recording.is_active())
-                    fwd_axis_event(event.caxis.which, event.caxis.axis, event.caxis.value);
-                break;
-            case SDL_JOYBUTTONUP:
-                // ignored
-                break;
-            case SDL_JOYBUTTONDOWN:
-                record_joy_button_maybe(event.jbutton.which, event.jbutton.button);
-                break;
-            case SDL_JOYHATMOTION:
-                record_joy_hat_maybe(event.jhat.which, event.jhat.hat, event.jhat.value);
-                break;
-            case SDL_JOYAXISMOTION:
-                record_joy_axis_maybe(event.jaxis.which, event.jaxis.axis, event.jaxis.value);
-                break;
-            default:
+    while (m_running.load(std::memory_order_relaxed)) {
+        close_released_controllers();
+
+        // the timeout is only a safety net, stopping also sends a wakeup event
+        if (!SDL_WaitEventTimeout(&event, 500) || !is_handled_event(event.type))
+            continue;
+
+        TimedEvent timed_event { event, std::chrono::steady_clock::now(), nullptr };
+        if (event.type == SDL_JOYDEVICEADDED)
+            timed_event.opened_pad = open_controller(event.jdevice.which);
+
+        bool queued = true;
+        while (!m_event_queue.push(timed_event)) {
+            // the main thread is busy, but input should not be lost
+            if (!m_running.load(std::memory_order_relaxed)) {
+                queued = false;
                 break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
+        if (!queued) {
+            if (timed_event.opened_pad)
+                SDL_GameControllerClose(timed_event.opened_pad);
+            break;
+        }
+
+        if (!m_drain_pending.exchange(true))
+            QMetaObject::invokeMethod(this, [this]{ drain_events(); }, Qt::QueuedConnection);
+    }
+
+    // also closes the devices opened for events the main thread has not seen
+    close_released_controllers();
+    SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER);
+    SDL_QuitSubSystem(SDL_INIT_JOYSTICK);
+}
+
+void GamepadManagerSDL2::wake_input_thread()
+{
+    if (m_wakeup_event_type == static_cast<Uint32>(-1))
+        return;
+
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = m_wakeup_event_type;
+    SDL_PushEvent(&event);
+}
+
+void GamepadManagerSDL2::stop_input_thread()
+{
+    if (!m_input_thread.joinable())
+        return;
+
+    m_running = false;
+    wake_input_thread();
+    m_input_thread.join();
+}
+
+void GamepadManagerSDL2::drain_events()
+{
+    // cleared first, so an event pushed during the draining schedules a new call
+    m_drain_pending = false;
+
+    TimedEvent timed_event;
+    while (m_event_queue.pop(timed_event)) {
+        if (!m_running)
+            continue;
+
+        m_latency.add(std::chrono::steady_clock::now() - timed_event.received);
+        handle_event(timed_event);
     }
 
     m_recording.first_frame = false;
 }
 
-void GamepadManagerSDL2::add_controller_by_idx(int device_idx)
+void GamepadManagerSDL2::handle_event(const TimedEvent& timed_event)
+{
+    const SDL_Event& event = timed_event.event;
+
+    switch (event.type) {
+        case SDL_CONTROLLERDEVICEADDED:
+            // ignored in favor of SDL_JOYDEVICEADDED
+            break;
+        case SDL_CONTROLLERDEVICEREMOVED:
+            remove_pad_by_iid(event.cdevice.which);
+            break;
+        case SDL_CONTROLLERDEVICEREMAPPED:
+            // ignored, could be logged
+            break;
+        case SDL_JOYDEVICEADDED:
+            add_controller_by_idx(event.jdevice.which, timed_event.opened_pad);
+            break;
+        case SDL_JOYDEVICEREMOVED:
+            // ignored in favor of SDL_CONTROLLERDEVICEREMOVED
+            break;
+        case SDL_CONTROLLERBUTTONUP:
+        case SDL_CONTROLLERBUTTONDOWN:
+            // also ignore input from other (non-recording) gamepads
+            if (!m_recording.is_active()) {
+                const bool pressed = event.cbutton.state == SDL_PRESSED;
+                fwd_button_event(event.cbutton.which, event.cbutton.button, pressed);
+            }
+            break;
+        case SDL_CONTROLLERAXISMOTION:
+            if (!m_recording.is_active())
+                fwd_axis_event(event.caxis.which, event.caxis.axis, event.caxis.value);
+            break;
+        case SDL_JOYBUTTONUP:
+            // ignored
+            break;
+        case SDL_JOYBUTTONDOWN:
+            record_joy_button_maybe(event.jbutton.which, event.jbutton.button);
+            break;
+        case SDL_JOYHATMOTION:
+            record_joy_hat_maybe(event.jhat.which, event.jhat.hat, event.jhat.value);
+            break;
+        case SDL_JOYAXISMOTION:
+            record_joy_axis_maybe(event.jaxis.which, event.jaxis.axis, event.jaxis.value);
+            break;
+        default:
+            break;
+    }
+}
+
+int GamepadManagerSDL2::device_idx_of(SDL_JoystickID instance_id) const
 {
-    Q_ASSERT(m_idx_to_device.count(device_idx) == 0);
+    const auto it = m_iid_to_idx.find(instance_id);
+    return it != m_iid_to_idx.cend() ? it->second : -1;
+}
 
+SDL_GameController* GamepadManagerSDL2::open_controller(int device_idx)
+{
     if (!SDL_IsGameController(device_idx))
         try_register_default_mapping(device_idx);
 
@@ -508,8 +684,34 @@ void GamepadManagerSDL2::add_controller_by_idx(int device_idx)
     if (!pad) {
         Log::error(LOGMSG("SDL2: could not open gamepad %1").arg(pretty_idx(device_idx)));
         print_sdl_error();
-        return;
     }
+    return pad;
+}
+
+void GamepadManagerSDL2::close_released_controllers()
+{
+    SDL_GameController* pad = nullptr;
+    while (m_close_queue.pop(pad))
+        SDL_GameControllerClose(pad);
+}
+
+void GamepadManagerSDL2::release_controller(SDL_GameController* pad)
+{
+    // there are only a few devices, the input thread can keep up with them
+    while (!m_close_queue.push(pad))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    wake_input_thread();
+}
+
+void GamepadManagerSDL2::add_controller_by_idx(int device_idx, SDL_GameController* pad)
+{
+    // the device may have failed to open
+    if (!pad)
+        return;
+
+    // a device index is reused only after the device was removed
+    Q_ASSERT(m_idx_to_device.count(device_idx) == 0);
 
     const auto mapping = freeable_str(SDL_GameControllerMapping(pad));
     if (!mapping)
@@ -520,7 +722,7 @@ void GamepadManagerSDL2::add_controller_by_idx(int device_idx)
     SDL_Joystick* const joystick = SDL_GameControllerGetJoystick(pad);
     const SDL_JoystickID iid = SDL_JoystickInstanceID(joystick);
 
-    m_idx_to_device.emplace(device_idx, device_ptr(pad, SDL_GameControllerClose));
+    m_idx_to_device.emplace(device_idx, pad);
     m_iid_to_idx.emplace(iid, device_idx);
 
     emit connected(device_idx, name);
@@ -528,10 +730,13 @@ void GamepadManagerSDL2::add_controller_by_idx(int device_idx)
 
 void GamepadManagerSDL2::remove_pad_by_iid(SDL_JoystickID instance_id)
 {
-    Q_ASSERT(m_iid_to_idx.count(instance_id) == 1);
-    Q_ASSERT(m_idx_to_device.count(m_iid_to_idx.at(instance_id)) == 1);
+    // the device may have failed to open
+    const int device_idx = device_idx_of(instance_id);
+    if (device_idx < 0)
+        return;
 
-    const int device_idx = m_iid_to_idx.at(instance_id);
+    Q_ASSERT(m_idx_to_device.count(device_idx) == 1);
+    release_controller(m_idx_to_device.at(device_idx));
     m_idx_to_device.erase(device_idx);
     m_iid_to_idx.erase(instance_id);
 
@@ -543,13 +748,18 @@ void GamepadManagerSDL2::remove_pad_by_iid(SDL_JoystickID instance_id)
 
 void GamepadManagerSDL2::fwd_button_event(SDL_JoystickID instance_id, Uint8 button, bool pressed)
 {
-    const int device_idx = m_iid_to_idx.at(instance_id);
+    const int device_idx = device_idx_of(instance_id);
+    if (device_idx < 0)
+        return;
+
     emit buttonChanged(device_idx, translate_button(button), pressed);
 }
 
 void GamepadManagerSDL2::fwd_axis_event(SDL_JoystickID instance_id, Uint8 axis, Sint16 value)
 {
-    const int device_idx = m_iid_to_idx.at(instance_id);
+    const int device_idx = device_idx_of(instance_id);
+    if (device_idx < 0)
+        return;
 
     const GamepadButton button = detect_trigger_axis(axis);
     if (button != GamepadButton::INVALID) {
@@ -566,7 +776,7 @@ void GamepadManagerSDL2::record_joy_button_maybe(SDL_JoystickID instance_id, Uin
     if (!m_recording.is_active())
         return;
 
-    const int device_idx = m_iid_to_idx.at(instance_id);
+    const int device_idx = device_idx_of(instance_id);
     if (m_recording.device != device_idx)
         return;
 
@@ -579,7 +789,7 @@ void GamepadManagerSDL2::record_joy_axis_maybe(SDL_JoystickID instance_id, Uint8
     if (!m_recording.is_active())
         return;
 
-    const int device_idx = m_iid_to_idx.at(instance_id);
+    const int device_idx = device_idx_of(instance_id);
     if (m_recording.device != device_idx)
         return;
 
@@ -599,7 +809,7 @@ void GamepadManagerSDL2::record_joy_hat_maybe(SDL_JoystickID instance_id, Uint8
     if (!m_recording.is_active())
         return;
 
-    const int device_idx = m_iid_to_idx.at(instance_id);
+    const int device_idx = device_idx_of(instance_id);
     if (m_recording.device != device_idx)
         return;
 
@@ -629,7 +839,7 @@ std::string GamepadManagerSDL2::generate_mapping_for_field(const char* const fie
 std::string GamepadManagerSDL2::generate_mapping(int device_idx)
 {
     Q_ASSERT(m_idx_to_device.count(device_idx) == 1);
-    const device_ptr& pad_ptr = m_idx_to_device.at(device_idx);
+    SDL_GameController* const pad = m_idx_to_device.at(device_idx);
 
     std::array<char, GUID_LEN> guid_raw_str;
     const SDL_JoystickGUID guid = SDL_JoystickGetDeviceGUID(device_idx);
@@ -637,7 +847,7 @@ std::string GamepadManagerSDL2::generate_mapping(int device_idx)
 
     std::vector<std::string> list;
         list.emplace_back(utils::trimmed(guid_raw_str.data()));
-        list.emplace_back(SDL_GameControllerName(pad_ptr.get()));
+        list.emplace_back(SDL_GameControllerName(pad));
 
     const char* const recording_field = m_recording.is_active()
         ? (m_recording.target_button != GamepadButton::INVALID)
@@ -650,7 +860,7 @@ std::string GamepadManagerSDL2::generate_mapping(int device_idx)
         const auto item = static_cast<SDL_GameController##TYPE>(idx); \
     \
         const char* const field = SDL_GameControllerGetStringFor##TYPE(item); \
-        const auto current_bind = SDL_GameControllerGetBindFor##TYPE(pad_ptr.get(), item); \
+        const auto current_bind = SDL_GameControllerGetBindFor##TYPE(pad, item); \
     \
         std::string mapping = generate_mapping_for_field(field, recording_field, current_bind); \
         if (!mapping.empty()) \
@@ -716,8 +926,8 @@ QString GamepadManagerSDL2::mapping_for_button(int devide_idx, GamepadButton but
     if (device_entry == m_idx_to_device.cend())
         return {};
 
-    const device_ptr& pad_ptr = device_entry->second;
-    const SDL_GameControllerButtonBind bind = current_binding(pad_ptr.get(), button);
+    SDL_GameController* const pad = device_entry->second;
+    const SDL_GameControllerButtonBind bind = current_binding(pad, button);
     const std::string bind_str = generate_binding_str(bind);
     return QString::fromStdString(bind_str);
 }
@@ -728,8 +938,8 @@ QString GamepadManagerSDL2::mapping_for_axis(int devide_idx, GamepadAxis axis) c
     if (device_entry == m_idx_to_device.cend())
         return {};
 
-    const device_ptr& pad_ptr = device_entry->second;
-    const SDL_GameControllerButtonBind bind = current_binding(pad_ptr.get(), axis);
+    SDL_GameController* const pad = device_entry->second;
+    const SDL_GameControllerButtonBind bind = current_binding(pad, axis);
     const std::string bind_str = generate_binding_str(bind);
     return QString::fromStdString(bind_str);
 }
@@ -18,11 +18,15 @@
 #pragma once
 
 #include "utils/HashMap.h"
+#include "utils/SpscQueue.h"
 #include "GamepadManagerBackend.h"
 
 #include <SDL.h>
-#include <QTimer>
-#include <memory>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
 
 
 namespace model {
@@ -30,6 +34,7 @@ namespace model {
 class GamepadManagerSDL2 : public GamepadManagerBackend {
 public:
     explicit GamepadManagerSDL2(QObject* parent);
+    ~GamepadManagerSDL2() override;
 
     void start(const backend::CliArgs&) final;
     void stop() final;
@@ -41,19 +46,59 @@ public:
     QString mapping_for_button(int, GamepadButton) const final;
     QString mapping_for_axis(int, GamepadAxis) const final;
 
-private slots:
-    void poll();
+    /// The time between an event arriving on the input thread and
+    /// its handling on the main thread, for the most recent events
+    class LatencyStats {
+    public:
+        LatencyStats();
+
+        void add(std::chrono::nanoseconds);
+        size_t count() const;
+        /// The percentile of the stored samples, between 0 and 100
+        std::chrono::nanoseconds percentile(int) const;
+
+    private:
+        static constexpr size_t MAX_SAMPLES = 1024;
+        std::array<std::chrono::nanoseconds::rep, MAX_SAMPLES> m_samples;
+        size_t m_total;
+    };
+    const LatencyStats& input_latency() const { return m_latency; }
 
 private:
     const uint16_t m_sdl_version;
-    QTimer m_poll_timer;
 
-    using device_deleter = void(*)(SDL_GameController*);
-    using device_ptr = std::unique_ptr<SDL_GameController, device_deleter>;
-    HashMap<int, const device_ptr> m_idx_to_device;
+    // SDL events are waited for on a separate thread, then handled on the main one.
+    // SDL is initialized and shut down, and the devices are opened and closed
+    // on the input thread too, as the events have to be pumped where SDL was set up.
+    struct TimedEvent {
+        SDL_Event event;
+        std::chrono::steady_clock::time_point received;
+        SDL_GameController* opened_pad; // for device additions, if it could be opened
+    };
+    utils::SpscQueue<TimedEvent, 1024> m_event_queue;
+    // the devices no longer used by the main thread, to be closed on the input thread
+    utils::SpscQueue<SDL_GameController*, 64> m_close_queue;
+    std::thread m_input_thread;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_drain_pending;
+    Uint32 m_wakeup_event_type;
+    LatencyStats m_latency;
+
+    void run_input_thread(std::promise<bool>&, bool);
+    bool init_input_thread(bool);
+    void stop_input_thread();
+    void wake_input_thread();
+    void drain_events();
+    void handle_event(const TimedEvent&);
+
+    HashMap<int, SDL_GameController* const> m_idx_to_device;
     HashMap<SDL_JoystickID, const int> m_iid_to_idx;
 
-    void add_controller_by_idx(int);
+    int device_idx_of(SDL_JoystickID) const;
+    SDL_GameController* open_controller(int);
+    void close_released_controllers();
+    void release_controller(SDL_GameController*);
+    void add_controller_by_idx(int, SDL_GameController*);
     void remove_pad_by_iid(SDL_JoystickID);
     void fwd_button_event(SDL_JoystickID, Uint8, bool);
     void fwd_axis_event(SDL_JoystickID, Uint8, Sint16);
@@ -69,6 +114,7 @@ private:
         void reset();
     } m_recording;
 
+    void schedule_first_frame_end();
     void record_joy_button_maybe(SDL_JoystickID, Uint8);
     void record_joy_axis_maybe(SDL_JoystickID, Uint8, Sint16);
     void record_joy_hat_maybe(SDL_JoystickID, Uint8, Uint8);
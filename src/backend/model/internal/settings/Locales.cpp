@@ -19,6 +19,7 @@
 
 #include "AppSettings.h"
 #include "Log.h"
+#include "model/gaming/SortRank.h"
 
 #include <QCoreApplication>
 #include <QDir>
@@ -114,6 +115,7 @@ void Locales::load_selected_locale()
     m_translator.load(QStringLiteral("pegasus_") + locale.bcp47tag,
                       QStringLiteral(":/i18n"),
                       QStringLiteral("-"));
+    model::set_sort_locale(QLocale(locale.bcp47tag));
     Log::info(LOGMSG("Locale set to `%2`").arg(locale.bcp47tag));
 }
 
@@ -137,6 +137,28 @@ void Settings::setShowMissingGames(bool new_val)
     emit showMissingGamesChanged();
 }
 
+void Settings::setWatchGameDirs(bool new_val)
+{
+    if (new_val == AppSettings::general.watch_game_dirs)
+        return;
+
+    AppSettings::general.watch_game_dirs = new_val;
+    AppSettings::save_config();
+
+    emit watchGameDirsChanged();
+}
+
+void Settings::setKeepFrontendAlive(bool new_val)
+{
+    if (new_val == AppSettings::general.keep_frontend_alive)
+        return;
+
+    AppSettings::general.keep_frontend_alive = new_val;
+    AppSettings::save_config();
+
+    emit keepFrontendAliveChanged();
+}
+
 QStringList Settings::gameDirs() const
 {
     QSet<QString> dirset;
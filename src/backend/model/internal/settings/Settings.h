@@ -48,6 +48,12 @@ class Settings : public QObject {
     Q_PROPERTY(bool showMissingGames
                READ showMissingGames WRITE setShowMissingGames
                NOTIFY showMissingGamesChanged)
+    Q_PROPERTY(bool watchGameDirs
+               READ watchGameDirs WRITE setWatchGameDirs
+               NOTIFY watchGameDirsChanged)
+    Q_PROPERTY(bool keepFrontendAlive
+               READ keepFrontendAlive WRITE setKeepFrontendAlive
+               NOTIFY keepFrontendAliveChanged)
     Q_PROPERTY(QStringList gameDirs READ gameDirs NOTIFY gameDirsChanged)
     Q_PROPERTY(QStringList androidGrantedDirs READ androidGrantedDirs NOTIFY androidDirsChanged)
 
@@ -75,6 +81,12 @@ public:
     bool showMissingGames() const { return AppSettings::general.show_missing_games; }
     void setShowMissingGames(bool);
 
+    bool watchGameDirs() const { return AppSettings::general.watch_game_dirs; }
+    void setWatchGameDirs(bool);
+
+    bool keepFrontendAlive() const { return AppSettings::general.keep_frontend_alive; }
+    void setKeepFrontendAlive(bool);
+
     QStringList gameDirs() const;
     Q_INVOKABLE void addGameDir(const QString&);
     Q_INVOKABLE void removeGameDirs(const QVariantList&);
@@ -90,6 +102,8 @@ signals:
     void verifyFilesChanged();
     void scanOnLaunchChanged();
     void showMissingGamesChanged();
+    void watchGameDirsChanged();
+    void keepFrontendAliveChanged();
     void gameDirsChanged();
     void androidDirsChanged();
     void providerReloadingRequested();
@@ -58,6 +58,8 @@ Keys::Keys(QObject* parent)
 
 void Keys::refresh_keys()
 {
+    m_keycode_masks.clear();
+
     for (auto& entry : m_keylists) {
         auto& keylist = entry.second;
         free_keylist(keylist);
@@ -65,19 +67,38 @@ void Keys::refresh_keys()
         const auto& keyseq_list = AppSettings::keys.at(entry.first);
         keylist.reserve(keyseq_list.size());
 
-        for (const QKeySequence& keyseq : keyseq_list)
+        const int mask = event_mask(entry.first);
+        for (const QKeySequence& keyseq : keyseq_list) {
             keylist.append(new model::Key(keyseq, this));
 
+            // key events can only match single key sequences
+            if (keyseq.count() == 1)
+                m_keycode_masks[keyseq[0]] |= mask;
+        }
+
         keylist.squeeze();
     }
 
     emit keysChanged();
 }
 
-bool Keys::qmlkey_in_keylist(KeyEvent keytype, const QVariant& qmlevent) const
+int Keys::event_mask(KeyEvent keytype)
+{
+    // the internal events are numbered from 64, they get the bits from 16
+    constexpr auto first_internal = static_cast<unsigned char>(KeyEvent::LEFT);
+    const auto value = static_cast<unsigned char>(keytype);
+    const int bit = value < first_internal ? value : value - first_internal + 16;
+    return 1 << bit;
+}
+
+int Keys::matches(const QVariant& qmlevent) const
 {
-    const QKeySequence keyseq = utils::qmlevent_to_keyseq(qmlevent);
-    return AppSettings::keys.at(keytype).count(keyseq);
+    const int keycode = utils::qmlevent_to_keycode(qmlevent);
+    if (!keycode)
+        return 0;
+
+    const auto it = m_keycode_masks.find(keycode);
+    return it != m_keycode_masks.cend() ? it->second : 0;
 }
 
 QList<QObject*> Keys::to_qmlkeys(KeyEvent keytype)
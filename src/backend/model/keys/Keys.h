@@ -30,29 +30,33 @@ namespace model {
 class Keys : public QObject {
     Q_OBJECT
 
-    #define KEYVEC_PROP(keytype, keylist, checkFn) \
+    #define KEYVEC_PROP(keytype, keylist, checkFn, maskProp) \
         private: \
             Q_PROPERTY(QList<QObject*> keylist READ keylist NOTIFY keysChanged) \
+            Q_PROPERTY(int maskProp READ maskProp CONSTANT) \
             QList<QObject*> keylist() { \
                 return to_qmlkeys(KeyEvent::keytype); \
             } \
+            int maskProp() const { \
+                return event_mask(KeyEvent::keytype); \
+            } \
         public: \
             Q_INVOKABLE bool checkFn(const QVariant& qmlEvent) const { \
-                return qmlkey_in_keylist(KeyEvent::keytype, qmlEvent); \
+                return matches(qmlEvent) & event_mask(KeyEvent::keytype); \
             }
-    KEYVEC_PROP(LEFT, left, isLeft)
-    KEYVEC_PROP(RIGHT, right, isRight)
-    KEYVEC_PROP(UP, up, isUp)
-    KEYVEC_PROP(DOWN, down, isDown)
-    KEYVEC_PROP(ACCEPT, accept, isAccept)
-    KEYVEC_PROP(CANCEL, cancel, isCancel)
-    KEYVEC_PROP(DETAILS, details, isDetails)
-    KEYVEC_PROP(FILTERS, filters, isFilters)
-    KEYVEC_PROP(NEXT_PAGE, nextPage, isNextPage)
-    KEYVEC_PROP(PREV_PAGE, prevPage, isPrevPage)
-    KEYVEC_PROP(PAGE_UP, pageUp, isPageUp)
-    KEYVEC_PROP(PAGE_DOWN, pageDown, isPageDown)
-    KEYVEC_PROP(MAIN_MENU, menu, isMenu)
+    KEYVEC_PROP(LEFT, left, isLeft, leftMask)
+    KEYVEC_PROP(RIGHT, right, isRight, rightMask)
+    KEYVEC_PROP(UP, up, isUp, upMask)
+    KEYVEC_PROP(DOWN, down, isDown, downMask)
+    KEYVEC_PROP(ACCEPT, accept, isAccept, acceptMask)
+    KEYVEC_PROP(CANCEL, cancel, isCancel, cancelMask)
+    KEYVEC_PROP(DETAILS, details, isDetails, detailsMask)
+    KEYVEC_PROP(FILTERS, filters, isFilters, filtersMask)
+    KEYVEC_PROP(NEXT_PAGE, nextPage, isNextPage, nextPageMask)
+    KEYVEC_PROP(PREV_PAGE, prevPage, isPrevPage, prevPageMask)
+    KEYVEC_PROP(PAGE_UP, pageUp, isPageUp, pageUpMask)
+    KEYVEC_PROP(PAGE_DOWN, pageDown, isPageDown, pageDownMask)
+    KEYVEC_PROP(MAIN_MENU, menu, isMenu, menuMask)
     #undef KEYVEC_PROP
 
 public:
@@ -60,13 +64,19 @@ public:
 
     void refresh_keys();
 
+    /// All the events the key event belongs to, as a combination of the masks above,
+    /// so a single call can replace multiple `is...` checks
+    Q_INVOKABLE int matches(const QVariant& qmlEvent) const;
+
 signals:
     void keysChanged();
 
 private:
     HashMap<KeyEvent, QVector<QObject*>, EnumHash> m_keylists;
+    /// Key code with modifiers -> mask of the matching events
+    HashMap<int, int> m_keycode_masks;
 
-    bool qmlkey_in_keylist(KeyEvent, const QVariant&) const;
+    static int event_mask(KeyEvent);
     QList<QObject*> to_qmlkeys(KeyEvent);
 };
 
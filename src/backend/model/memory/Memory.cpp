@@ -25,10 +25,15 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJSValue>
+#include <QSaveFile>
 #include <QStringBuilder>
+#include <QtConcurrent/QtConcurrent>
 
 
 namespace {
+// Themes may store their state on every key press
+constexpr int WRITE_DELAY_MS = 1000;
+
 QString default_settings_dir()
 {
     return paths::writableConfigDir() % QStringLiteral("/theme_settings/");
@@ -41,7 +46,7 @@ QString json_path_for(const QString& settings_dir, const QString& theme_id)
 
 void save_map_maybe(const QVariantMap& map, const QString& settings_dir, const QString& theme_id)
 {
-    if (map.isEmpty() || theme_id.isEmpty())
+    if (theme_id.isEmpty())
         return;
 
     if (!QDir(settings_dir).mkpath(QStringLiteral("."))) {
@@ -50,8 +55,9 @@ void save_map_maybe(const QVariantMap& map, const QString& settings_dir, const Q
         return;
     }
 
+    // the previous file stays intact if writing fails midway
     const QString json_path = json_path_for(settings_dir, theme_id);
-    QFile json_file(json_path);
+    QSaveFile json_file(json_path);
     if (!json_file.open(QIODevice::WriteOnly)) {
         Log::warning(LOGMSG("could not save theme settings file `%1`: %2")
             .arg(json_path, json_file.errorString()));
@@ -59,7 +65,7 @@ void save_map_maybe(const QVariantMap& map, const QString& settings_dir, const Q
     }
 
     const auto json_doc = QJsonDocument::fromVariant(map);
-    if (json_file.write(json_doc.toJson(QJsonDocument::Compact)) < 0) {
+    if (json_file.write(json_doc.toJson(QJsonDocument::Compact)) < 0 || !json_file.commit()) {
         Log::warning(LOGMSG("failed to write theme settings file `%1`: %2")
             .arg(json_path, json_file.errorString()));
     }
@@ -102,11 +108,57 @@ Memory::Memory(QObject* parent)
 Memory::Memory(QString settings_dir, QObject* parent)
     : QObject(parent)
     , m_settings_dir(std::move(settings_dir))
-{}
+{
+    m_write_timer.setSingleShot(true);
+    m_write_timer.setInterval(WRITE_DELAY_MS);
+    connect(&m_write_timer, &QTimer::timeout,
+            this, &Memory::startWrite);
+
+    // changes made during a write are saved after it
+    connect(&m_write_watcher, &QFutureWatcher<void>::finished,
+            this, [this]{
+                if (m_unsaved_changes && !m_write_timer.isActive())
+                    startWrite();
+            });
+}
+
+Memory::~Memory()
+{
+    flush();
+}
+
+bool Memory::hasPendingWrites() const
+{
+    return m_unsaved_changes || m_write_watcher.isRunning();
+}
+
+void Memory::scheduleWrite()
+{
+    m_unsaved_changes = true;
+
+    // not restarted, so frequent changes still get saved regularly
+    if (!m_write_timer.isActive())
+        m_write_timer.start();
+}
+
+void Memory::startWrite()
+{
+    if (!m_unsaved_changes || m_write_watcher.isRunning())
+        return;
+
+    m_unsaved_changes = false;
+    m_write_watcher.setFuture(QtConcurrent::run(save_map_maybe, m_data, m_settings_dir, m_current_theme));
+}
 
-void Memory::flush() const
+void Memory::flush()
 {
-    save_map_maybe(m_data, m_settings_dir, m_current_theme);
+    m_write_timer.stop();
+    m_write_watcher.waitForFinished();
+
+    if (m_unsaved_changes) {
+        m_unsaved_changes = false;
+        save_map_maybe(m_data, m_settings_dir, m_current_theme);
+    }
 }
 
 QVariant Memory::get(const QString& key) const
@@ -137,7 +189,7 @@ void Memory::set(const QString& key, QVariant value)
     m_data[key] = std::move(value);
     emit dataChanged();
 
-    flush();
+    scheduleWrite();
 }
 
 void Memory::unset(const QString& key)
@@ -145,7 +197,7 @@ void Memory::unset(const QString& key)
     m_data.remove(key);
     emit dataChanged();
 
-    flush();
+    scheduleWrite();
 }
 
 void Memory::changeTheme(const QString& theme_root_dir)
@@ -154,6 +206,8 @@ void Memory::changeTheme(const QString& theme_root_dir)
     const int dir_name_start = theme_root_dir.lastIndexOf('/', -2) + 1;
     const int dir_name_len = theme_root_dir.length() - dir_name_start - 1;
     Q_ASSERT(dir_name_len > 0);
+
+    flush();
     m_current_theme = theme_root_dir.mid(dir_name_start, dir_name_len);
 
     m_data = load_map_maybe(m_settings_dir, m_current_theme);
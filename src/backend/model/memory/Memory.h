@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <QFutureWatcher>
 #include <QObject>
+#include <QTimer>
 #include <QVariantMap>
 
 
@@ -28,6 +30,7 @@ class Memory : public QObject {
 public:
     explicit Memory(QObject* parent = nullptr);
     explicit Memory(QString settings_dir, QObject* parent = nullptr);
+    ~Memory();
 
     Q_INVOKABLE QVariant get(const QString&) const;
     Q_INVOKABLE bool has(const QString&) const;
@@ -36,6 +39,11 @@ public:
 
     void changeTheme(const QString&);
 
+    /// Changes are written in the background, shortly after the last one;
+    /// this writes them right away and waits for it to finish
+    void flush();
+    bool hasPendingWrites() const;
+
 signals:
     // NOTE: because QVariantMap cannot be changed on the QML side (QTBUG-59474),
     // get/set functions were introduced. Because of this however, sending a
@@ -47,6 +55,11 @@ private:
     QString m_current_theme;
     QVariantMap m_data;
 
-    void flush() const;
+    bool m_unsaved_changes = false;
+    QTimer m_write_timer;
+    QFutureWatcher<void> m_write_watcher;
+
+    void scheduleWrite();
+    void startWrite();
 };
 } // namespace model
@@ -23,6 +23,77 @@
 #include <QRegularExpression>
 #include <QStringBuilder>
 #include <QTextStream>
+#include <cstring>
+
+
+namespace {
+bool is_continuation_byte(const char ch)
+{
+    return (static_cast<unsigned char>(ch) & 0xC0) == 0x80;
+}
+
+// Returns the byte length of the UTF-8 encoded whitespace character at the position,
+// or 0 if there is none; matches the characters of QChar::isSpace()
+int space_len_at(const char* const it, const char* const end)
+{
+    const auto lead = static_cast<unsigned char>(*it);
+    if (lead < 0x80)
+        return (lead == ' ' || ('\t' <= lead && lead <= '\r')) ? 1 : 0;
+
+    // The non-ASCII spaces are all in the U+0085 - U+3000 range
+    if (lead == 0xC2 && end - it >= 2 && is_continuation_byte(it[1])) {
+        const uint codepoint = ((lead & 0x1F) << 6) | (it[1] & 0x3F);
+        return QChar::isSpace(codepoint) ? 2 : 0;
+    }
+    if (0xE1 <= lead && lead <= 0xE3 && end - it >= 3 && is_continuation_byte(it[1]) && is_continuation_byte(it[2])) {
+        const uint codepoint = ((lead & 0x0F) << 12) | ((it[1] & 0x3F) << 6) | (it[2] & 0x3F);
+        return QChar::isSpace(codepoint) ? 3 : 0;
+    }
+    return 0;
+}
+
+// Same as above, for the character ending at the position
+int space_len_before(const char* const begin, const char* const it)
+{
+    for (int len = 1; len <= 3 && it - len >= begin; len++) {
+        if (len > 1 && !is_continuation_byte(it[1 - len]))
+            return 0;
+        if (!is_continuation_byte(it[-len]))
+            return space_len_at(it - len, it) == len ? len : 0;
+    }
+    return 0;
+}
+
+std::pair<const char*, const char*> trimmed(const char* begin, const char* end)
+{
+    int len = 0;
+    while (begin < end && (len = space_len_at(begin, end)) > 0)
+        begin += len;
+    while (begin < end && (len = space_len_before(begin, end)) > 0)
+        end -= len;
+
+    return { begin, end };
+}
+
+// Keys are almost always ASCII, lowercasing them can reuse the previous buffer
+void assign_lowercase(QString& out, const char* const begin, const char* const end)
+{
+    const int len = static_cast<int>(end - begin);
+    for (const char* it = begin; it != end; ++it) {
+        if (static_cast<unsigned char>(*it) >= 0x80) {
+            out = QString::fromUtf8(begin, len).toLower();
+            return;
+        }
+    }
+
+    out.resize(len);
+    QChar* const out_data = out.data();
+    for (int i = 0; i < len; i++) {
+        const char ch = begin[i];
+        out_data[i] = QLatin1Char(('A' <= ch && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a') : ch);
+    }
+}
+} // namespace
 
 
 namespace metafile {
@@ -34,6 +105,31 @@ void Entry::reset()
     values.clear();
 }
 
+QString LineView::toString() const
+{
+    return data
+        ? QString::fromUtf8(data, size)
+        : QString();
+}
+
+void EntryView::reset()
+{
+    line = 0;
+    key.truncate(0); // keeps the buffer
+    values.clear();
+}
+
+void EntryView::copy_to(Entry& entry) const
+{
+    entry.line = line;
+    entry.key = key;
+
+    entry.values.clear();
+    entry.values.reserve(values.size());
+    for (const LineView& value : values)
+        entry.values.emplace_back(value.toString());
+}
+
 
 /// Opens the file at the path, then calls the stream reading on it.
 /// Returns false if the file could not be opened.
@@ -145,6 +241,124 @@ void read_stream(QTextStream& stream,
     close_current_attrib();
 }
 
+/// Memory maps the file, then parses its contents.
+/// Returns false if the file could not be opened.
+bool read_mapped_file(const QString& path,
+                      const std::function<void(const EntryView&)>& onAttributeFound,
+                      const std::function<void(const Error&)>& onError)
+{
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly))
+        return false;
+
+    const qint64 file_size = file.size();
+    const uchar* const mapped = file_size > 0 ? file.map(0, file_size) : nullptr;
+    if (mapped) {
+        read_buffer(reinterpret_cast<const char*>(mapped), static_cast<size_t>(file_size), onAttributeFound, onError);
+        return true;
+    }
+
+    // eg. compressed resource files can't be mapped
+    const QByteArray contents = file.readAll();
+    read_buffer(contents.constData(), static_cast<size_t>(contents.size()), onAttributeFound, onError);
+    return true;
+}
+
+/// Parses UTF-8 text the same way as read_stream(), but the values
+/// of the reported entries refer to the buffer instead of being copied.
+void read_buffer(const char* const data, const size_t size,
+                 const std::function<void(const EntryView&)>& onAttributeFound,
+                 const std::function<void(const Error&)>& onError)
+{
+    constexpr char EMPTY_LINE_MARK = '.';
+    constexpr char CH_COLON = ':';
+
+    EntryView entry {0, {}, {}};
+
+    const auto close_current_attrib = [&](){
+        if (!entry.key.isEmpty()) {
+            if (entry.values.empty())
+                onError({ entry.line, LOGMSG("attribute value missing, entry ignored") });
+            else
+                onAttributeFound(entry);
+        }
+
+        entry.reset();
+    };
+
+    const char* line_begin = data;
+    const char* const data_end = data + size;
+
+    // skip the byte order mark, like QTextStream does
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+        line_begin += 3;
+
+    size_t linenum = 0;
+    while (line_begin < data_end) {
+        linenum++;
+
+        const char* line_end = static_cast<const char*>(std::memchr(line_begin, '\n', data_end - line_begin));
+        const char* const next_line = line_end ? line_end + 1 : data_end;
+        if (!line_end)
+            line_end = data_end;
+        if (line_begin < line_end && line_end[-1] == '\r')
+            line_end--;
+
+        const char* const raw_begin = line_begin;
+        line_begin = next_line;
+
+        if (raw_begin < line_end && *raw_begin == '#')
+            continue;
+
+        const auto trimmed_line = trimmed(raw_begin, line_end);
+        if (trimmed_line.first == trimmed_line.second) {
+            close_current_attrib();
+            continue;
+        }
+
+        // multiline (starts with whitespace but also has content)
+        if (space_len_at(raw_begin, line_end) > 0) {
+            if (entry.key.isEmpty()) {
+                onError({ linenum, LOGMSG("line starts with whitespace, but no attribute has been defined yet") });
+                continue;
+            }
+
+            const int value_len = static_cast<int>(trimmed_line.second - trimmed_line.first);
+            if (value_len == 1 && *trimmed_line.first == EMPTY_LINE_MARK) {
+                entry.values.push_back({ nullptr, 0 });
+                continue;
+            }
+
+            entry.values.push_back({ trimmed_line.first, value_len });
+            continue;
+        }
+
+        // either a new entry or error - in both cases, the previous entry should be closed
+        close_current_attrib();
+
+        // keyval pair (after the multiline check)
+        const char* const key_end = static_cast<const char*>(
+            std::memchr(trimmed_line.first, CH_COLON, trimmed_line.second - trimmed_line.first));
+        if (key_end && key_end > trimmed_line.first) {
+            const auto key_part = trimmed(trimmed_line.first, key_end);
+            assign_lowercase(entry.key, key_part.first, key_part.second);
+
+            // the value can be empty here, if it's purely multiline
+            const auto value_part = trimmed(key_end + 1, trimmed_line.second);
+            if (value_part.first != value_part.second)
+                entry.values.push_back({ value_part.first, static_cast<int>(value_part.second - value_part.first) });
+
+            entry.line = linenum;
+            continue;
+        }
+
+        // invalid line
+        onError({ linenum, LOGMSG("line invalid, skipped") });
+    }
+
+    close_current_attrib();
+}
+
 
 /// Creates a single text from the separate lines. Lines are expected to be
 /// null strings or non-empty trimmed text
@@ -37,6 +37,26 @@ struct Entry {
     void reset();
     MOVE_ONLY(Entry)
 };
+/// A trimmed part of a line, pointing into the UTF-8 contents of the file
+struct LineView {
+    const char* data;
+    int size;
+
+    /// Decodes the text; the empty line mark (null data) becomes a null string
+    QString toString() const;
+};
+/// Like Entry, but the values are only views into the file contents,
+/// valid during the callback. Decode what needs to be kept.
+struct EntryView {
+    size_t line;
+    QString key;
+    std::vector<LineView> values;
+
+    void reset();
+    /// Decodes the values into the entry, reusing its storage
+    void copy_to(Entry&) const;
+    MOVE_ONLY(EntryView)
+};
 struct Error {
     size_t line;
     QString message;
@@ -57,6 +77,17 @@ void read_file(QFile& file,
                const std::function<void(const Entry&)>& onAttributeFound,
                const std::function<void(const Error&)>& onError);
 
+/// Parses the file without line by line text decoding, by memory mapping
+/// (or, if that's not possible, reading) it in one go.
+/// Returns false if the file could not be opened.
+bool read_mapped_file(const QString& path,
+                      const std::function<void(const EntryView&)>& onAttributeFound,
+                      const std::function<void(const Error&)>& onError);
+
+void read_buffer(const char* data, size_t size,
+                 const std::function<void(const EntryView&)>& onAttributeFound,
+                 const std::function<void(const Error&)>& onError);
+
 
 QString merge_lines(const std::vector<QString>&);
 
@@ -54,6 +54,16 @@ bool store_bool_maybe(const QString& str, bool& target)
     return success;
 }
 
+bool store_seconds_maybe(const QString& str, int& target)
+{
+    bool success = false;
+    const int value = str.toInt(&success);
+    if (success && value >= 0)
+        target = value;
+
+    return success && value >= 0;
+}
+
 } // namespace
 
 
@@ -71,6 +81,9 @@ ConfigEntryMaps::ConfigEntryMaps()
         { QStringLiteral("verify-files"), GeneralOption::VERIFY_FILES },
         { QStringLiteral("scan-on-launch"), GeneralOption::SCAN_ON_LAUNCH },
         { QStringLiteral("show-missing-games"), GeneralOption::SHOW_MISSING_GAMES },
+        { QStringLiteral("watch-game-dirs"), GeneralOption::WATCH_GAME_DIRS },
+        { QStringLiteral("keep-frontend-alive"), GeneralOption::KEEP_FRONTEND_ALIVE },
+        { QStringLiteral("script-timeout"), GeneralOption::SCRIPT_TIMEOUT },
         { QStringLiteral("locale"), GeneralOption::LOCALE },
         { QStringLiteral("theme"), GeneralOption::THEME },
     }
@@ -125,6 +138,11 @@ void LoadContext::log_needs_bool(const size_t lineno, const QString& key) const
     log_error(lineno, LOGMSG("this option (`%1`) must be a boolean (true/false) value").arg(key));
 }
 
+void LoadContext::log_needs_seconds(const size_t lineno, const QString& key) const
+{
+    log_error(lineno, LOGMSG("this option (`%1`) must be a number of seconds, or 0 for no limit").arg(key));
+}
+
 void LoadContext::handle_entry(const size_t lineno,
                                const QString& key,
                                const std::vector<QString>& vals) const
@@ -185,6 +203,18 @@ void LoadContext::handle_general_attrib(const size_t lineno, const QString& key,
             if (!store_bool_maybe(val, AppSettings::general.show_missing_games))
                 log_needs_bool(lineno, key);
             break;
+        case ConfigEntryGeneralOption::WATCH_GAME_DIRS:
+            if (!store_bool_maybe(val, AppSettings::general.watch_game_dirs))
+                log_needs_bool(lineno, key);
+            break;
+        case ConfigEntryGeneralOption::KEEP_FRONTEND_ALIVE:
+            if (!store_bool_maybe(val, AppSettings::general.keep_frontend_alive))
+                log_needs_bool(lineno, key);
+            break;
+        case ConfigEntryGeneralOption::SCRIPT_TIMEOUT:
+            if (!store_seconds_maybe(val, AppSettings::general.script_timeout_sec))
+                log_needs_seconds(lineno, key);
+            break;
         case ConfigEntryGeneralOption::LOCALE:
             AppSettings::general.locale = val;
             break;
@@ -319,6 +349,9 @@ void SaveContext::print_general(QTextStream& stream) const
         { GeneralOption::VERIFY_FILES, AppSettings::general.verify_files ? STR_TRUE : STR_FALSE },
         { GeneralOption::SCAN_ON_LAUNCH, AppSettings::general.scan_on_launch ? STR_TRUE : STR_FALSE },
         { GeneralOption::SHOW_MISSING_GAMES, AppSettings::general.show_missing_games ? STR_TRUE : STR_FALSE },
+        { GeneralOption::WATCH_GAME_DIRS, AppSettings::general.watch_game_dirs ? STR_TRUE : STR_FALSE },
+        { GeneralOption::KEEP_FRONTEND_ALIVE, AppSettings::general.keep_frontend_alive ? STR_TRUE : STR_FALSE },
+        { GeneralOption::SCRIPT_TIMEOUT, QString::number(AppSettings::general.script_timeout_sec) },
         { GeneralOption::LOCALE, AppSettings::general.locale },
         { GeneralOption::THEME, theme_path },
     };
@@ -40,6 +40,9 @@ enum class ConfigEntryGeneralOption : unsigned char {
     VERIFY_FILES,
     SCAN_ON_LAUNCH,
     SHOW_MISSING_GAMES,
+    WATCH_GAME_DIRS,
+    KEEP_FRONTEND_ALIVE,
+    SCRIPT_TIMEOUT,
     LOCALE,
     THEME,
 };
@@ -75,6 +78,7 @@ private:
     void log_error(const size_t lineno, const QString& msg) const;
     void log_unknown_key(const size_t lineno, const QString& key) const;
     void log_needs_bool(const size_t lineno, const QString& key) const;
+    void log_needs_seconds(const size_t lineno, const QString& key) const;
 
 private:
     void handle_entry(const size_t lineno, const QString& key, const std::vector<QString>& vals) const;
@@ -0,0 +1,146 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "FileCache.h"
+
+#include "utils/PathTools.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+
+namespace providers {
+
+FileCache::FileCache()
+    : m_queries(0)
+    , m_dir_reads(0)
+{}
+
+FileCache::DirListing FileCache::read_dir(const QString& dir_path)
+{
+    DirListing listing;
+
+    // on most file systems, the type of the entries comes with the listing
+    QDirIterator iter(dir_path, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    while (iter.hasNext()) {
+        iter.next();
+        const QFileInfo finfo = iter.fileInfo();
+
+        Entry entry;
+        entry.exists = finfo.exists();
+        entry.is_file = finfo.isFile();
+        entry.is_dir = finfo.isDir();
+        listing.emplace(::fs_name_key(finfo.fileName()), std::move(entry));
+    }
+    return listing;
+}
+
+FileCache::Entry FileCache::find_entry(const QString& path, const bool with_details)
+{
+    const QString abs_path = QDir::cleanPath(QDir::isAbsolutePath(path)
+        ? path
+        : QFileInfo(path).absoluteFilePath());
+
+    Entry result;
+
+    const int slash_pos = abs_path.lastIndexOf(QLatin1Char('/'));
+    if (slash_pos < 0 || slash_pos == abs_path.length() - 1) {
+        // file system roots are not part of any listing
+        const QFileInfo finfo(abs_path);
+        result.exists = finfo.exists();
+        result.is_file = finfo.isFile();
+        result.is_dir = finfo.isDir();
+        result.has_details = true;
+        result.size = finfo.size();
+        result.mtime = finfo.lastModified();
+        return result;
+    }
+
+    const QString dir_path = abs_path.left(slash_pos + 1);
+    QString dir_key = ::fs_name_key(dir_path);
+
+    QMutexLocker lock(&m_lock);
+    m_queries++;
+
+    auto dir_it = m_dirs.find(dir_key);
+    if (dir_it == m_dirs.end()) {
+        // the listing may be slow, other directories can be queried meanwhile
+        lock.unlock();
+        DirListing listing = read_dir(dir_path);
+        lock.relock();
+
+        // if an other thread has listed the same directory meanwhile, its result is kept
+        const auto inserted = m_dirs.emplace(std::move(dir_key), std::move(listing));
+        dir_it = inserted.first;
+        if (inserted.second)
+            m_dir_reads++;
+    }
+
+    const auto entry_it = dir_it->second.find(::fs_name_key(abs_path.mid(slash_pos + 1)));
+    if (entry_it == dir_it->second.end())
+        return result;
+
+    Entry& entry = entry_it->second;
+    if (with_details && !entry.has_details) {
+        const QFileInfo finfo(abs_path);
+        entry.has_details = true;
+        entry.size = finfo.size();
+        entry.mtime = finfo.lastModified();
+    }
+    return entry;
+}
+
+bool FileCache::exists(const QString& path)
+{
+    return find_entry(path, false).exists;
+}
+
+bool FileCache::is_file(const QString& path)
+{
+    return find_entry(path, false).is_file;
+}
+
+bool FileCache::is_dir(const QString& path)
+{
+    return find_entry(path, false).is_dir;
+}
+
+qint64 FileCache::size(const QString& path)
+{
+    return find_entry(path, true).size;
+}
+
+QDateTime FileCache::last_modified(const QString& path)
+{
+    return find_entry(path, true).mtime;
+}
+
+size_t FileCache::query_count() const
+{
+    QMutexLocker lock(&m_lock);
+    return m_queries;
+}
+
+size_t FileCache::dir_read_count() const
+{
+    QMutexLocker lock(&m_lock);
+    return m_dir_reads;
+}
+
+} // namespace providers
@@ -0,0 +1,69 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "utils/HashMap.h"
+#include "utils/NoCopyNoMove.h"
+
+#include <QDateTime>
+#include <QMutex>
+#include <QString>
+
+
+namespace providers {
+
+/// Answers file queries from directory listings. A directory is read once,
+/// on the first query about one of its entries; the size and modification time
+/// of a file is only queried when asked for. The results are never refreshed,
+/// so an instance should only live for the duration of a scan.
+class FileCache {
+public:
+    FileCache();
+    NO_COPY_NO_MOVE(FileCache)
+
+    bool exists(const QString&);
+    bool is_file(const QString&);
+    bool is_dir(const QString&);
+    qint64 size(const QString&);
+    QDateTime last_modified(const QString&);
+
+    /// The number of queries answered, and the directory reads needed for them
+    size_t query_count() const;
+    size_t dir_read_count() const;
+
+private:
+    struct Entry {
+        bool exists = false;
+        bool is_file = false;
+        bool is_dir = false;
+        bool has_details = false;
+        qint64 size = 0;
+        QDateTime mtime;
+    };
+    using DirListing = HashMap<QString, Entry>;
+
+    mutable QMutex m_lock;
+    HashMap<QString, DirListing> m_dirs;
+    size_t m_queries;
+    size_t m_dir_reads;
+
+    static DirListing read_dir(const QString&);
+    Entry find_entry(const QString&, bool with_details);
+};
+
+} // namespace providers
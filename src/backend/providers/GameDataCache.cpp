@@ -27,6 +27,8 @@
 #include "model/gaming/Game.h"
 #include "model/gaming/GameFile.h"
 #include "types/AssetType.h"
+#include "utils/HashMap.h"
+#include "utils/PathTools.h"
 
 #include <QCryptographicHash>
 #include <QDate>
@@ -37,95 +39,572 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QJsonValue>
 #include <QSaveFile>
 #include <QStringList>
+#include <algorithm>
+#include <cstring>
 
 namespace {
-constexpr int CACHE_SCHEMA_VERSION = 1;
+constexpr int CACHE_SCHEMA_VERSION = 3;
 
-QJsonArray string_list_to_json(const QStringList& values)
+// The index is a single binary blob, written in the native byte order (a
+// foreign byte order fails the magic check and simply causes a rescan):
+//
+//   IndexHeader
+//   StringRecord[string_count]   -- offset/length pairs into the char data
+//   CollectionRecord[collection_count]
+//   GameRecord[game_count]
+//   FileRecord[file_count]
+//   AssetRecord[asset_count]
+//   ScopeRecord[scope_count]     -- the root game dirs, for incremental rescans
+//   MetafileRecord[metafile_count]
+//   quint32[id_count]            -- string and collection id lists
+//   QChar[char_count]            -- UTF-16 data of the deduplicated strings
+//
+// Every string field is an index into the string table, with 0 being the empty string.
+// Sections are aligned to the alignment of their record type.
+constexpr quint32 INDEX_MAGIC = 0x58494750; // 'PGIX'
+constexpr int FINGERPRINT_LEN = 64;
+
+struct IndexRange {
+    quint32 first;
+    quint32 count;
+};
+
+struct IndexHeader {
+    quint32 magic;
+    quint32 version;
+    char fingerprint[FINGERPRINT_LEN];
+    IndexRange strings;
+    IndexRange collections;
+    IndexRange games;
+    IndexRange files;
+    IndexRange assets;
+    IndexRange scopes;
+    IndexRange metafiles;
+    IndexRange ids;
+    IndexRange chars;
+};
+
+struct StringRecord {
+    quint32 offset;
+    quint32 length;
+};
+
+struct CollectionRecord {
+    quint32 name;
+    quint32 sort_by;
+    quint32 short_name;
+    quint32 summary;
+    quint32 description;
+    quint32 launch_cmd;
+    quint32 launch_workdir;
+    quint32 relative_basedir;
+    IndexRange assets;
+    quint32 source_dir; // the only root game dir that defined the collection, if any
+    quint32 reserved;
+};
+
+constexpr quint8 GAME_FLAG_SHARED = (1 << 0); // found by multiple providers
+
+struct GameRecord {
+    quint32 title;
+    quint32 sort_by;
+    quint32 summary;
+    quint32 description;
+    quint32 launch_cmd;
+    quint32 launch_workdir;
+    quint32 relative_basedir;
+    IndexRange developers;
+    IndexRange publishers;
+    IndexRange genres;
+    IndexRange tags;
+    IndexRange collections;
+    IndexRange files;
+    IndexRange assets;
+    quint32 release_date; // YYYYMMDD, 0 if not set
+    float rating;
+    quint16 player_count;
+    quint8 missing;
+    quint8 flags;
+};
+
+struct FileRecord {
+    quint32 path;
+    quint32 name;
+    quint32 uri;
+};
+
+struct AssetRecord {
+    quint32 type;
+    quint32 uri;
+};
+
+struct ScopeRecord {
+    quint32 dir;
+    IndexRange metafiles;
+};
+
+struct MetafileRecord {
+    quint32 path;
+    quint32 reserved;
+    qint64 size;
+    qint64 mtime;
+};
+
+static_assert(sizeof(IndexHeader) % 4 == 0, "Index sections must stay 4-byte aligned");
+static_assert(sizeof(CollectionRecord) == 48, "Unexpected padding in the collection record");
+static_assert(sizeof(GameRecord) == 96, "Unexpected padding in the game record");
+static_assert(sizeof(MetafileRecord) == 24, "Unexpected padding in the metafile record");
+
+
+struct MetafileStamp {
+    QString path;
+    qint64 size;
+    qint64 mtime;
+
+    bool operator==(const MetafileStamp& other) const {
+        return size == other.size && mtime == other.mtime && path == other.path;
+    }
+};
+
+std::vector<MetafileStamp> find_metafile_stamps(const QString& dir_path)
 {
-    QJsonArray out;
-    for (const QString& value : values)
-        out.append(value);
-    return out;
+    const QStringList filters {
+        QStringLiteral("metadata.pegasus.txt"),
+        QStringLiteral("metadata.txt"),
+        QStringLiteral("*.metadata.pegasus.txt"),
+        QStringLiteral("*.metadata.txt"),
+    };
+
+    std::vector<MetafileStamp> result;
+
+    QDirIterator dir_it(dir_path, filters, QDir::Files | QDir::NoDotAndDotDot);
+    while (dir_it.hasNext()) {
+        dir_it.next();
+        const QFileInfo finfo = dir_it.fileInfo();
+        result.push_back({ finfo.absoluteFilePath(), finfo.size(), finfo.lastModified().toMSecsSinceEpoch() });
+    }
+
+    std::sort(result.begin(), result.end(),
+        [](const MetafileStamp& a, const MetafileStamp& b){ return a.path < b.path; });
+    return result;
+}
+
+
+quint32 date_to_record(const QDate& date)
+{
+    return date.isValid()
+        ? static_cast<quint32>(date.year() * 10000 + date.month() * 100 + date.day())
+        : 0;
 }
 
-void add_non_empty_array(QJsonObject& obj, const QString& key, const QJsonArray& values)
+QDate date_from_record(quint32 value)
 {
-    if (!values.isEmpty())
-        obj[key] = values;
+    return value
+        ? QDate(static_cast<int>(value / 10000), static_cast<int>(value / 100 % 100), static_cast<int>(value % 100))
+        : QDate();
 }
 
-QStringList json_to_string_list(const QJsonValue& value)
+
+class IndexWriter {
+public:
+    // NOTE: without the search context, no origin info is stored
+    explicit IndexWriter(const providers::SearchContext* origins = nullptr);
+
+    void add_collection(const model::Collection&);
+    void add_game(const model::Game&);
+    void add_scope(const QString&, const std::vector<MetafileStamp>&);
+    QByteArray serialize(const QString& fingerprint) const;
+
+private:
+    const providers::SearchContext* const m_origins;
+
+    HashMap<QString, quint32> m_string_ids;
+    std::vector<StringRecord> m_strings;
+    QString m_chars;
+
+    HashMap<const model::Collection*, quint32> m_collection_ids;
+    std::vector<CollectionRecord> m_collections;
+    std::vector<GameRecord> m_games;
+    std::vector<FileRecord> m_files;
+    std::vector<AssetRecord> m_assets;
+    std::vector<ScopeRecord> m_scopes;
+    std::vector<MetafileRecord> m_metafiles;
+    std::vector<quint32> m_ids;
+
+    quint32 string_id(const QString&);
+    IndexRange string_list(const QStringList&);
+    IndexRange asset_list(const model::Assets&);
+};
+
+IndexWriter::IndexWriter(const providers::SearchContext* origins)
+    : m_origins(origins)
 {
-    QStringList out;
-    const QJsonArray array = value.toArray();
-    out.reserve(array.size());
-    for (const QJsonValue& item : array)
-        out.append(item.toString());
+    m_strings.push_back({ 0, 0 });
+}
+
+quint32 IndexWriter::string_id(const QString& str)
+{
+    if (str.isEmpty())
+        return 0;
+
+    const auto it = m_string_ids.find(str);
+    if (it != m_string_ids.cend())
+        return it->second;
+
+    const auto id = static_cast<quint32>(m_strings.size());
+    m_strings.push_back({ static_cast<quint32>(m_chars.size()), static_cast<quint32>(str.size()) });
+    m_chars.append(str);
+    m_string_ids.emplace(str, id);
+    return id;
+}
+
+IndexRange IndexWriter::string_list(const QStringList& list)
+{
+    const IndexRange range { static_cast<quint32>(m_ids.size()), static_cast<quint32>(list.size()) };
+    for (const QString& str : list)
+        m_ids.push_back(string_id(str));
+    return range;
+}
+
+IndexRange IndexWriter::asset_list(const model::Assets& assets)
+{
+    const auto first = static_cast<quint32>(m_assets.size());
+    for (int type = static_cast<int>(AssetType::BOX_FRONT); type <= static_cast<int>(AssetType::VIDEO); type++) {
+        for (const QString& uri : assets.get(static_cast<AssetType>(type)))
+            m_assets.push_back({ static_cast<quint32>(type), string_id(uri) });
+    }
+    return { first, static_cast<quint32>(m_assets.size()) - first };
+}
+
+void IndexWriter::add_collection(const model::Collection& collection)
+{
+    CollectionRecord rec {};
+    rec.name = string_id(collection.name());
+    rec.sort_by = string_id(collection.sortBy());
+    rec.short_name = string_id(collection.shortName());
+    rec.summary = string_id(collection.summary());
+    rec.description = string_id(collection.description());
+    rec.launch_cmd = string_id(collection.commonLaunchCmd());
+    rec.launch_workdir = string_id(collection.commonLaunchWorkdir());
+    rec.relative_basedir = string_id(collection.commonLaunchCmdBasedir());
+    rec.assets = asset_list(collection.assets());
+    if (m_origins)
+        rec.source_dir = string_id(m_origins->collection_source_dir(collection));
+
+    m_collection_ids.emplace(&collection, static_cast<quint32>(m_collections.size()));
+    m_collections.push_back(rec);
+}
+
+void IndexWriter::add_game(const model::Game& game)
+{
+    GameRecord rec {};
+    rec.title = string_id(game.title());
+    rec.sort_by = string_id(game.sortBy());
+    rec.summary = string_id(game.summary());
+    rec.description = string_id(game.description());
+    rec.launch_cmd = string_id(game.launchCmd());
+    rec.launch_workdir = string_id(game.launchWorkdir());
+    rec.relative_basedir = string_id(game.launchCmdBasedir());
+    rec.developers = string_list(game.developerListConst());
+    rec.publishers = string_list(game.publisherListConst());
+    rec.genres = string_list(game.genreListConst());
+    rec.tags = string_list(game.tagListConst());
+    rec.assets = asset_list(game.assets());
+    rec.release_date = date_to_record(game.releaseDate());
+    rec.rating = game.rating();
+    rec.player_count = static_cast<quint16>(qBound(1, game.playerCount(), 0xFFFF));
+    rec.missing = game.isMissing() ? 1 : 0;
+    if (m_origins && m_origins->game_is_shared(game))
+        rec.flags |= GAME_FLAG_SHARED;
+
+    rec.collections.first = static_cast<quint32>(m_ids.size());
+    for (const model::Collection* const collection : game.collectionsConst()) {
+        const auto it = m_collection_ids.find(collection);
+        if (it != m_collection_ids.cend())
+            m_ids.push_back(it->second);
+    }
+    rec.collections.count = static_cast<quint32>(m_ids.size()) - rec.collections.first;
+
+    rec.files.first = static_cast<quint32>(m_files.size());
+    for (const model::GameFile* const file : game.filesConst())
+        m_files.push_back({ string_id(file->path()), string_id(file->name()), string_id(file->uri()) });
+    rec.files.count = static_cast<quint32>(m_files.size()) - rec.files.first;
+
+    m_games.push_back(rec);
+}
+
+void IndexWriter::add_scope(const QString& dir_path, const std::vector<MetafileStamp>& stamps)
+{
+    ScopeRecord rec {};
+    rec.dir = string_id(dir_path);
+    rec.metafiles = { static_cast<quint32>(m_metafiles.size()), static_cast<quint32>(stamps.size()) };
+
+    for (const MetafileStamp& stamp : stamps)
+        m_metafiles.push_back({ string_id(stamp.path), 0, stamp.size, stamp.mtime });
+
+    m_scopes.push_back(rec);
+}
+
+template<typename T>
+IndexRange append_section(QByteArray& out, const std::vector<T>& items)
+{
+    while (out.size() % alignof(T) != 0)
+        out.append('\0');
+
+    const IndexRange range { static_cast<quint32>(out.size()), static_cast<quint32>(items.size()) };
+    out.append(reinterpret_cast<const char*>(items.data()), static_cast<int>(items.size() * sizeof(T)));
+    return range;
+}
+
+QByteArray IndexWriter::serialize(const QString& fingerprint) const
+{
+    Q_ASSERT(fingerprint.size() == FINGERPRINT_LEN);
+    const QByteArray fingerprint_raw = fingerprint.toLatin1().leftJustified(FINGERPRINT_LEN, '\0', true);
+
+    IndexHeader header {};
+    header.magic = INDEX_MAGIC;
+    header.version = CACHE_SCHEMA_VERSION;
+    std::memcpy(header.fingerprint, fingerprint_raw.constData(), FINGERPRINT_LEN);
+
+    QByteArray out(static_cast<int>(sizeof(IndexHeader)), '\0');
+    header.strings = append_section(out, m_strings);
+    header.collections = append_section(out, m_collections);
+    header.games = append_section(out, m_games);
+    header.files = append_section(out, m_files);
+    header.assets = append_section(out, m_assets);
+    header.scopes = append_section(out, m_scopes);
+    header.metafiles = append_section(out, m_metafiles);
+    header.ids = append_section(out, m_ids);
+
+    while (out.size() % alignof(QChar) != 0)
+        out.append('\0');
+    header.chars = { static_cast<quint32>(out.size()), static_cast<quint32>(m_chars.size()) };
+    out.append(reinterpret_cast<const char*>(m_chars.constData()), m_chars.size() * static_cast<int>(sizeof(QChar)));
+
+    std::memcpy(out.data(), &header, sizeof(IndexHeader));
     return out;
 }
 
-QJsonObject assets_to_json(const model::Assets& assets)
-{
-    QJsonObject obj;
-    add_non_empty_array(obj, QStringLiteral("box_front"), string_list_to_json(assets.boxFrontList()));
-    add_non_empty_array(obj, QStringLiteral("box_back"), string_list_to_json(assets.boxBackList()));
-    add_non_empty_array(obj, QStringLiteral("box_spine"), string_list_to_json(assets.boxSpineList()));
-    add_non_empty_array(obj, QStringLiteral("box_full"), string_list_to_json(assets.boxFullList()));
-    add_non_empty_array(obj, QStringLiteral("cartridge"), string_list_to_json(assets.cartridgeList()));
-    add_non_empty_array(obj, QStringLiteral("logo"), string_list_to_json(assets.logoList()));
-    add_non_empty_array(obj, QStringLiteral("poster"), string_list_to_json(assets.posterList()));
-    add_non_empty_array(obj, QStringLiteral("marquee"), string_list_to_json(assets.marqueeList()));
-    add_non_empty_array(obj, QStringLiteral("bezel"), string_list_to_json(assets.bezelList()));
-    add_non_empty_array(obj, QStringLiteral("panel"), string_list_to_json(assets.panelList()));
-    add_non_empty_array(obj, QStringLiteral("cabinet_left"), string_list_to_json(assets.cabinetLeftList()));
-    add_non_empty_array(obj, QStringLiteral("cabinet_right"), string_list_to_json(assets.cabinetRightList()));
-    add_non_empty_array(obj, QStringLiteral("tile"), string_list_to_json(assets.tileList()));
-    add_non_empty_array(obj, QStringLiteral("banner"), string_list_to_json(assets.bannerList()));
-    add_non_empty_array(obj, QStringLiteral("steam"), string_list_to_json(assets.steamList()));
-    add_non_empty_array(obj, QStringLiteral("background"), string_list_to_json(assets.backgroundList()));
-    add_non_empty_array(obj, QStringLiteral("music"), string_list_to_json(assets.musicList()));
-    add_non_empty_array(obj, QStringLiteral("screenshot"), string_list_to_json(assets.screenshotList()));
-    add_non_empty_array(obj, QStringLiteral("titlescreen"), string_list_to_json(assets.titlescreenList()));
-    add_non_empty_array(obj, QStringLiteral("video"), string_list_to_json(assets.videoList()));
-    return obj;
-}
-
-void add_asset_uris(model::Assets& assets, const QJsonObject& obj, const QString& key, const AssetType type)
-{
-    const QStringList values = json_to_string_list(obj.value(key));
-    for (const QString& value : values) {
-        if (!value.isEmpty())
-            assets.add_uri(type, value);
+
+class IndexReader {
+public:
+    explicit IndexReader(const uchar* const data, const qint64 size);
+
+    bool is_valid() const { return m_valid; }
+    QLatin1String fingerprint() const;
+
+    const IndexHeader& header() const { return m_header; }
+    const CollectionRecord* collections() const { return section<CollectionRecord>(m_header.collections); }
+    const GameRecord* games() const { return section<GameRecord>(m_header.games); }
+    const FileRecord* files() const { return section<FileRecord>(m_header.files); }
+    const AssetRecord* assets() const { return section<AssetRecord>(m_header.assets); }
+    const ScopeRecord* scopes() const { return section<ScopeRecord>(m_header.scopes); }
+    const MetafileRecord* metafiles() const { return section<MetafileRecord>(m_header.metafiles); }
+    const quint32* ids() const { return section<quint32>(m_header.ids); }
+
+    const QString& string(quint32 id);
+    void read_string_list(const IndexRange&, QStringList&);
+    void read_assets(const IndexRange&, model::Assets&);
+    std::vector<MetafileStamp> read_metafiles(const IndexRange&);
+
+private:
+    const uchar* const m_data;
+    const qint64 m_size;
+    IndexHeader m_header;
+    bool m_valid = false;
+
+    // NOTE: strings are only materialized once, repeated values share their data
+    std::vector<QString> m_strings;
+
+    template<typename T>
+    const T* section(const IndexRange& range) const {
+        return reinterpret_cast<const T*>(m_data + range.first);
+    }
+    template<typename T>
+    bool section_fits(const IndexRange& range, const size_t alignment = alignof(T)) const {
+        return range.first % alignment == 0
+            && static_cast<quint64>(range.first) + static_cast<quint64>(range.count) * sizeof(T) <= static_cast<quint64>(m_size);
+    }
+    bool range_fits(const IndexRange& range, quint32 limit) const {
+        return static_cast<quint64>(range.first) + range.count <= limit;
+    }
+    bool id_list_fits(const IndexRange&, quint32 limit) const;
+    bool validate() const;
+};
+
+IndexReader::IndexReader(const uchar* const data, const qint64 size)
+    : m_data(data)
+    , m_size(size)
+    , m_header()
+{
+    if (!m_data || m_size < static_cast<qint64>(sizeof(IndexHeader)))
+        return;
+
+    std::memcpy(&m_header, m_data, sizeof(IndexHeader));
+    m_valid = validate();
+    if (m_valid)
+        m_strings.resize(m_header.strings.count);
+}
+
+QLatin1String IndexReader::fingerprint() const
+{
+    return QLatin1String(m_header.fingerprint, FINGERPRINT_LEN);
+}
+
+bool IndexReader::id_list_fits(const IndexRange& range, quint32 limit) const
+{
+    if (!range_fits(range, m_header.ids.count))
+        return false;
+
+    const quint32* const list = ids();
+    for (quint32 i = range.first; i < range.first + range.count; i++) {
+        if (list[i] >= limit)
+            return false;
+    }
+    return true;
+}
+
+bool IndexReader::validate() const
+{
+    const bool header_ok = m_header.magic == INDEX_MAGIC
+        && m_header.version == CACHE_SCHEMA_VERSION
+        && section_fits<StringRecord>(m_header.strings)
+        && section_fits<CollectionRecord>(m_header.collections)
+        && section_fits<GameRecord>(m_header.games)
+        && section_fits<FileRecord>(m_header.files)
+        && section_fits<AssetRecord>(m_header.assets)
+        && section_fits<ScopeRecord>(m_header.scopes)
+        && section_fits<MetafileRecord>(m_header.metafiles)
+        && section_fits<quint32>(m_header.ids)
+        && section_fits<QChar>(m_header.chars)
+        && m_header.strings.count > 0;
+    if (!header_ok)
+        return false;
+
+    const quint32 string_cnt = m_header.strings.count;
+    const StringRecord* const strings = section<StringRecord>(m_header.strings);
+    for (quint32 i = 0; i < string_cnt; i++) {
+        if (!range_fits({ strings[i].offset, strings[i].length }, m_header.chars.count))
+            return false;
+    }
+
+    const AssetRecord* const asset_recs = assets();
+    for (quint32 i = 0; i < m_header.assets.count; i++) {
+        const bool valid_type = static_cast<int>(AssetType::BOX_FRONT) <= static_cast<int>(asset_recs[i].type)
+            && asset_recs[i].type <= static_cast<quint32>(AssetType::VIDEO);
+        if (!valid_type || asset_recs[i].uri >= string_cnt)
+            return false;
+    }
+
+    const FileRecord* const file_recs = files();
+    for (quint32 i = 0; i < m_header.files.count; i++) {
+        const FileRecord& rec = file_recs[i];
+        if (rec.path >= string_cnt || rec.name >= string_cnt || rec.uri >= string_cnt)
+            return false;
+    }
+
+    const MetafileRecord* const metafile_recs = metafiles();
+    for (quint32 i = 0; i < m_header.metafiles.count; i++) {
+        if (metafile_recs[i].path >= string_cnt)
+            return false;
+    }
+
+    const ScopeRecord* const scope_recs = scopes();
+    for (quint32 i = 0; i < m_header.scopes.count; i++) {
+        if (scope_recs[i].dir >= string_cnt || !range_fits(scope_recs[i].metafiles, m_header.metafiles.count))
+            return false;
+    }
+
+    const CollectionRecord* const coll_recs = collections();
+    for (quint32 i = 0; i < m_header.collections.count; i++) {
+        const CollectionRecord& rec = coll_recs[i];
+        const bool ok = rec.name < string_cnt
+            && rec.sort_by < string_cnt
+            && rec.short_name < string_cnt
+            && rec.summary < string_cnt
+            && rec.description < string_cnt
+            && rec.launch_cmd < string_cnt
+            && rec.launch_workdir < string_cnt
+            && rec.relative_basedir < string_cnt
+            && rec.source_dir < string_cnt
+            && range_fits(rec.assets, m_header.assets.count);
+        if (!ok)
+            return false;
+    }
+
+    const GameRecord* const game_recs = games();
+    for (quint32 i = 0; i < m_header.games.count; i++) {
+        const GameRecord& rec = game_recs[i];
+        const bool ok = rec.title < string_cnt
+            && rec.sort_by < string_cnt
+            && rec.summary < string_cnt
+            && rec.description < string_cnt
+            && rec.launch_cmd < string_cnt
+            && rec.launch_workdir < string_cnt
+            && rec.relative_basedir < string_cnt
+            && id_list_fits(rec.developers, string_cnt)
+            && id_list_fits(rec.publishers, string_cnt)
+            && id_list_fits(rec.genres, string_cnt)
+            && id_list_fits(rec.tags, string_cnt)
+            && id_list_fits(rec.collections, m_header.collections.count)
+            && range_fits(rec.files, m_header.files.count)
+            && range_fits(rec.assets, m_header.assets.count);
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
+
+const QString& IndexReader::string(quint32 id)
+{
+    QString& str = m_strings[id];
+    if (str.isNull() && id != 0) {
+        const StringRecord& rec = section<StringRecord>(m_header.strings)[id];
+        const QChar* const chars = section<QChar>(m_header.chars);
+        str = QString(chars + rec.offset, static_cast<int>(rec.length));
     }
+    return str;
+}
+
+void IndexReader::read_string_list(const IndexRange& range, QStringList& out)
+{
+    if (range.count == 0)
+        return;
+
+    const quint32* const list = ids();
+    out.reserve(out.size() + static_cast<int>(range.count));
+    for (quint32 i = range.first; i < range.first + range.count; i++)
+        out.append(string(list[i]));
+}
+
+void IndexReader::read_assets(const IndexRange& range, model::Assets& out)
+{
+    const AssetRecord* const list = assets();
+    for (quint32 i = range.first; i < range.first + range.count; i++)
+        out.add_uri(static_cast<AssetType>(list[i].type), string(list[i].uri));
 }
 
-void assets_from_json(model::Assets& assets, const QJsonValue& value)
-{
-    const QJsonObject obj = value.toObject();
-    add_asset_uris(assets, obj, QStringLiteral("box_front"), AssetType::BOX_FRONT);
-    add_asset_uris(assets, obj, QStringLiteral("box_back"), AssetType::BOX_BACK);
-    add_asset_uris(assets, obj, QStringLiteral("box_spine"), AssetType::BOX_SPINE);
-    add_asset_uris(assets, obj, QStringLiteral("box_full"), AssetType::BOX_FULL);
-    add_asset_uris(assets, obj, QStringLiteral("cartridge"), AssetType::CARTRIDGE);
-    add_asset_uris(assets, obj, QStringLiteral("logo"), AssetType::LOGO);
-    add_asset_uris(assets, obj, QStringLiteral("poster"), AssetType::POSTER);
-    add_asset_uris(assets, obj, QStringLiteral("marquee"), AssetType::ARCADE_MARQUEE);
-    add_asset_uris(assets, obj, QStringLiteral("bezel"), AssetType::ARCADE_BEZEL);
-    add_asset_uris(assets, obj, QStringLiteral("panel"), AssetType::ARCADE_PANEL);
-    add_asset_uris(assets, obj, QStringLiteral("cabinet_left"), AssetType::ARCADE_CABINET_L);
-    add_asset_uris(assets, obj, QStringLiteral("cabinet_right"), AssetType::ARCADE_CABINET_R);
-    add_asset_uris(assets, obj, QStringLiteral("tile"), AssetType::UI_TILE);
-    add_asset_uris(assets, obj, QStringLiteral("banner"), AssetType::UI_BANNER);
-    add_asset_uris(assets, obj, QStringLiteral("steam"), AssetType::UI_STEAMGRID);
-    add_asset_uris(assets, obj, QStringLiteral("background"), AssetType::BACKGROUND);
-    add_asset_uris(assets, obj, QStringLiteral("music"), AssetType::MUSIC);
-    add_asset_uris(assets, obj, QStringLiteral("screenshot"), AssetType::SCREENSHOT);
-    add_asset_uris(assets, obj, QStringLiteral("titlescreen"), AssetType::TITLESCREEN);
-    add_asset_uris(assets, obj, QStringLiteral("video"), AssetType::VIDEO);
+std::vector<MetafileStamp> IndexReader::read_metafiles(const IndexRange& range)
+{
+    std::vector<MetafileStamp> out;
+    out.reserve(range.count);
+
+    const MetafileRecord* const list = metafiles();
+    for (quint32 i = range.first; i < range.first + range.count; i++)
+        out.push_back({ string(list[i].path), list[i].size, list[i].mtime });
+    return out;
+}
+
+
+QJsonArray string_list_to_json(const QStringList& values)
+{
+    QJsonArray out;
+    for (const QString& value : values)
+        out.append(value);
+    return out;
 }
 
 void add_file_fingerprint(QJsonArray& out, const QString& path)
@@ -163,70 +642,181 @@ void add_metadata_fingerprints(QJsonArray& out, const QString& dir_path)
         add_file_fingerprint(out, it.next());
 }
 
-QJsonObject collection_to_json(const model::Collection& collection)
-{
-    QJsonObject obj;
-    obj[QStringLiteral("name")] = collection.name();
-    obj[QStringLiteral("sort_by")] = collection.sortBy();
-    obj[QStringLiteral("short_name")] = collection.shortName();
-    obj[QStringLiteral("summary")] = collection.summary();
-    obj[QStringLiteral("description")] = collection.description();
-    obj[QStringLiteral("common_launch_cmd")] = collection.commonLaunchCmd();
-    obj[QStringLiteral("common_launch_workdir")] = collection.commonLaunchWorkdir();
-    obj[QStringLiteral("common_relative_basedir")] = collection.commonLaunchCmdBasedir();
-    obj[QStringLiteral("assets")] = assets_to_json(collection.assets());
-    return obj;
-}
-
-QJsonObject game_to_json(const model::Game& game)
-{
-    QJsonObject obj;
-    obj[QStringLiteral("title")] = game.title();
-    obj[QStringLiteral("sort_by")] = game.sortBy();
-    obj[QStringLiteral("summary")] = game.summary();
-    obj[QStringLiteral("description")] = game.description();
-    add_non_empty_array(obj, QStringLiteral("developers"), string_list_to_json(game.developerListConst()));
-    add_non_empty_array(obj, QStringLiteral("publishers"), string_list_to_json(game.publisherListConst()));
-    add_non_empty_array(obj, QStringLiteral("genres"), string_list_to_json(game.genreListConst()));
-    add_non_empty_array(obj, QStringLiteral("tags"), string_list_to_json(game.tagListConst()));
-    obj[QStringLiteral("player_count")] = game.playerCount();
-    obj[QStringLiteral("rating")] = game.rating();
-    obj[QStringLiteral("release_date")] = game.releaseDate().toString(Qt::ISODate);
-    obj[QStringLiteral("missing")] = game.isMissing();
-    obj[QStringLiteral("launch_cmd")] = game.launchCmd();
-    obj[QStringLiteral("launch_workdir")] = game.launchWorkdir();
-    obj[QStringLiteral("relative_basedir")] = game.launchCmdBasedir();
-    obj[QStringLiteral("assets")] = assets_to_json(game.assets());
-
-    QJsonArray collection_names;
-    if (game.collectionsModel()) {
-        for (const model::Collection* const collection : game.collectionsModel()->entries()) {
-            if (collection)
-                collection_names.append(collection->name());
+
+bool is_usable_index(const IndexReader& reader, const QString& expected_fingerprint)
+{
+    if (!reader.is_valid()) {
+        Log::info(LOGMSG("Ignoring game index cache: invalid or outdated file"));
+        return false;
+    }
+    if (reader.fingerprint() != expected_fingerprint) {
+        Log::info(LOGMSG("Ignoring game index cache: fingerprint mismatch"));
+        return false;
+    }
+    return true;
+}
+
+// Restores the index, except the collections defined by the skipped dirs and their games.
+// The rescanned results of those dirs get merged in later, so the rest of the library
+// must not overlap with them; this is verified before anything gets created.
+bool restore_index(
+    IndexReader& reader,
+    providers::SearchContext& sctx,
+    const QStringList& skipped_dirs,
+    const providers::SearchContext* const rescanned)
+{
+    const IndexHeader& header = reader.header();
+    const quint32* const ids = reader.ids();
+    const CollectionRecord* const coll_recs = reader.collections();
+    const GameRecord* const game_recs = reader.games();
+    const FileRecord* const file_recs = reader.files();
+
+    std::vector<bool> skipped_collections(header.collections.count, false);
+    for (quint32 i = 0; i < header.collections.count; i++) {
+        const CollectionRecord& rec = coll_recs[i];
+        skipped_collections[i] = rec.source_dir && skipped_dirs.contains(reader.string(rec.source_dir));
+
+        const QString& name = reader.string(rec.name);
+        if (!skipped_collections[i] && rescanned && rescanned->current_collection_map().count(name)) {
+            Log::info(LOGMSG("Cannot update the game index cache partially: collection `%1` was also found in the changed directories")
+                .arg(name));
+            return false;
         }
     }
-    add_non_empty_array(obj, QStringLiteral("collections"), collection_names);
-
-    QJsonArray files;
-    if (game.filesModel()) {
-        for (const model::GameFile* const file : game.filesModel()->entries()) {
-            if (!file)
-                continue;
-
-            QJsonObject file_obj;
-            file_obj[QStringLiteral("path")] = file->path();
-            file_obj[QStringLiteral("name")] = file->name();
-            file_obj[QStringLiteral("uri")] = file->uri();
-            files.append(file_obj);
+
+    std::vector<bool> skipped_games(header.games.count, false);
+    for (quint32 i = 0; i < header.games.count; i++) {
+        const GameRecord& rec = game_recs[i];
+
+        bool in_skipped = false;
+        bool in_kept = false;
+        for (quint32 k = rec.collections.first; k < rec.collections.first + rec.collections.count; k++) {
+            if (skipped_collections[ids[k]])
+                in_skipped = true;
+            else
+                in_kept = true;
+        }
+
+        if (in_skipped) {
+            if (in_kept || (rec.flags & GAME_FLAG_SHARED)) {
+                Log::info(LOGMSG("Cannot update the game index cache partially: game `%1` is not limited to the changed directories")
+                    .arg(reader.string(rec.title)));
+                return false;
+            }
+            skipped_games[i] = true;
+            continue;
+        }
+
+        if (!rescanned)
+            continue;
+
+        for (quint32 k = rec.files.first; k < rec.files.first + rec.files.count; k++) {
+            const FileRecord& file_rec = file_recs[k];
+            const bool also_rescanned = rescanned->current_filepath_to_entry_map().count(reader.string(file_rec.path))
+                || (file_rec.uri && rescanned->current_uri_to_entry_map().count(reader.string(file_rec.uri)));
+            if (also_rescanned) {
+                Log::info(LOGMSG("Cannot update the game index cache partially: game `%1` was also found in the changed directories")
+                    .arg(reader.string(rec.title)));
+                return false;
+            }
+        }
+    }
+
+
+    std::vector<model::Collection*> collections(header.collections.count, nullptr);
+    for (quint32 i = 0; i < header.collections.count; i++) {
+        const CollectionRecord& rec = coll_recs[i];
+        const QString& name = reader.string(rec.name);
+        if (skipped_collections[i] || name.isEmpty())
+            continue;
+
+        model::Collection& collection = *sctx.get_or_create_collection(name);
+        collection
+            .setSortBy(reader.string(rec.sort_by))
+            .setSummary(reader.string(rec.summary))
+            .setDescription(reader.string(rec.description))
+            .setCommonLaunchCmd(reader.string(rec.launch_cmd))
+            .setCommonLaunchWorkdir(reader.string(rec.launch_workdir))
+            .setCommonLaunchCmdBasedir(reader.string(rec.relative_basedir));
+        if (rec.short_name)
+            collection.setShortName(reader.string(rec.short_name));
+        reader.read_assets(rec.assets, collection.assetsMut());
+
+        if (rec.source_dir)
+            sctx.collection_add_source_dir(collection, reader.string(rec.source_dir));
+
+        collections[i] = &collection;
+    }
+
+    for (quint32 i = 0; i < header.games.count; i++) {
+        const GameRecord& rec = game_recs[i];
+        const QString& title = reader.string(rec.title);
+        if (skipped_games[i] || title.isEmpty())
+            continue;
+
+        model::Game& game = *sctx.create_game();
+        game.setTitle(title)
+            .setSortBy(reader.string(rec.sort_by))
+            .setSummary(reader.string(rec.summary))
+            .setDescription(reader.string(rec.description))
+            .setReleaseDate(date_from_record(rec.release_date))
+            .setLaunchCmd(reader.string(rec.launch_cmd))
+            .setLaunchWorkdir(reader.string(rec.launch_workdir))
+            .setLaunchCmdBasedir(reader.string(rec.relative_basedir));
+        game.setPlayerCount(rec.player_count)
+            .setRating(rec.rating)
+            .setMissing(rec.missing != 0);
+        reader.read_string_list(rec.developers, game.developerList());
+        reader.read_string_list(rec.publishers, game.publisherList());
+        reader.read_string_list(rec.genres, game.genreList());
+        reader.read_string_list(rec.tags, game.tagList());
+        reader.read_assets(rec.assets, game.assetsMut());
+
+        if (rec.flags & GAME_FLAG_SHARED)
+            sctx.game_mark_shared(game);
+
+        for (quint32 k = rec.collections.first; k < rec.collections.first + rec.collections.count; k++) {
+            model::Collection* const collection = collections[ids[k]];
+            if (collection)
+                sctx.game_add_to(game, *collection);
+        }
+
+        for (quint32 k = rec.files.first; k < rec.files.first + rec.files.count; k++) {
+            const FileRecord& file_rec = file_recs[k];
+            model::GameFile* const game_file = file_rec.uri
+                ? sctx.game_add_uri(game, reader.string(file_rec.uri))
+                : sctx.game_add_filepath(game, reader.string(file_rec.path));
+            game_file->setName(reader.string(file_rec.name));
         }
     }
-    add_non_empty_array(obj, QStringLiteral("files"), files);
 
-    return obj;
+    return true;
+}
+
+bool write_index_file(const QString& path, const QByteArray& contents)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        Log::warning(LOGMSG("Could not open game index cache for writing"));
+        return false;
+    }
+
+    file.write(contents);
+    if (!file.commit()) {
+        Log::warning(LOGMSG("Could not write game index cache"));
+        return false;
+    }
+
+    return true;
 }
 } // namespace
 
 QString GameDataCache::cacheFilePath()
+{
+    return QDir(paths::writableCacheDir()).absoluteFilePath(QStringLiteral("gameindex-v2.bin"));
+}
+
+QString GameDataCache::legacyCacheFilePath()
 {
     return QDir(paths::writableCacheDir()).absoluteFilePath(QStringLiteral("gameindex-v1.json"));
 }
@@ -250,11 +840,11 @@ QString GameDataCache::buildFingerprint(
     // providers run. PegasusProvider may populate pegasus_game_dirs() during
     // scanning, so including it here would make load-time and save-time
     // fingerprints differ and cause permanent cache misses.
+    // The metafiles of the root game dirs are tracked separately, per directory.
     QJsonArray metadata_files;
     for (const QString& dir : paths::configDirs())
         add_metadata_fingerprints(metadata_files, dir);
-    for (const QString& dir : sctx.root_game_dirs())
-        add_metadata_fingerprints(metadata_files, dir);
+    add_metadata_fingerprints(metadata_files, paths::writableConfigDir() + QLatin1String("/metafiles"));
     root[QStringLiteral("metadata_files")] = metadata_files;
 
     const QJsonDocument doc(root);
@@ -262,134 +852,113 @@ QString GameDataCache::buildFingerprint(
     return QString::fromLatin1(hash);
 }
 
-bool GameDataCache::load(
-    providers::SearchContext& sctx,
-    const std::vector<providers::Provider*>& providers)
+bool GameDataCache::findChangedDirs(
+    const providers::SearchContext& sctx,
+    const std::vector<providers::Provider*>& providers,
+    QStringList& changed_dirs)
 {
-    const QString expected_fingerprint = buildFingerprint(sctx, providers);
     QFile file(cacheFilePath());
     if (!file.open(QIODevice::ReadOnly))
         return false;
 
-    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    const QJsonObject root = doc.object();
-    if (root.value(QStringLiteral("schema")).toInt() != CACHE_SCHEMA_VERSION)
-        return false;
-    if (root.value(QStringLiteral("fingerprint")).toString() != expected_fingerprint){
-        Log::info(LOGMSG("Ignoring game index cache: fingerprint mismatch"));
+    const qint64 file_size = file.size();
+    IndexReader reader(file.map(0, file_size), file_size);
+    if (!is_usable_index(reader, buildFingerprint(sctx, providers)))
         return false;
-    }
-
-    const QJsonArray collections = root.value(QStringLiteral("collections")).toArray();
-    for (const QJsonValue& value : collections) {
-        const QJsonObject obj = value.toObject();
-        const QString name = obj.value(QStringLiteral("name")).toString();
-        if (name.isEmpty())
-            continue;
 
-        model::Collection* collection = sctx.get_or_create_collection(name);
-        collection->setSortBy(obj.value(QStringLiteral("sort_by")).toString());
-        collection->setShortName(obj.value(QStringLiteral("short_name")).toString());
-        collection->setSummary(obj.value(QStringLiteral("summary")).toString());
-        collection->setDescription(obj.value(QStringLiteral("description")).toString());
-        collection->setCommonLaunchCmd(obj.value(QStringLiteral("common_launch_cmd")).toString());
-        collection->setCommonLaunchWorkdir(obj.value(QStringLiteral("common_launch_workdir")).toString());
-        collection->setCommonLaunchCmdBasedir(obj.value(QStringLiteral("common_relative_basedir")).toString());
-        assets_from_json(collection->assetsMut(), obj.value(QStringLiteral("assets")));
+    HashMap<QString, std::vector<MetafileStamp>> stored_stamps;
+    const ScopeRecord* const scope_recs = reader.scopes();
+    for (quint32 i = 0; i < reader.header().scopes.count; i++)
+        stored_stamps.emplace(reader.string(scope_recs[i].dir), reader.read_metafiles(scope_recs[i].metafiles));
+
+    changed_dirs.clear();
+    for (const QString& dir_path : sctx.root_game_dirs()) {
+        const auto it = stored_stamps.find(dir_path);
+        if (it == stored_stamps.cend() || it->second != find_metafile_stamps(dir_path)) {
+            Log::info(LOGMSG("Metadata files have changed in `%1`").arg(::pretty_path(dir_path)));
+            changed_dirs.append(dir_path);
+        }
     }
 
-    const QJsonArray games = root.value(QStringLiteral("games")).toArray();
-    for (const QJsonValue& value : games) {
-        const QJsonObject obj = value.toObject();
-        const QString title = obj.value(QStringLiteral("title")).toString();
-        if (title.isEmpty())
-            continue;
+    return true;
+}
 
-        model::Game* game = sctx.create_game();
-        game->setTitle(title);
-        game->setSortBy(obj.value(QStringLiteral("sort_by")).toString());
-        game->setSummary(obj.value(QStringLiteral("summary")).toString());
-        game->setDescription(obj.value(QStringLiteral("description")).toString());
-        game->developerList().append(json_to_string_list(obj.value(QStringLiteral("developers"))));
-        game->publisherList().append(json_to_string_list(obj.value(QStringLiteral("publishers"))));
-        game->genreList().append(json_to_string_list(obj.value(QStringLiteral("genres"))));
-        game->tagList().append(json_to_string_list(obj.value(QStringLiteral("tags"))));
-        game->setPlayerCount(obj.value(QStringLiteral("player_count")).toInt(1));
-        game->setRating(static_cast<float>(obj.value(QStringLiteral("rating")).toDouble(0.0)));
-        game->setReleaseDate(QDate::fromString(obj.value(QStringLiteral("release_date")).toString(), Qt::ISODate));
-        game->setMissing(obj.value(QStringLiteral("missing")).toBool(false));
-        game->setLaunchCmd(obj.value(QStringLiteral("launch_cmd")).toString());
-        game->setLaunchWorkdir(obj.value(QStringLiteral("launch_workdir")).toString());
-        game->setLaunchCmdBasedir(obj.value(QStringLiteral("relative_basedir")).toString());
-        assets_from_json(game->assetsMut(), obj.value(QStringLiteral("assets")));
-
-        const QStringList collection_names = json_to_string_list(obj.value(QStringLiteral("collections")));
-        for (const QString& collection_name : collection_names) {
-            if (collection_name.isEmpty())
-                continue;
-            model::Collection* collection = sctx.get_or_create_collection(collection_name);
-            sctx.game_add_to(*game, *collection);
-        }
+bool GameDataCache::load(
+    providers::SearchContext& sctx,
+    const std::vector<providers::Provider*>& providers,
+    const QStringList& changed_dirs,
+    const providers::SearchContext* const rescanned)
+{
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
 
-        const QJsonArray files = obj.value(QStringLiteral("files")).toArray();
-        for (const QJsonValue& file_value : files) {
-            const QJsonObject file_obj = file_value.toObject();
-            const QString uri = file_obj.value(QStringLiteral("uri")).toString();
-            const QString path = file_obj.value(QStringLiteral("path")).toString();
-            model::GameFile* game_file = nullptr;
-            if (!path.isEmpty())
-                game_file = sctx.game_add_filepath(*game, path);
-            else if (!uri.isEmpty())
-                game_file = sctx.game_add_uri(*game, uri);
-
-            if (game_file)
-                game_file->setName(file_obj.value(QStringLiteral("name")).toString());
-        }
-    }
+    // NOTE: the mapping is released when the file gets closed
+    const qint64 file_size = file.size();
+    IndexReader reader(file.map(0, file_size), file_size);
+    if (!is_usable_index(reader, buildFingerprint(sctx, providers)))
+        return false;
+    if (!restore_index(reader, sctx, changed_dirs, rescanned))
+        return false;
 
     Log::info(LOGMSG("Loaded game index cache"));
     return true;
 }
 
+bool GameDataCache::readIndex(
+    const QString& path,
+    const QString& expected_fingerprint,
+    providers::SearchContext& sctx)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 file_size = file.size();
+    IndexReader reader(file.map(0, file_size), file_size);
+    return is_usable_index(reader, expected_fingerprint)
+        && restore_index(reader, sctx, {}, nullptr);
+}
+
 void GameDataCache::save(
     const providers::SearchContext& sctx,
     const std::vector<providers::Provider*>& providers,
     const std::vector<model::Collection*>& collections,
     const std::vector<model::Game*>& games)
 {
-    QJsonObject root;
-    root[QStringLiteral("schema")] = CACHE_SCHEMA_VERSION;
-    root[QStringLiteral("fingerprint")] = buildFingerprint(sctx, providers);
-
-    QJsonArray collection_array;
-    for (const model::Collection* collection : collections) {
-        if (collection)
-            collection_array.append(collection_to_json(*collection));
-    }
-    add_non_empty_array(root, QStringLiteral("collections"), collection_array);
-
-    QJsonArray game_array;
-    for (const model::Game* game : games) {
-        if (game)
-            game_array.append(game_to_json(*game));
-    }
-    add_non_empty_array(root, QStringLiteral("games"), game_array);
+    IndexWriter writer(&sctx);
+    for (const QString& dir_path : sctx.root_game_dirs())
+        writer.add_scope(dir_path, find_metafile_stamps(dir_path));
+    for (const model::Collection* const collection : collections)
+        writer.add_collection(*collection);
+    for (const model::Game* const game : games)
+        writer.add_game(*game);
 
     QDir().mkpath(paths::writableCacheDir());
-    QSaveFile file(cacheFilePath());
-    if (!file.open(QIODevice::WriteOnly)) {
-        Log::warning(LOGMSG("Could not open game index cache for writing"));
+    if (!write_index_file(cacheFilePath(), writer.serialize(buildFingerprint(sctx, providers))))
         return;
-    }
 
-    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
-    if (!file.commit())
-        Log::warning(LOGMSG("Could not write game index cache"));
-    else
-        Log::info(LOGMSG("Saved game index cache"));
+    QFile::remove(legacyCacheFilePath());
+    Log::info(LOGMSG("Saved game index cache"));
+}
+
+bool GameDataCache::writeIndex(
+    const QString& path,
+    const QString& fingerprint,
+    const std::vector<model::Collection*>& collections,
+    const std::vector<model::Game*>& games)
+{
+    IndexWriter writer;
+    for (const model::Collection* const collection : collections)
+        writer.add_collection(*collection);
+    for (const model::Game* const game : games)
+        writer.add_game(*game);
+
+    return write_index_file(path, writer.serialize(fingerprint));
 }
 
 void GameDataCache::clear()
 {
     QFile::remove(cacheFilePath());
+    QFile::remove(legacyCacheFilePath());
 }
@@ -33,9 +33,21 @@ class SearchContext;
 
 class GameDataCache {
 public:
+    /// Checks whether the cache can be used, and lists the root game dirs
+    /// whose metafiles have changed since the cache was written
+    static bool findChangedDirs(
+        const providers::SearchContext&,
+        const std::vector<providers::Provider*>&,
+        QStringList& changed_dirs);
+
+    /// Restores the cached library, except the parts that came from the changed dirs.
+    /// Fails without touching the context if the results of rescanning those dirs
+    /// (if available) can't be spliced into the rest of the library.
     static bool load(
         providers::SearchContext&,
-        const std::vector<providers::Provider*>&);
+        const std::vector<providers::Provider*>&,
+        const QStringList& changed_dirs,
+        const providers::SearchContext* rescanned);
 
     static void save(
         const providers::SearchContext&,
@@ -45,9 +57,21 @@ public:
 
     static void clear();
 
+    // The index file itself, without any knowledge of the scanning environment
+    static bool readIndex(
+        const QString& path,
+        const QString& fingerprint,
+        providers::SearchContext&);
+    static bool writeIndex(
+        const QString& path,
+        const QString& fingerprint,
+        const std::vector<model::Collection*>&,
+        const std::vector<model::Game*>&);
+
 private:
     static QString cacheFilePath();
+    static QString legacyCacheFilePath();
     static QString buildFingerprint(
         const providers::SearchContext&,
         const std::vector<providers::Provider*>&);
-};
\ No newline at end of file
+};
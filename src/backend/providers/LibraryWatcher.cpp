@@ -0,0 +1,179 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "LibraryWatcher.h"
+
+#include "Log.h"
+
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QtConcurrent/QtConcurrent>
+
+
+namespace {
+// Copying a game usually comes with a burst of changes, these are handled together
+constexpr int BATCH_DELAY_MS = 1500;
+// Every watched path uses a kernel resource (eg. an inotify watch)
+constexpr size_t MAX_WATCHED_PATHS = 8192;
+
+QStringList find_metafiles_in(const QString& dir_path)
+{
+    const QStringList name_filters {
+        QStringLiteral("metadata.pegasus.txt"),
+        QStringLiteral("metadata.txt"),
+        QStringLiteral("*.metadata.pegasus.txt"),
+        QStringLiteral("*.metadata.txt"),
+    };
+
+    QStringList result;
+    QDirIterator dir_it(dir_path, name_filters, QDir::Files | QDir::NoDotAndDotDot);
+    while (dir_it.hasNext())
+        result.append(dir_it.next());
+
+    return result;
+}
+
+bool add_path(LibraryWatcher::WatchList& list, const QString& path, const QString& root_dir)
+{
+    const auto it = list.path_roots.find(path);
+    if (it != list.path_roots.end()) {
+        if (!it->second.contains(root_dir))
+            it->second.append(root_dir);
+        return true;
+    }
+
+    if (list.path_roots.size() >= MAX_WATCHED_PATHS)
+        return false;
+
+    list.path_roots.emplace(path, QStringList(root_dir));
+    list.paths.append(path);
+    return true;
+}
+
+LibraryWatcher::WatchList find_watched_paths(const HashMap<QString, QStringList>& root_game_dirs)
+{
+    LibraryWatcher::WatchList list;
+    bool& limit_reached = list.limit_reached;
+
+    for (const auto& pair : root_game_dirs) {
+        const QString& root_dir = pair.first;
+
+        // New or removed metafiles change the root dir, edits only the files
+        limit_reached |= !add_path(list, root_dir, root_dir);
+        for (const QString& metafile : find_metafiles_in(root_dir))
+            limit_reached |= !add_path(list, metafile, root_dir);
+
+        for (const QString& game_dir : pair.second) {
+            if (!QFileInfo::exists(game_dir))
+                continue;
+
+            limit_reached |= !add_path(list, game_dir, root_dir);
+
+            QDirIterator dir_it(game_dir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+            while (dir_it.hasNext() && !limit_reached)
+                limit_reached |= !add_path(list, dir_it.next(), root_dir);
+        }
+    }
+
+    return list;
+}
+} // namespace
+
+
+LibraryWatcher::LibraryWatcher(QObject* parent)
+    : QObject(parent)
+    , m_watcher(new QFileSystemWatcher(this))
+{
+    m_batch_timer.setSingleShot(true);
+    m_batch_timer.setInterval(BATCH_DELAY_MS);
+
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &LibraryWatcher::onPathChanged);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged,
+            this, &LibraryWatcher::onPathChanged);
+    connect(&m_batch_timer, &QTimer::timeout,
+            this, &LibraryWatcher::onBatchTimeout);
+    connect(&m_walk_watcher, &QFutureWatcher<WatchList>::finished,
+            this, &LibraryWatcher::onWalkFinished);
+}
+
+void LibraryWatcher::watch(const HashMap<QString, QStringList>& root_game_dirs)
+{
+    stop();
+
+    // Walking large libraries can take a while, so it happens in the background;
+    // the result of a walk is dropped if `stop` was called meanwhile
+    m_walk_pending = true;
+    m_walk_watcher.setFuture(QtConcurrent::run(find_watched_paths, root_game_dirs));
+}
+
+void LibraryWatcher::onWalkFinished()
+{
+    if (!m_walk_pending)
+        return;
+
+    m_walk_pending = false;
+    WatchList list = m_walk_watcher.result();
+
+    if (list.limit_reached) {
+        Log::warning(LOGMSG("Too many game directories to watch, only the first %1 are checked for changes")
+            .arg(QString::number(MAX_WATCHED_PATHS)));
+    }
+
+    m_path_roots = std::move(list.path_roots);
+    if (!list.paths.isEmpty())
+        m_watcher->addPaths(list.paths);
+
+    Log::info(LOGMSG("Watching %1 files and directories of the game library for changes")
+        .arg(QString::number(list.paths.size())));
+}
+
+void LibraryWatcher::stop()
+{
+    m_walk_pending = false;
+    m_batch_timer.stop();
+    m_changed_roots.clear();
+    m_path_roots.clear();
+
+    const QStringList watched_paths = m_watcher->files() + m_watcher->directories();
+    if (!watched_paths.isEmpty())
+        m_watcher->removePaths(watched_paths);
+}
+
+void LibraryWatcher::onPathChanged(const QString& path)
+{
+    const auto it = m_path_roots.find(path);
+    if (it == m_path_roots.cend())
+        return;
+
+    for (const QString& root_dir : it->second) {
+        if (!m_changed_roots.contains(root_dir))
+            m_changed_roots.append(root_dir);
+    }
+
+    m_batch_timer.start();
+}
+
+void LibraryWatcher::onBatchTimeout()
+{
+    QStringList changed_roots;
+    std::swap(changed_roots, m_changed_roots);
+
+    if (!changed_roots.isEmpty())
+        emit rootDirsChanged(changed_roots);
+}
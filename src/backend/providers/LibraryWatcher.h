@@ -0,0 +1,66 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "utils/HashMap.h"
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+class QFileSystemWatcher;
+
+
+/// Watches the metafiles and game directories of the root game dirs,
+/// and reports the root dirs affected by the changes in batches
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LibraryWatcher(QObject* parent = nullptr);
+
+    /// Takes the game directories used by each root game dir. The directories
+    /// are walked in the background, the watching starts when that's done.
+    void watch(const HashMap<QString, QStringList>&);
+    void stop();
+
+signals:
+    void rootDirsChanged(QStringList);
+
+private slots:
+    void onPathChanged(const QString&);
+    void onBatchTimeout();
+    void onWalkFinished();
+
+public:
+    struct WatchList {
+        HashMap<QString, QStringList> path_roots; // path -> root dirs
+        QStringList paths;
+        bool limit_reached = false;
+    };
+
+private:
+    QFileSystemWatcher* const m_watcher;
+    QTimer m_batch_timer;
+    QFutureWatcher<WatchList> m_walk_watcher;
+    bool m_walk_pending = false;
+
+    HashMap<QString, QStringList> m_path_roots;
+    QStringList m_changed_roots;
+};
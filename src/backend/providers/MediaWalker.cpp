@@ -0,0 +1,159 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "MediaWalker.h"
+
+#include <QDir>
+#include <QStringBuilder>
+
+#include <QDirIterator>
+
+#ifdef Q_OS_UNIX
+#include <QFile>
+#include <dirent.h>
+#include <fcntl.h>
+#include <set>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+#ifdef Q_OS_UNIX
+using DirId = std::pair<dev_t, ino_t>;
+
+// Takes the ownership of the descriptor
+void walk_dir_fd(
+    const int dir_fd,
+    const QString& dir_path,
+    const int rel_offset,
+    std::set<DirId>& visited_dirs,
+    std::vector<providers::MediaFile>& out)
+{
+    // symlinks may form loops
+    struct stat dir_stat;
+    if (::fstat(dir_fd, &dir_stat) != 0 || !visited_dirs.emplace(dir_stat.st_dev, dir_stat.st_ino).second) {
+        ::close(dir_fd);
+        return;
+    }
+
+    DIR* const dir = ::fdopendir(dir_fd);
+    if (!dir) {
+        ::close(dir_fd);
+        return;
+    }
+
+    while (const struct dirent* const entry = ::readdir(dir)) {
+        if (entry->d_name[0] == '.') // also skips '.' and '..'
+            continue;
+
+        unsigned char entry_type = entry->d_type;
+        if (entry_type == DT_LNK || entry_type == DT_UNKNOWN) {
+            struct stat entry_stat;
+            if (::fstatat(::dirfd(dir), entry->d_name, &entry_stat, 0) != 0)
+                continue;
+
+            entry_type = S_ISDIR(entry_stat.st_mode) ? DT_DIR
+                : S_ISREG(entry_stat.st_mode) ? DT_REG
+                : DT_UNKNOWN;
+        }
+
+        switch (entry_type) {
+            case DT_REG:
+                out.emplace_back(dir_path % QLatin1Char('/') % QFile::decodeName(entry->d_name), rel_offset);
+                break;
+            case DT_DIR: {
+                const int subdir_fd = ::openat(::dirfd(dir), entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (subdir_fd >= 0) {
+                    const QString subdir_path = dir_path % QLatin1Char('/') % QFile::decodeName(entry->d_name);
+                    walk_dir_fd(subdir_fd, subdir_path, rel_offset, visited_dirs, out);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    ::closedir(dir);
+}
+#endif // Q_OS_UNIX
+} // namespace
+
+
+namespace providers {
+
+MediaFile::MediaFile(QString file_path, int root_len)
+    : path(std::move(file_path))
+    , rel_offset(root_len + 1)
+    , name_offset(path.lastIndexOf(QLatin1Char('/')) + 1)
+    , dot_offset(path.lastIndexOf(QLatin1Char('.')))
+{
+    if (dot_offset < name_offset)
+        dot_offset = -1;
+}
+
+QStringRef MediaFile::rel_dir() const
+{
+    return name_offset > rel_offset
+        ? path.midRef(rel_offset, name_offset - rel_offset - 1)
+        : QStringRef();
+}
+
+QStringRef MediaFile::complete_basename() const
+{
+    const int end = dot_offset < 0 ? path.length() : dot_offset;
+    return path.midRef(name_offset, end - name_offset);
+}
+
+QStringRef MediaFile::suffix() const
+{
+    return dot_offset < 0
+        ? QStringRef()
+        : path.midRef(dot_offset + 1);
+}
+
+
+std::vector<MediaFile> walk_media_dir(const QString& dir_path)
+{
+    const QString root = QDir::cleanPath(dir_path);
+    std::vector<MediaFile> out;
+
+#ifdef Q_OS_UNIX
+    // Qt resource paths are only known by Qt
+    const bool is_qt_resource = root.startsWith(QLatin1Char(':'));
+    if (!is_qt_resource) {
+        const int root_fd = ::open(QFile::encodeName(root).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (root_fd >= 0) {
+            std::set<DirId> visited_dirs;
+            walk_dir_fd(root_fd, root, root.length(), visited_dirs, out);
+        }
+        return out;
+    }
+#endif
+
+    constexpr auto dir_filters = QDir::Files | QDir::NoDotAndDotDot;
+    constexpr auto dir_flags = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
+
+    QDirIterator dir_it(root, dir_filters, dir_flags);
+    while (dir_it.hasNext())
+        out.emplace_back(dir_it.next(), root.length());
+
+    return out;
+}
+
+} // namespace providers
@@ -0,0 +1,50 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <QString>
+#include <QStringRef>
+#include <vector>
+
+
+namespace providers {
+
+/// A file found under a media directory
+struct MediaFile {
+    /// The root media directory, a slash, then the relative path
+    QString path;
+    int rel_offset;
+    int name_offset;
+    /// The position of the last dot in the file name, or -1
+    int dot_offset;
+
+    explicit MediaFile(QString, int);
+
+    QStringRef rel_path() const { return path.midRef(rel_offset); }
+    /// The relative directory of the file, empty for files directly in the root
+    QStringRef rel_dir() const;
+    QStringRef complete_basename() const;
+    QStringRef suffix() const;
+};
+
+/// Lists every non-hidden file under the directory in a single recursive pass,
+/// following symlinks. On Unix, no per-file stat call is made if the file system
+/// reports the entry types.
+std::vector<MediaFile> walk_media_dir(const QString&);
+
+} // namespace providers
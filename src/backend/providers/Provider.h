@@ -36,6 +36,11 @@ constexpr uint8_t PROVIDER_FLAG_NONE = 0;
 constexpr uint8_t PROVIDER_FLAG_INTERNAL = (1 << 0);
 constexpr uint8_t PROVIDER_FLAG_HIDE_PROGRESS = (1 << 1);
 constexpr uint8_t PROVIDER_FLAG_CACHEABLE = (1 << 2);
+// Never creates games, only extends the ones found by the other providers;
+// these run after all game producing providers have finished, in order
+constexpr uint8_t PROVIDER_FLAG_DECORATOR = (1 << 3);
+// Finds games only through the root game dirs, and can be re-run for a subset of them
+constexpr uint8_t PROVIDER_FLAG_GAMEDIR_SCOPED = (1 << 4);
 
 
 class Provider : public QObject {
@@ -52,7 +57,7 @@ public:
     virtual Provider& run(SearchContext&) { return *this; }
 
     // events
-    virtual void onGameFavoriteChanged(const std::vector<model::Game*>&) {}
+    virtual void onGameFavoriteChanged(model::Game* const) {}
     virtual void onGameLaunched(model::GameFile* const) {}
     virtual void onGameFinished(model::GameFile* const) {}
 
@@ -60,6 +65,7 @@ public:
     const QLatin1String& codename() const { return m_codename; }
     const QString& display_name() const { return m_display_name; }
     uint8_t flags() const { return m_flags; }
+    bool produces_games() const { return !(m_flags & PROVIDER_FLAG_DECORATOR); }
 
     Provider& setOption(const QString&, QString);
     Provider& setOption(const QString&, std::vector<QString>);
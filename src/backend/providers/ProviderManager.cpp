@@ -19,11 +19,19 @@
 
 #include "AppSettings.h"
 #include "GameDataCache.h"
+#include "LibraryWatcher.h"
 #include "Log.h"
 #include "Provider.h"
 #include "SearchContext.h"
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
+#include "utils/PathTools.h"
+#include "utils/StdHelpers.h"
 
+#include <QThread>
 #include <QtConcurrent/QtConcurrent>
+#include <memory>
 
 using ProviderPtr = providers::Provider*;
 
@@ -38,25 +46,45 @@ std::vector<ProviderPtr> enabled_providers()
     }
     return out;
 }
+
+QString file_key(const model::GameFile& gamefile)
+{
+    const QString path = gamefile.path();
+    return path.isEmpty() ? gamefile.uri() : path;
+}
 } // namespace
 
 
 ProviderManager::ProviderManager(QObject* parent)
     : QObject(parent)
+    , m_watcher(new LibraryWatcher(this))
 {
     for (const auto& provider : AppSettings::providers()) {
         connect(provider.get(), &providers::Provider::progressChanged,
                 this, &ProviderManager::onProviderProgressChanged);
     }
+
+    connect(m_watcher, &LibraryWatcher::rootDirsChanged,
+            this, &ProviderManager::onRootDirsChanged);
+    connect(&m_future_watcher, &QFutureWatcher<void>::finished,
+            this, &ProviderManager::onFutureFinished);
 }
 
 void ProviderManager::run(const bool force_refresh)
 {
-    Q_ASSERT(!m_future.isRunning());
+    // A live update may still be running, its results are not needed anymore
+    if (m_future.isRunning())
+        m_future.waitForFinished();
+    discard_live_update();
+
+    m_watcher->stop();
+    m_pending_dirs.clear();
+    m_origins = LibraryOrigins();
 
     m_found_games.clear();
     m_found_collections.clear();
 
+    m_full_scan_running = true;
     m_future = QtConcurrent::run([this, force_refresh]{
         emit scanStarted();
 
@@ -68,61 +96,22 @@ void ProviderManager::run(const bool force_refresh)
 
         const std::vector<ProviderPtr> providers = enabled_providers();
 
-        if (!force_refresh && GameDataCache::load(sctx, providers)) {
-            Log::info(LOGMSG("Skipping full scan due to game index cache"));
-
-            for (const ProviderPtr& provider : providers) {
-                if (provider->flags() & providers::PROVIDER_FLAG_CACHEABLE)
-                    continue;
-
-                Log::info(LOGMSG("Running lightweight provider after cache restore: %1")
-                    .arg(provider->display_name()));
-                provider->run(sctx);
-            }
-
-            QElapsedTimer finalize_timer;
-            finalize_timer.start();
-            // TODO: C++17
-            std::tie(m_found_collections, m_found_games) = sctx.finalize();
-            Log::info(LOGMSG("Game list cache restore took %1ms").arg(finalize_timer.elapsed()));
-
-            m_current_progress = 1.f;
-            m_current_stage = QString();
-            emit scanProgressChanged(m_current_progress, m_current_stage);
+        if (!force_refresh && run_from_cache(sctx, providers)) {
+            collect_origins(m_origins, sctx, m_found_collections, m_found_games);
+            report_finished();
             emit scanFinished();
             return;
         }
-        
+
         size_t progress_sections = providers.size();
         for (const ProviderPtr provider : providers) {
             if (provider->flags() & providers::PROVIDER_FLAG_HIDE_PROGRESS)
                 progress_sections--;
         }
+        reset_progress(progress_sections);
 
-        m_progress_step = 1.f / std::max<size_t>(progress_sections, 1);
-        m_current_stage = QString();
-        m_current_progress = 0.f;
-
-        for (size_t i = 0; i < providers.size(); i++) {
-            providers::Provider& provider = *providers[i];
-            m_current_stage = provider.display_name();
-            emit scanProgressChanged(m_current_progress, m_current_stage);
-
-            QElapsedTimer provider_timer;
-            provider_timer.start();
-
-            provider.run(sctx);
-
-            Log::info(provider.display_name(), LOGMSG("Finished searching in %1ms")
-                .arg(QString::number(provider_timer.restart())));
-
-            const bool has_progress = !(provider.flags() & providers::PROVIDER_FLAG_HIDE_PROGRESS);
-            if (has_progress)
-                m_current_progress += m_progress_step;
-        }
-        m_current_progress = 1.f;
-        m_current_stage = QString();
-        emit scanProgressChanged(m_current_progress, m_current_stage);
+        run_providers(sctx, providers);
+        report_finished();
 
 
         if (sctx.has_pending_downloads()) {
@@ -148,43 +137,563 @@ void ProviderManager::run(const bool force_refresh)
 
         Log::info(LOGMSG("Game list post-processing took %1ms").arg(finalize_timer.elapsed()));
         GameDataCache::save(sctx, providers, m_found_collections, m_found_games);
+
+        collect_origins(m_origins, sctx, m_found_collections, m_found_games);
+        m_origins.all_dirs_scanned = true;
         emit scanFinished();
     });
+    m_future_watcher.setFuture(m_future);
 }
 
-void ProviderManager::onProviderProgressChanged(float percent)
+bool ProviderManager::run_from_cache(providers::SearchContext& sctx, const std::vector<ProviderPtr>& providers)
 {
-    if (m_current_stage.isEmpty())
+    QStringList changed_dirs;
+    if (!GameDataCache::findChangedDirs(sctx, providers, changed_dirs))
+        return false;
+
+    std::unique_ptr<providers::SearchContext> rescan_sctx;
+    if (!changed_dirs.isEmpty())
+        rescan_sctx = rescan_dirs(changed_dirs, providers, false);
+
+    if (!GameDataCache::load(sctx, providers, changed_dirs, rescan_sctx.get())) {
+        if (rescan_sctx) {
+            // The partial results are not usable, a full scan follows
+            const auto partial_results = rescan_sctx->finalize();
+            qDeleteAll(partial_results.second);
+            qDeleteAll(partial_results.first);
+        }
+        return false;
+    }
+
+    if (rescan_sctx) {
+        QElapsedTimer merge_timer;
+        merge_timer.start();
+        sctx.merge(*rescan_sctx);
+        Log::info(LOGMSG("Merging %1 rescanned directories into the cached library took %2ms")
+            .arg(QString::number(changed_dirs.size()), QString::number(merge_timer.elapsed())));
+    }
+    else {
+        Log::info(LOGMSG("Skipping full scan due to game index cache"));
+    }
+
+    for (const ProviderPtr& provider : providers) {
+        if (provider->flags() & providers::PROVIDER_FLAG_CACHEABLE)
+            continue;
+
+        Log::info(LOGMSG("Running lightweight provider after cache restore: %1")
+            .arg(provider->display_name()));
+        provider->run(sctx);
+    }
+
+    QElapsedTimer finalize_timer;
+    finalize_timer.start();
+    // TODO: C++17
+    std::tie(m_found_collections, m_found_games) = sctx.finalize();
+    Log::info(LOGMSG("Game list cache restore took %1ms").arg(finalize_timer.elapsed()));
+
+    if (rescan_sctx)
+        GameDataCache::save(sctx, providers, m_found_collections, m_found_games);
+
+    return true;
+}
+
+std::unique_ptr<providers::SearchContext> ProviderManager::rescan_dirs(
+    const QStringList& dir_paths,
+    const std::vector<ProviderPtr>& providers,
+    const bool with_lightweight)
+{
+    // Only the providers working from the root game dirs can be re-run,
+    // together with the decorators that would have extended their results
+    std::unique_ptr<providers::SearchContext> rescan_sctx(new providers::SearchContext(dir_paths));
+    rescan_sctx->enable_partial_scan();
+
+    for (const ProviderPtr provider : providers) {
+        const bool is_cacheable = provider->flags() & providers::PROVIDER_FLAG_CACHEABLE;
+        const bool rerun = (provider->flags() & providers::PROVIDER_FLAG_GAMEDIR_SCOPED)
+            || (!provider->produces_games() && (is_cacheable || with_lightweight));
+        if (!rerun)
+            continue;
+
+        QElapsedTimer provider_timer;
+        provider_timer.start();
+
+        if (provider->produces_games()) {
+            provider->run(*rescan_sctx);
+        }
+        else {
+            // the decorators may change the state used by the events
+            const QMutexLocker lock(&m_event_guard);
+            provider->run(*rescan_sctx);
+        }
+
+        Log::info(provider->display_name(), LOGMSG("Rescanning the changed directories took %1ms")
+            .arg(QString::number(provider_timer.elapsed())));
+    }
+
+    return rescan_sctx;
+}
+
+void ProviderManager::collect_origins(
+    LibraryOrigins& origins,
+    const providers::SearchContext& sctx,
+    const std::vector<model::Collection*>& collections,
+    const std::vector<model::Game*>& games)
+{
+    origins.root_dirs = sctx.root_game_dirs();
+    origins.game_dirs = sctx.source_game_dirs();
+
+    for (const model::Collection* const coll : collections) {
+        QString dir_path = sctx.collection_source_dir(*coll);
+        if (!dir_path.isEmpty())
+            origins.collection_dirs.emplace(coll->name(), std::move(dir_path));
+    }
+
+    for (const model::Game* const game : games) {
+        if (sctx.game_is_shared(*game))
+            origins.shared_games.emplace(game);
+    }
+}
+
+void ProviderManager::setWatching(const bool enabled)
+{
+    m_watching = enabled;
+
+    if (!m_watching) {
+        m_watcher->stop();
+        m_pending_dirs.clear();
         return;
+    }
 
-    const float safe_percent = qBound(0.f, percent, 1.f);
-    emit scanProgressChanged(m_current_progress + m_progress_step * safe_percent, m_current_stage);
+    if (!m_future.isRunning())
+        start_watcher();
 }
 
+void ProviderManager::start_watcher()
+{
+    if (m_origins.root_dirs.isEmpty()) {
+        m_watcher->stop();
+        return;
+    }
+
+    HashMap<QString, QStringList> watched_dirs;
+    for (const QString& root_dir : qAsConst(m_origins.root_dirs)) {
+        const auto it = m_origins.game_dirs.find(root_dir);
+        if (it != m_origins.game_dirs.cend())
+            watched_dirs.emplace(root_dir, it->second);
+        else if (m_origins.all_dirs_scanned)
+            watched_dirs.emplace(root_dir, QStringList());
+        else // restored from the cache, the game dirs are not known
+            watched_dirs.emplace(root_dir, QStringList(root_dir));
+    }
+
+    m_watcher->watch(watched_dirs);
+}
+
+void ProviderManager::onRootDirsChanged(QStringList dir_paths)
+{
+    if (!m_watching)
+        return;
+
+    if (m_future.isRunning() || m_game_running) {
+        for (QString& dir_path : dir_paths) {
+            if (!m_pending_dirs.contains(dir_path))
+                m_pending_dirs.append(std::move(dir_path));
+        }
+        return;
+    }
+
+    run_live_update(dir_paths);
+}
 
-void ProviderManager::onFavoritesChanged(const std::vector<model::Game*>& all_games) const
+void ProviderManager::onFutureFinished()
 {
     if (m_future.isRunning())
         return;
 
-    for (const auto& provider : AppSettings::providers())
-        provider->onGameFavoriteChanged(all_games);
+    if (m_full_scan_running) {
+        m_full_scan_running = false;
+
+        std::vector<std::function<void()>> events;
+        std::swap(events, m_delayed_events);
+        for (const auto& event : events)
+            event();
+    }
+
+    if (!m_watching)
+        return;
+
+    if (!m_pending_dirs.isEmpty() && !m_game_running) {
+        QStringList dir_paths;
+        std::swap(dir_paths, m_pending_dirs);
+        run_live_update(dir_paths);
+        return;
+    }
+
+    start_watcher();
+}
+
+void ProviderManager::run_live_update(const QStringList& dir_paths)
+{
+    Q_ASSERT(!m_future.isRunning());
+    Q_ASSERT(!dir_paths.isEmpty());
+
+    QStringList pretty_dirs;
+    for (const QString& dir_path : dir_paths)
+        pretty_dirs.append(::pretty_path(dir_path));
+    Log::info(LOGMSG("Changes found in %1, updating the game list").arg(pretty_dirs.join(QLatin1String(", "))));
+
+    QThread* const main_thread = thread();
+    m_live_favorites.clear();
+
+    m_future = QtConcurrent::run([this, dir_paths, main_thread]{
+        QElapsedTimer run_timer;
+        run_timer.start();
+
+        const std::unique_ptr<providers::SearchContext> sctx = rescan_dirs(dir_paths, enabled_providers(), true);
+
+        // TODO: C++17
+        std::tie(m_live_collections, m_live_games) = sctx->finalize();
+        for (model::Collection* const coll : m_live_collections)
+            coll->moveToThread(main_thread);
+        for (model::Game* const game : m_live_games)
+            game->moveToThread(main_thread);
+
+        m_live_origins = LibraryOrigins();
+        collect_origins(m_live_origins, *sctx, m_live_collections, m_live_games);
+        m_live_dirs = dir_paths;
+
+        Log::info(LOGMSG("Updating the game list took %1ms").arg(run_timer.elapsed()));
+        emit liveUpdateReady();
+    });
+    m_future_watcher.setFuture(m_future);
+}
+
+void ProviderManager::discard_live_update()
+{
+    qDeleteAll(m_live_games);
+    qDeleteAll(m_live_collections);
+    m_live_games.clear();
+    m_live_collections.clear();
+    m_live_dirs.clear();
+    m_live_favorites.clear();
+    m_live_origins = LibraryOrigins();
 }
 
-void ProviderManager::onGameLaunched(model::GameFile* const game) const
+bool ProviderManager::takeLiveUpdate(
+    const std::vector<model::Collection*>& current_collections,
+    const std::vector<model::Game*>& current_games,
+    LibraryPatch& patch)
 {
+    // Nothing to do if the results were dropped by a full scan
+    if (m_live_dirs.isEmpty())
+        return true;
+
     if (m_future.isRunning())
+        m_future.waitForFinished();
+
+    QStringList dir_paths;
+    std::vector<model::Collection*> new_collections;
+    std::vector<model::Game*> new_games;
+    LibraryOrigins live_origins;
+    std::swap(dir_paths, m_live_dirs);
+    std::swap(new_collections, m_live_collections);
+    std::swap(new_games, m_live_games);
+    std::swap(live_origins, m_live_origins);
+
+    const auto fail = [&patch, &new_collections, &new_games](const QString& reason) -> bool {
+        Log::info(LOGMSG("Cannot update the game list in place: %1").arg(reason));
+        qDeleteAll(new_games);
+        qDeleteAll(new_collections);
+        patch = LibraryPatch();
+        return false;
+    };
+
+    // The current collections defined only by the changed dirs are replaced
+    HashMap<QString, const model::Collection*> current_coll_by_name;
+    std::unordered_set<const model::Collection*> old_colls;
+    for (model::Collection* const coll : current_collections) {
+        current_coll_by_name.emplace(coll->name(), coll);
+
+        const auto it = m_origins.collection_dirs.find(coll->name());
+        if (it != m_origins.collection_dirs.cend() && dir_paths.contains(it->second)) {
+            patch.old_collections.emplace_back(coll);
+            old_colls.emplace(coll);
+        }
+    }
+
+    for (const model::Collection* const coll : new_collections) {
+        if (!live_origins.collection_dirs.count(coll->name()))
+            return fail(LOGMSG("collection `%1` is defined in more than one metafile").arg(coll->name()));
+
+        const auto it = current_coll_by_name.find(coll->name());
+        if (it != current_coll_by_name.cend() && !old_colls.count(it->second))
+            return fail(LOGMSG("collection `%1` is also defined elsewhere").arg(coll->name()));
+    }
+
+    // The games of those collections go with them, unless they belong somewhere else too
+    std::unordered_set<QString> kept_files;
+    for (model::Game* const game : current_games) {
+        const std::vector<model::Collection*>& game_colls = game->collectionsConst();
+        const auto owned_count = std::count_if(game_colls.cbegin(), game_colls.cend(),
+            [&old_colls](const model::Collection* coll){ return old_colls.count(coll) > 0; });
+
+        if (owned_count == 0) {
+            for (const model::GameFile* const gamefile : game->filesConst())
+                kept_files.emplace(gamefile->path());
+            continue;
+        }
+
+        const bool fully_owned = static_cast<size_t>(owned_count) == game_colls.size();
+        if (!fully_owned || m_origins.shared_games.count(game))
+            return fail(LOGMSG("game `%1` was found by more than one source").arg(game->title()));
+
+        patch.old_games.emplace_back(game);
+    }
+
+    for (const model::Game* const game : new_games) {
+        for (const model::GameFile* const gamefile : game->filesConst()) {
+            if (kept_files.count(gamefile->path()))
+                return fail(LOGMSG("file `%1` already belongs to another game").arg(::pretty_path(gamefile->path())));
+        }
+    }
+
+
+    for (const model::Collection* const coll : patch.old_collections)
+        m_origins.collection_dirs.erase(coll->name());
+    for (const model::Game* const game : patch.old_games)
+        m_origins.shared_games.erase(game);
+    for (const auto& pair : live_origins.collection_dirs)
+        m_origins.collection_dirs[pair.first] = pair.second;
+    for (const QString& dir_path : qAsConst(dir_paths)) {
+        const auto it = live_origins.game_dirs.find(dir_path);
+        m_origins.game_dirs[dir_path] = it != live_origins.game_dirs.cend()
+            ? it->second
+            : QStringList();
+    }
+
+    // The favorites changed during the update may not be known by the new games yet
+    for (model::Game* const game : new_games) {
+        for (const model::GameFile* const gamefile : game->filesConst()) {
+            const auto it = m_live_favorites.find(file_key(*gamefile));
+            if (it != m_live_favorites.cend())
+                game->setFavorite(it->second);
+        }
+    }
+    m_live_favorites.clear();
+
+    patch.new_collections = std::move(new_collections);
+    patch.new_games = std::move(new_games);
+
+    // The cached index does not know about the changes of the game files
+    GameDataCache::clear();
+    return true;
+}
+
+void ProviderManager::run_providers(providers::SearchContext& sctx, const std::vector<ProviderPtr>& providers)
+{
+    // Every game producing provider fills its own staging context in parallel.
+    // The providers are then applied in their original order: the staging contexts
+    // get merged, and the decorators run on the results found before them,
+    // as if the providers ran one after the other.
+    std::vector<std::unique_ptr<providers::SearchContext>> staging_contexts(providers.size());
+    std::vector<QFuture<void>> futures(providers.size());
+
+    QThread* const scan_thread = QThread::currentThread();
+    const bool with_network = sctx.has_network();
+    const QStringList root_game_dirs = sctx.root_game_dirs();
+
+    for (size_t i = 0; i < providers.size(); i++) {
+        if (!providers[i]->produces_games())
+            continue;
+
+        futures[i] = QtConcurrent::run(&m_stage_pool,
+            [this, i, &sctx, &providers, &staging_contexts, &root_game_dirs, scan_thread, with_network]{
+                providers::Provider& provider = *providers[i];
+                stage_started(provider);
+
+                QElapsedTimer provider_timer;
+                provider_timer.start();
+
+                std::unique_ptr<providers::SearchContext> staging_sctx(new providers::SearchContext(root_game_dirs));
+                staging_sctx->share_files_with(sctx);
+                if (with_network)
+                    staging_sctx->enable_deferred_network();
+
+                provider.run(*staging_sctx);
+                staging_sctx->move_to_thread(scan_thread);
+                staging_contexts[i] = std::move(staging_sctx);
+
+                Log::info(provider.display_name(), LOGMSG("Finished searching in %1ms")
+                    .arg(QString::number(provider_timer.elapsed())));
+                stage_finished(provider);
+            });
+    }
+
+    QElapsedTimer merge_timer;
+    for (size_t i = 0; i < providers.size(); i++) {
+        providers::Provider& provider = *providers[i];
+
+        if (!provider.produces_games()) {
+            run_decorator(sctx, provider);
+            continue;
+        }
+
+        futures[i].waitForFinished();
+
+        merge_timer.start();
+        sctx.merge(*staging_contexts[i]);
+        staging_contexts[i].reset();
+
+        Log::info(provider.display_name(), LOGMSG("Merging the results took %1ms")
+            .arg(QString::number(merge_timer.elapsed())));
+    }
+}
+
+void ProviderManager::run_decorator(providers::SearchContext& sctx, providers::Provider& provider)
+{
+    stage_started(provider);
+
+    QElapsedTimer provider_timer;
+    provider_timer.start();
+
+    provider.run(sctx);
+
+    Log::info(provider.display_name(), LOGMSG("Finished searching in %1ms")
+        .arg(QString::number(provider_timer.elapsed())));
+    stage_finished(provider);
+}
+
+void ProviderManager::reset_progress(size_t progress_sections)
+{
+    {
+        QMutexLocker lock(&m_progress_mutex);
+        m_progress_step = 1.f / std::max<size_t>(progress_sections, 1);
+        m_finished_progress = 0.f;
+        m_running_stages.clear();
+    }
+    report_progress();
+}
+
+void ProviderManager::stage_started(const providers::Provider& provider)
+{
+    {
+        QMutexLocker lock(&m_progress_mutex);
+        m_running_stages.emplace_back(&provider, 0.f);
+    }
+    report_progress();
+}
+
+void ProviderManager::stage_finished(const providers::Provider& provider)
+{
+    {
+        QMutexLocker lock(&m_progress_mutex);
+        VEC_REMOVE_IF(m_running_stages, [&provider](const StageProgress& stage){ return stage.first == &provider; });
+
+        const bool has_progress = !(provider.flags() & providers::PROVIDER_FLAG_HIDE_PROGRESS);
+        if (has_progress)
+            m_finished_progress += m_progress_step;
+    }
+    report_progress();
+}
+
+void ProviderManager::report_progress()
+{
+    float progress = 0.f;
+    QStringList stage_names;
+    {
+        QMutexLocker lock(&m_progress_mutex);
+        progress = m_finished_progress;
+
+        for (const auto& stage : m_running_stages) {
+            const bool has_progress = !(stage.first->flags() & providers::PROVIDER_FLAG_HIDE_PROGRESS);
+            if (has_progress)
+                progress += m_progress_step * stage.second;
+
+            stage_names.append(stage.first->display_name());
+        }
+    }
+
+    emit scanProgressChanged(qBound(0.f, progress, 1.f), stage_names.join(QLatin1String(", ")));
+}
+
+void ProviderManager::report_finished()
+{
+    {
+        QMutexLocker lock(&m_progress_mutex);
+        m_finished_progress = 1.f;
+        m_running_stages.clear();
+    }
+    emit scanProgressChanged(1.f, QString());
+}
+
+void ProviderManager::onProviderProgressChanged(float percent)
+{
+    const auto* const provider = static_cast<const providers::Provider*>(QObject::sender());
+    {
+        QMutexLocker lock(&m_progress_mutex);
+        const auto it = std::find_if(m_running_stages.begin(), m_running_stages.end(),
+            [provider](const StageProgress& stage){ return stage.first == provider; });
+        if (it == m_running_stages.end())
+            return;
+
+        it->second = qBound(0.f, percent, 1.f);
+    }
+    report_progress();
+}
+
+
+void ProviderManager::deliver_event(std::function<void()>&& event)
+{
+    // The providers may be reading their data during a full scan. Live updates
+    // run often and in the background, only their decorators are waited for.
+    if (m_full_scan_running) {
+        m_delayed_events.emplace_back(std::move(event));
         return;
+    }
 
-    for (const auto& provider : AppSettings::providers())
-        provider->onGameLaunched(game);
+    const QMutexLocker lock(&m_event_guard);
+    event();
 }
 
-void ProviderManager::onGameFinished(model::GameFile* const game) const
+void ProviderManager::onFavoriteChanged(model::Game* const game)
 {
+    // The results of a live update started earlier may not know about the change yet
+    if (!m_full_scan_running) {
+        for (const model::GameFile* const gamefile : game->filesConst())
+            m_live_favorites[file_key(*gamefile)] = game->isFavorite();
+    }
+
+    deliver_event([game]{
+        for (const auto& provider : AppSettings::providers())
+            provider->onGameFavoriteChanged(game);
+    });
+}
+
+void ProviderManager::onGameLaunched(model::GameFile* const game)
+{
+    m_game_running = true;
+
+    deliver_event([game]{
+        for (const auto& provider : AppSettings::providers())
+            provider->onGameLaunched(game);
+    });
+}
+
+void ProviderManager::onGameFinished(model::GameFile* const game)
+{
+    m_game_running = false;
+
+    deliver_event([game]{
+        for (const auto& provider : AppSettings::providers())
+            provider->onGameFinished(game);
+    });
+
     if (m_future.isRunning())
         return;
 
-    for (const auto& provider : AppSettings::providers())
-        provider->onGameFinished(game);
+    if (m_watching && !m_pending_dirs.isEmpty()) {
+        QStringList dir_paths;
+        std::swap(dir_paths, m_pending_dirs);
+        run_live_update(dir_paths);
+    }
 }
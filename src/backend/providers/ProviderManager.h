@@ -17,13 +17,33 @@
 
 #pragma once
 
+#include "utils/HashMap.h"
+
 #include <QObject>
 #include <QFuture>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QStringList>
+#include <QThreadPool>
+#include <functional>
+#include <memory>
+#include <unordered_set>
 
 namespace model { class Collection; }
 namespace model { class Game; }
 namespace model { class GameFile; }
+namespace providers { class Provider; }
+namespace providers { class SearchContext; }
+class LibraryWatcher;
+
 
+/// The part of the library replaced by a live update
+struct LibraryPatch {
+    std::vector<model::Collection*> old_collections;
+    std::vector<model::Game*> old_games;
+    std::vector<model::Collection*> new_collections;
+    std::vector<model::Game*> new_games;
+};
 
 class ProviderManager : public QObject {
     Q_OBJECT
@@ -33,9 +53,21 @@ public:
 
     void run(const bool force_refresh);
 
-    void onGameLaunched(model::GameFile* const) const;
-    void onGameFinished(model::GameFile* const) const;
-    void onFavoritesChanged(const std::vector<model::Game*>&) const;
+    /// When enabled, the root game dirs of the last scan are watched,
+    /// and changed ones are scanned again in the background
+    void setWatching(bool);
+    /// Takes the results of the last live update and the parts of the current library they replace.
+    /// Returns false if the update can't be applied in place, and a full rescan is needed.
+    bool takeLiveUpdate(
+        const std::vector<model::Collection*>& current_collections,
+        const std::vector<model::Game*>& current_games,
+        LibraryPatch&);
+
+    /// While a game is running, the changes found by the watcher are only collected.
+    /// Events arriving during a full scan are passed to the providers after it has finished.
+    void onGameLaunched(model::GameFile* const);
+    void onGameFinished(model::GameFile* const);
+    void onFavoriteChanged(model::Game* const);
 
     std::vector<model::Collection*>& foundCollections() { return m_found_collections; }
     std::vector<model::Game*>& foundGames() { return m_found_games; }
@@ -44,18 +76,67 @@ signals:
     void scanStarted();
     void scanProgressChanged(float, QString);
     void scanFinished();
+    void liveUpdateReady();
 
 private slots:
     void onProviderProgressChanged(float);
+    void onRootDirsChanged(QStringList);
+    void onFutureFinished();
 
 private:
     QFuture<void> m_future;
+    QFutureWatcher<void> m_future_watcher;
+    bool m_full_scan_running = false;
+    std::vector<std::function<void()>> m_delayed_events;
+    // Events and the decorators of live updates never run at the same time
+    QMutex m_event_guard;
+    QThreadPool m_stage_pool;
+
+    // NOTE: game producing providers may run in parallel, the progress is the sum of all stages
+    QMutex m_progress_mutex;
     float m_progress_step = 1.f;
-    float m_current_progress = 0.f;
-    QString m_current_stage;
+    float m_finished_progress = 0.f;
+    using StageProgress = std::pair<const providers::Provider*, float>;
+    std::vector<StageProgress> m_running_stages;
 
     std::vector<model::Collection*> m_found_collections;
     std::vector<model::Game*> m_found_games;
 
-    void finalize();
+    // Where the current library came from, used for live updates
+    struct LibraryOrigins {
+        QStringList root_dirs;
+        bool all_dirs_scanned = false;
+        HashMap<QString, QString> collection_dirs;
+        std::unordered_set<const model::Game*> shared_games;
+        HashMap<QString, QStringList> game_dirs;
+    };
+    LibraryOrigins m_origins;
+
+    LibraryWatcher* const m_watcher;
+    bool m_watching = false;
+    bool m_game_running = false;
+    QStringList m_pending_dirs;
+
+    QStringList m_live_dirs;
+    HashMap<QString, bool> m_live_favorites; // changed since the live update started, by file
+    LibraryOrigins m_live_origins;
+    std::vector<model::Collection*> m_live_collections;
+    std::vector<model::Game*> m_live_games;
+
+    static void collect_origins(LibraryOrigins&, const providers::SearchContext&, const std::vector<model::Collection*>&, const std::vector<model::Game*>&);
+    void start_watcher();
+    void run_live_update(const QStringList&);
+    void discard_live_update();
+    void deliver_event(std::function<void()>&&);
+
+    bool run_from_cache(providers::SearchContext&, const std::vector<providers::Provider*>&);
+    std::unique_ptr<providers::SearchContext> rescan_dirs(const QStringList&, const std::vector<providers::Provider*>&, bool);
+    void run_providers(providers::SearchContext&, const std::vector<providers::Provider*>&);
+    void run_decorator(providers::SearchContext&, providers::Provider&);
+
+    void reset_progress(size_t);
+    void stage_started(const providers::Provider&);
+    void stage_finished(const providers::Provider&);
+    void report_progress();
+    void report_finished();
 };
@@ -19,18 +19,23 @@
 
 #include "AppSettings.h"
 #include "Log.h"
+#include "model/gaming/Assets.h"
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
 #include "model/gaming/GameFile.h"
+#include "model/gaming/SortRank.h"
 #include "utils/DiskCachedNAM.h"
 #include "utils/PathTools.h"
 #include "utils/StdHelpers.h"
+#include "utils/StringPool.h"
 
 #include <QFileInfo>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QSslSocket>
+#include <QThread>
+#include <unordered_set>
 
 
 namespace {
@@ -47,6 +52,87 @@ QStringList read_game_dirs()
     game_dirs.removeDuplicates();
     return game_dirs;
 }
+
+// NOTE: When the same entry is found by multiple providers, the fields set by the
+//       later provider win, as if the providers ran one after the other on the same entry.
+
+void apply_extra(QVariantMap& dest, const QVariantMap& src)
+{
+    for (auto it = src.cbegin(); it != src.cend(); ++it)
+        dest.insert(it.key(), it.value());
+}
+
+void append_missing(QStringList& dest, const QStringList& src)
+{
+    for (const QString& item : src) {
+        if (!dest.contains(item))
+            dest.append(item);
+    }
+}
+
+void apply_collection_fields(model::Collection& dest, const model::Collection& src)
+{
+    if (src.sortBy() != src.name())
+        dest.setSortBy(src.sortBy());
+    if (src.shortName() != src.name().toLower())
+        dest.setShortName(src.shortName());
+    if (!src.summary().isEmpty())
+        dest.setSummary(src.summary());
+    if (!src.description().isEmpty())
+        dest.setDescription(src.description());
+    if (!src.commonLaunchCmd().isEmpty())
+        dest.setCommonLaunchCmd(src.commonLaunchCmd());
+    if (!src.commonLaunchWorkdir().isEmpty())
+        dest.setCommonLaunchWorkdir(src.commonLaunchWorkdir());
+    if (!src.commonLaunchCmdBasedir().isEmpty())
+        dest.setCommonLaunchCmdBasedir(src.commonLaunchCmdBasedir());
+
+    apply_extra(dest.extraMapMut(), src.extraMap());
+    dest.assetsMut().add_all_from(src.assets());
+}
+
+bool has_placeholder_title(const model::Game& game, const std::vector<model::GameFile*>& files)
+{
+    return game.title().isEmpty()
+        || (!files.empty() && game.title() == files.front()->name());
+}
+
+void apply_game_fields(model::Game& dest, const model::Game& src, const std::vector<model::GameFile*>& src_files)
+{
+    if (!has_placeholder_title(src, src_files)) {
+        dest.setTitle(src.title())
+            .setSortBy(src.sortBy());
+    }
+
+    if (!src.summary().isEmpty())
+        dest.setSummary(src.summary());
+    if (!src.description().isEmpty())
+        dest.setDescription(src.description());
+    if (src.releaseDate().isValid())
+        dest.setReleaseDate(src.releaseDate());
+    if (src.playerCount() > 1)
+        dest.setPlayerCount(src.playerCount());
+    if (src.rating() > 0.f)
+        dest.setRating(src.rating());
+
+    append_missing(dest.developerList(), src.developerListConst());
+    append_missing(dest.publisherList(), src.publisherListConst());
+    append_missing(dest.genreList(), src.genreListConst());
+    append_missing(dest.tagList(), src.tagListConst());
+
+    // NOTE: new games inherit the launch fields of their collection, so a staging
+    //       context can't tell them apart from explicit ones; like when the providers
+    //       shared the same game, these are only filled in if missing (see game_add_to)
+    if (dest.launchCmd().isEmpty())
+        dest.setLaunchCmd(src.launchCmd());
+    if (dest.launchWorkdir().isEmpty())
+        dest.setLaunchWorkdir(src.launchWorkdir());
+    if (dest.launchCmdBasedir().isEmpty())
+        dest.setLaunchCmdBasedir(src.launchCmdBasedir());
+
+    apply_extra(dest.extraMapMut(), src.extraMap());
+    dest.assetsMut().add_all_from(src.assets());
+}
 } // namespace
 
 
@@ -59,6 +145,7 @@ SearchContext::SearchContext(QStringList game_dirs, QObject* parent)
     : QObject(parent)
     , m_root_game_dirs(std::move(game_dirs))
     , m_pending_downloads(0)
+    , m_files(std::make_shared<FileCache>())
 {}
 
 SearchContext& SearchContext::pegasus_add_game_dir(QString path)
@@ -68,6 +155,66 @@ SearchContext& SearchContext::pegasus_add_game_dir(QString path)
     return *this;
 }
 
+SearchContext& SearchContext::share_files_with(const SearchContext& other)
+{
+    m_files = other.m_files;
+    return *this;
+}
+
+SearchContext& SearchContext::enable_partial_scan()
+{
+    m_partial_scan = true;
+    return *this;
+}
+
+SearchContext& SearchContext::collection_add_source_dir(model::Collection& collection, const QString& dir_path)
+{
+    const auto it = m_collection_source_dirs.find(&collection);
+    if (it == m_collection_source_dirs.cend())
+        m_collection_source_dirs.emplace(&collection, dir_path);
+    else if (it->second != dir_path)
+        it->second.clear();
+
+    return *this;
+}
+
+QString SearchContext::collection_source_dir(const model::Collection& collection) const
+{
+    const auto it = m_collection_source_dirs.find(&collection);
+    return it != m_collection_source_dirs.cend()
+        ? it->second
+        : QString();
+}
+
+SearchContext& SearchContext::game_mark_shared(model::Game& game)
+{
+    m_shared_games.emplace(&game);
+    return *this;
+}
+
+bool SearchContext::game_is_shared(const model::Game& game) const
+{
+    return m_shared_games.count(&game) > 0;
+}
+
+SearchContext& SearchContext::source_add_game_dir(const QString& source_dir, QString dir_path)
+{
+    QStringList& dir_list = m_source_game_dirs[source_dir];
+    if (!dir_list.contains(dir_path))
+        dir_list.append(std::move(dir_path));
+
+    return *this;
+}
+
+const std::vector<MediaFile>& SearchContext::media_files(const QString& dir_path)
+{
+    auto it = m_media_files.find(dir_path);
+    if (it == m_media_files.end())
+        it = m_media_files.emplace(dir_path, walk_media_dir(dir_path)).first;
+
+    return it->second;
+}
+
 model::Collection* SearchContext::get_or_create_collection(const QString& name)
 {
     const auto it = m_collections.find(name);
@@ -87,14 +234,14 @@ model::Game* SearchContext::create_game_for(model::Collection& collection)
         .setLaunchWorkdir(collection.commonLaunchWorkdir())
         .setLaunchCmdBasedir(collection.commonLaunchCmdBasedir());
 
-    m_collection_games[&collection].emplace_back(game_ptr);
+    collection_add_game(collection, *game_ptr);
     return game_ptr;
 }
 
 model::Game* SearchContext::create_game()
 {
     auto* const game_ptr = new model::Game();
-    m_parentless_games.emplace_back(game_ptr);
+    m_parentless_games.emplace(game_ptr);
     return game_ptr;
 }
 
@@ -162,10 +309,23 @@ model::GameFile* SearchContext::game_add_uri(model::Game& game, QString uri)
     return entry_ptr;
 }
 
-SearchContext& SearchContext::game_add_to(model::Game& game, model::Collection& collection)
+void SearchContext::collection_add_game(model::Collection& collection, model::Game& game)
 {
+    // a game is usually in only a few collections
+    std::vector<model::Collection*>& game_colls = m_game_collections[&game];
+    if (VEC_CONTAINS(game_colls, &collection))
+        return;
+
+    if (game_colls.empty())
+        m_parentless_games.erase(&game);
+
+    game_colls.emplace_back(&collection);
     m_collection_games[&collection].emplace_back(&game);
-    VEC_REMOVE_VALUE(m_parentless_games, &game);
+}
+
+SearchContext& SearchContext::game_add_to(model::Game& game, model::Collection& collection)
+{
+    collection_add_game(collection, game);
 
     if (game.launchCmd().isEmpty())
         game.setLaunchCmd(collection.commonLaunchCmd());
@@ -177,12 +337,184 @@ SearchContext& SearchContext::game_add_to(model::Game& game, model::Collection&
     return *this;
 }
 
+SearchContext& SearchContext::move_to_thread(QThread* const thread)
+{
+    std::unordered_set<QObject*> objects;
+    for (const auto& pair : m_collections)
+        objects.emplace(pair.second);
+    for (const auto& pair : m_collection_games)
+        objects.insert(pair.second.cbegin(), pair.second.cend());
+    for (const auto& pair : m_game_entries)
+        objects.emplace(pair.first);
+    objects.insert(m_parentless_games.cbegin(), m_parentless_games.cend());
+
+    // NOTE: game files and assets are children of their games and move with them
+    for (QObject* const obj : objects)
+        obj->moveToThread(thread);
+
+    moveToThread(thread);
+    return *this;
+}
+
+SearchContext& SearchContext::merge(SearchContext& other)
+{
+    Q_ASSERT(this != &other);
+    Q_ASSERT(other.thread() == thread());
+    Q_ASSERT(!other.has_pending_downloads());
+
+    // Collections are matched by name
+    HashMap<model::Collection*, model::Collection*> collection_map;
+    for (const auto& pair : other.m_collections) {
+        model::Collection* const src_coll = pair.second;
+
+        const auto src_dir_it = other.m_collection_source_dirs.find(src_coll);
+        const bool src_has_dir = src_dir_it != other.m_collection_source_dirs.cend();
+
+        const auto it = m_collections.find(pair.first);
+        if (it == m_collections.cend()) {
+            m_collections.emplace(pair.first, src_coll);
+            collection_map.emplace(src_coll, src_coll);
+            if (src_has_dir)
+                m_collection_source_dirs.emplace(src_coll, src_dir_it->second);
+            continue;
+        }
+
+        apply_collection_fields(*it->second, *src_coll);
+        collection_map.emplace(src_coll, it->second);
+
+        // Defined by multiple sources, can't be rescanned on its own
+        if (src_has_dir || m_collection_source_dirs.count(it->second))
+            m_collection_source_dirs[it->second].clear();
+    }
+
+    // Games are matched by their files; the game that found a file first keeps it
+    std::unordered_set<model::GameFile*> known_files;
+    HashMap<model::Game*, model::Game*> game_map;
+    const auto find_known_files = [&known_files, &game_map](
+        const HashMap<QString, model::GameFile*>& own_map,
+        const HashMap<QString, model::GameFile*>& other_map)
+    {
+        for (const auto& pair : other_map) {
+            const auto it = own_map.find(pair.first);
+            if (it == own_map.cend())
+                continue;
+
+            known_files.emplace(pair.second);
+            game_map.emplace(pair.second->parentGame(), it->second->parentGame());
+        }
+    };
+    find_known_files(m_filepath_to_gamefile, other.m_filepath_to_gamefile);
+    find_known_files(m_uri_to_gamefile, other.m_uri_to_gamefile);
+
+    for (const auto& pair : other.m_filepath_to_gamefile) {
+        if (!known_files.count(pair.second))
+            m_filepath_to_gamefile.emplace(pair.first, pair.second);
+    }
+    for (const auto& pair : other.m_uri_to_gamefile) {
+        if (!known_files.count(pair.second))
+            m_uri_to_gamefile.emplace(pair.first, pair.second);
+    }
+
+    for (auto& pair : other.m_game_entries) {
+        model::Game* const src_game = pair.first;
+        std::vector<model::GameFile*>& src_files = pair.second;
+
+        const auto map_it = game_map.find(src_game);
+        if (map_it == game_map.cend()) {
+            m_game_entries.emplace(src_game, std::move(src_files));
+            continue;
+        }
+
+        model::Game& dest_game = *map_it->second;
+        std::vector<model::GameFile*>& dest_files = m_game_entries[&dest_game];
+        apply_game_fields(dest_game, *src_game, src_files);
+        m_shared_games.emplace(&dest_game);
+
+        for (model::GameFile* const gamefile : src_files) {
+            if (known_files.count(gamefile)) {
+                delete gamefile;
+                continue;
+            }
+
+            gamefile->setParent(&dest_game);
+            dest_files.emplace_back(gamefile);
+        }
+
+        // NOTE: only deleted during finalization, as the providers
+        //       may still hold pointers to it until then
+        m_merged_games.emplace_back(src_game);
+    }
+
+    for (model::Game* const game_ptr : other.m_parentless_games) {
+        if (!game_map.count(game_ptr))
+            m_parentless_games.emplace(game_ptr);
+    }
+
+    m_shared_games.insert(other.m_shared_games.cbegin(), other.m_shared_games.cend());
+
+    for (auto& pair : other.m_collection_games) {
+        model::Collection& dest_coll = *collection_map.at(pair.first);
+
+        for (model::Game* const src_game : pair.second) {
+            const auto map_it = game_map.find(src_game);
+            model::Game& dest_game = map_it == game_map.cend()
+                ? *src_game
+                : *map_it->second;
+            collection_add_game(dest_coll, dest_game);
+        }
+    }
+
+    for (const auto& pair : collection_map) {
+        if (pair.first != pair.second)
+            delete pair.first;
+    }
+
+    for (QString& dir_path : other.m_pegasus_game_dirs)
+        pegasus_add_game_dir(std::move(dir_path));
+
+    for (auto& pair : other.m_source_game_dirs) {
+        for (QString& dir_path : pair.second)
+            source_add_game_dir(pair.first, std::move(dir_path));
+    }
+
+    // the downloads of merged games should update the game that was kept
+    for (DeferredDownload& download : other.m_deferred_downloads) {
+        const auto map_it = game_map.find(download.game);
+        model::Game& target = map_it == game_map.cend()
+            ? *download.game
+            : *map_it->second;
+        schedule_download(download.url, target, download.callback);
+    }
+
+
+    other.m_collections.clear();
+    other.m_collection_games.clear();
+    other.m_game_collections.clear();
+    other.m_game_entries.clear();
+    other.m_filepath_to_gamefile.clear();
+    other.m_uri_to_gamefile.clear();
+    other.m_parentless_games.clear();
+    other.m_pegasus_game_dirs.clear();
+    other.m_deferred_downloads.clear();
+    other.m_collection_source_dirs.clear();
+    other.m_shared_games.clear();
+    other.m_source_game_dirs.clear();
+    return *this;
+}
+
 void SearchContext::finalize_cleanup_games()
 {
+    for (model::Game* const game_ptr : m_merged_games) {
+        m_shared_games.erase(game_ptr);
+        delete game_ptr;
+    }
+    m_merged_games.clear();
+
     // remove parentless games
     for (model::Game* const game_ptr : m_parentless_games) {
         Log::warning(LOGMSG("The game '%1' does not belong to any collections, ignored").arg(game_ptr->title()));
         m_game_entries.erase(game_ptr);
+        m_shared_games.erase(game_ptr);
         delete game_ptr;
     }
 
@@ -222,6 +554,7 @@ void SearchContext::finalize_cleanup_collections()
     // Remove invalid collections
     for (model::Collection* const coll_ptr : deleted_collections) {
         m_collections.erase(coll_ptr->name());
+        m_collection_source_dirs.erase(coll_ptr);
         delete coll_ptr;
     }
 }
@@ -234,22 +567,16 @@ void SearchContext::finalize_apply_lists()
         pair.first->setFiles(std::move(pair.second));
     }
 
-    // Apply collections to games
-    HashMap<model::Game*, std::vector<model::Collection*>> game_collections;
-    for (const auto& pair : m_collection_games) {
-        for (model::Game* const game_ptr : pair.second)
-            game_collections[game_ptr].emplace_back(pair.first);
-    }
-    for (auto& pair : game_collections) {
-        VEC_REMOVE_DUPLICATES(pair.second);
-        pair.first->setCollections(std::move(pair.second));
+    // Apply collections to games; the lists have no duplicates
+    for (auto& pair : m_game_collections) {
+        if (m_game_entries.count(pair.first))
+            pair.first->setCollections(std::move(pair.second));
     }
+    m_game_collections.clear();
 
     // Apply games to collections
-    for (auto& pair : m_collection_games) {
-        VEC_REMOVE_DUPLICATES(pair.second);
+    for (auto& pair : m_collection_games)
         pair.first->setGames(std::move(pair.second));
-    }
 }
 
 std::pair<std::vector<model::Collection*>, std::vector<model::Game*>> SearchContext::finalize(QObject* const parent)
@@ -258,21 +585,44 @@ std::pair<std::vector<model::Collection*>, std::vector<model::Game*>> SearchCont
 
     finalize_cleanup_games();
     finalize_cleanup_collections();
-    finalize_apply_lists();
-
 
     std::vector<model::Game*> games;
     games.reserve(m_game_entries.size());
+    for (const auto& pair : m_game_entries)
+        games.emplace_back(pair.first);
+
+    std::vector<model::Collection*> collections;
+    collections.reserve(m_collections.size());
+    for (auto& pair : m_collections)
+        collections.emplace_back(pair.second);
+
+    // Also sorts the lists; the per-collection lists are then sorted by these ranks
+    model::assign_sort_ranks(games);
+    model::assign_sort_ranks(collections);
+
+    finalize_apply_lists();
+
+    // NOTE: includes the checks of the staging contexts sharing the same cache
+    if (m_files->query_count() > 0) {
+        Log::info(LOGMSG("Answered %1 file checks by listing %2 directories")
+            .arg(QString::number(m_files->query_count()), QString::number(m_files->dir_read_count())));
+    }
+
 
-    for (const auto& pair : m_game_entries) {
-        model::Game& game = *pair.first;
+    // the same few developers, genres, etc. are repeated in most games
+    utils::StringPool string_pool;
+    for (model::Game* const game_ptr : games) {
+        model::Game& game = *game_ptr;
 
         game.developerList().removeDuplicates();
         game.publisherList().removeDuplicates();
         game.genreList().removeDuplicates();
         game.tagList().removeDuplicates();
 
-        games.emplace_back(pair.first);
+        string_pool.intern(game.developerList());
+        string_pool.intern(game.publisherList());
+        string_pool.intern(game.genreList());
+        string_pool.intern(game.tagList());
     }
     if (parent) {
         for (model::Game* game : games) {
@@ -282,11 +632,6 @@ std::pair<std::vector<model::Collection*>, std::vector<model::Game*>> SearchCont
     }
 
 
-    std::vector<model::Collection*> collections;
-    collections.reserve(m_collections.size());
-    for (auto& pair : m_collections)
-        collections.emplace_back(pair.second);
-
     if (parent) {
         for (model::Collection* coll : collections) {
             coll->moveToThread(parent->thread());
@@ -294,10 +639,6 @@ std::pair<std::vector<model::Collection*>, std::vector<model::Game*>> SearchCont
         }
     }
 
-
-    std::sort(collections.begin(), collections.end(), model::sort_collections);
-    std::sort(games.begin(), games.end(), model::sort_games);
-
     return std::make_pair(std::move(collections), std::move(games));
 }
 
@@ -316,9 +657,18 @@ SearchContext& SearchContext::enable_network()
     return *this;
 }
 
+SearchContext& SearchContext::enable_deferred_network()
+{
+    Q_ASSERT(!m_netman);
+
+    // Downloads are collected and only get started once merged into a networked context
+    m_defer_downloads = true;
+    return *this;
+}
+
 bool SearchContext::has_network() const
 {
-    return !!m_netman;
+    return m_netman || m_defer_downloads;
 }
 
 bool SearchContext::has_pending_downloads() const
@@ -328,11 +678,21 @@ bool SearchContext::has_pending_downloads() const
 
 SearchContext& SearchContext::schedule_download(
     const QUrl& url,
-    const std::function<void(QNetworkReply* const)>& on_finish_callback)
+    model::Game& game,
+    const DownloadCallback& on_finish_callback)
 {
-    Q_ASSERT(m_netman);
+    Q_ASSERT(m_netman || m_defer_downloads);
     Q_ASSERT(url.isValid());
 
+    if (!m_netman) {
+        DeferredDownload download;
+        download.url = url;
+        download.game = &game;
+        download.callback = on_finish_callback;
+        m_deferred_downloads.emplace_back(std::move(download));
+        return *this;
+    }
+
     m_pending_downloads++;
 
     QNetworkRequest request(url);
@@ -344,9 +704,10 @@ SearchContext& SearchContext::schedule_download(
     QNetworkReply* const reply = m_netman->get(request);
     emit downloadScheduled();
 
+    model::Game* const game_ptr = &game;
     QObject::connect(reply, &QNetworkReply::finished,
-        this, [this, reply, on_finish_callback]{
-            on_finish_callback(reply);
+        this, [this, reply, game_ptr, on_finish_callback]{
+            on_finish_callback(reply, *game_ptr);
             m_pending_downloads--;
             emit downloadCompleted();
         });
@@ -17,11 +17,17 @@
 
 #pragma once
 
+#include "providers/FileCache.h"
+#include "providers/MediaWalker.h"
 #include "utils/HashMap.h"
 #include "utils/NoCopyNoMove.h"
 
 #include <QObject>
 #include <QStringList>
+#include <QUrl>
+#include <functional>
+#include <memory>
+#include <unordered_set>
 #include <vector>
 
 namespace model { class Game; }
@@ -29,7 +35,7 @@ namespace model { class GameFile; }
 namespace model { class Collection; }
 class QNetworkAccessManager;
 class QNetworkReply;
-class QUrl;
+class QThread;
 
 
 namespace providers {
@@ -58,12 +64,51 @@ public:
     const QStringList& pegasus_game_dirs() const { return m_pegasus_game_dirs; }
     SearchContext& pegasus_add_game_dir(QString);
 
+    /// A partial scan only covers the root game dirs of the context,
+    /// global sources (eg. the metafiles in the config dir) are skipped
+    SearchContext& enable_partial_scan();
+    bool is_partial_scan() const { return m_partial_scan; }
+
+    /// Origin tracking for incremental rescans. A collection has a source dir
+    /// only if it was defined solely by the metafiles of that root game dir.
+    SearchContext& collection_add_source_dir(model::Collection&, const QString&);
+    QString collection_source_dir(const model::Collection&) const;
+    /// Shared games were found by more than one provider
+    SearchContext& game_mark_shared(model::Game&);
+    bool game_is_shared(const model::Game&) const;
+    /// The game directories used by the metafiles of a root game dir
+    SearchContext& source_add_game_dir(const QString&, QString);
+    const HashMap<QString, QStringList>& source_game_dirs() const { return m_source_game_dirs; }
+
+    /// The files under a media directory, listed on the first call only,
+    /// so the asset providers can share the same directory walk
+    const std::vector<MediaFile>& media_files(const QString&);
+    /// File checks made during the scan should go through this,
+    /// so each directory is listed only once for all providers
+    FileCache& files() const { return *m_files; }
+    /// Makes this context use the file cache of an other one, so the
+    /// staging contexts of a scan don't list the same directories again
+    SearchContext& share_files_with(const SearchContext&);
+
     SearchContext& enable_network();
+    SearchContext& enable_deferred_network();
     bool has_network() const;
-    SearchContext& schedule_download(const QUrl&, const std::function<void(QNetworkReply* const)>&);
+    /// The callback receives the game the download was made for; if that game gets merged
+    /// into an other one before the download starts, it receives the game that was kept
+    using DownloadCallback = std::function<void(QNetworkReply* const, model::Game&)>;
+    SearchContext& schedule_download(const QUrl&, model::Game&, const DownloadCallback&);
     bool has_pending_downloads() const;
 
+    /// Moves this context and every object it has created so far to the thread.
+    /// Must be called from the thread the objects were created on.
+    SearchContext& move_to_thread(QThread* const);
+    /// Takes over all findings of a staging context. Files already known by this context
+    /// keep their current game, which gets the details set by the other one applied on top.
+    SearchContext& merge(SearchContext&);
+
+    const HashMap<QString, model::Collection*>& current_collection_map() const { return m_collections; }
     const HashMap<QString, model::GameFile*>& current_filepath_to_entry_map() const { return m_filepath_to_gamefile; }
+    const HashMap<QString, model::GameFile*>& current_uri_to_entry_map() const { return m_uri_to_gamefile; }
     std::pair<std::vector<model::Collection*>, std::vector<model::Game*>> finalize(QObject* const parent = nullptr);
 
 signals:
@@ -73,17 +118,37 @@ signals:
 private:
     const QStringList m_root_game_dirs;
     QStringList m_pegasus_game_dirs;
+    bool m_partial_scan = false;
 
     QNetworkAccessManager* m_netman = nullptr;
     std::atomic<size_t> m_pending_downloads;
+    bool m_defer_downloads = false;
+    struct DeferredDownload {
+        QUrl url;
+        model::Game* game = nullptr;
+        DownloadCallback callback;
+    };
+    std::vector<DeferredDownload> m_deferred_downloads;
 
     HashMap<QString, model::Collection*> m_collections;
     HashMap<model::Collection*, std::vector<model::Game*>> m_collection_games;
+    /// The same relation from the other side, to keep the lists free of duplicates
+    HashMap<model::Game*, std::vector<model::Collection*>> m_game_collections;
     HashMap<model::Game*, std::vector<model::GameFile*>> m_game_entries;
     HashMap<QString, model::GameFile*> m_filepath_to_gamefile;
     HashMap<QString, model::GameFile*> m_uri_to_gamefile;
 
-    std::vector<model::Game*> m_parentless_games;
+    std::unordered_set<model::Game*> m_parentless_games;
+    std::vector<model::Game*> m_merged_games;
+
+    HashMap<const model::Collection*, QString> m_collection_source_dirs;
+    std::unordered_set<const model::Game*> m_shared_games;
+    HashMap<QString, QStringList> m_source_game_dirs;
+
+    HashMap<QString, std::vector<MediaFile>> m_media_files;
+    std::shared_ptr<FileCache> m_files;
+
+    void collection_add_game(model::Collection&, model::Game&);
 
     void finalize_cleanup_games();
     void finalize_cleanup_collections();
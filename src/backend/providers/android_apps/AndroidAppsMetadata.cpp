@@ -130,8 +130,7 @@ void MetadataHelper::fill_from_network(
         return;
 
 
-    model::Game* const game_ptr = &game;
-    sctx.schedule_download(url, [this, app_package, game_ptr](QNetworkReply* const reply){
+    sctx.schedule_download(url, game, [this, app_package](QNetworkReply* const reply, model::Game& target){
         if (reply->error()) {
             Log::warning(m_log_tag, LOGMSG("Downloading metadata for `%1` failed: %2")
                .arg(app_package, reply->errorString()));
@@ -148,7 +147,7 @@ void MetadataHelper::fill_from_network(
             return;
         }
 
-        const bool success = apply_json(*game_ptr, json);
+        const bool success = apply_json(target, json);
         if (success)
             providers::cache_json(m_log_tag, m_json_cache_dir, app_package, json.toJson(QJsonDocument::Compact));
     });
@@ -25,9 +25,11 @@
 #include "utils/PathTools.h"
 #include "utils/StdHelpers.h"
 
+#include <QDataStream>
 #include <QDirIterator>
 #include <QFile>
 #include <QRegularExpression>
+#include <QSaveFile>
 #include <QStringBuilder>
 #include <QTextStream>
 
@@ -52,13 +54,98 @@ QStringList parse_filters(const QString& filters_raw) {
     filter_list.removeDuplicates();
     return filter_list;
 }
+
+// The source files of the blacklist, to tell if the cache is still valid
+struct SourceStamp {
+    QString path;
+    qint64 size;
+    qint64 mtime;
+
+    bool operator==(const SourceStamp& other) const {
+        return path == other.path && size == other.size && mtime == other.mtime;
+    }
+};
+
+constexpr quint32 CACHE_MAGIC = 0x50424c31; // 'PBL1'
+
+bool read_blacklist_cache(const QString& path, const std::vector<SourceStamp>& expected_stamps, providers::es2::MameBlacklist& out)
+{
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 stamp_count = 0;
+    stream >> magic >> stamp_count;
+    if (magic != CACHE_MAGIC || stamp_count != expected_stamps.size())
+        return false;
+
+    for (const SourceStamp& expected : expected_stamps) {
+        SourceStamp stamp;
+        stream >> stamp.path >> stamp.size >> stamp.mtime;
+        if (!(stamp == expected))
+            return false;
+    }
+
+    quint32 entry_count = 0;
+    stream >> entry_count;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    // every entry takes at least the 4 bytes of its length, so a damaged
+    // count can be caught before it's used for the allocation
+    constexpr qint64 MIN_ENTRY_SIZE = 4;
+    if (entry_count > (file.size() - file.pos()) / MIN_ENTRY_SIZE)
+        return false;
+
+    providers::es2::MameBlacklist entries;
+    entries.reserve(entry_count);
+    for (quint32 i = 0; i < entry_count; i++) {
+        QString entry;
+        stream >> entry;
+        entries.emplace(std::move(entry));
+    }
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    out = std::move(entries);
+    return true;
+}
+
+bool write_blacklist_cache(const QString& path, const std::vector<SourceStamp>& stamps, const providers::es2::MameBlacklist& entries)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QFile::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream << CACHE_MAGIC << static_cast<quint32>(stamps.size());
+    for (const SourceStamp& stamp : stamps)
+        stream << stamp.path << stamp.size << stamp.mtime;
+
+    stream << static_cast<quint32>(entries.size());
+    for (const QString& entry : entries)
+        stream << entry;
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
 } // namespace
 
 
 namespace providers {
 namespace es2 {
 
-std::vector<QString> read_mame_blacklists(const QString& log_tag, const std::vector<QString>& possible_config_dirs)
+MameBlacklist read_mame_blacklists(
+    const QString& log_tag,
+    const std::vector<QString>& possible_config_dirs,
+    const QString& cache_path)
 {
     using L1Str = QLatin1String;
 
@@ -68,7 +155,20 @@ std::vector<QString> read_mame_blacklists(const QString& log_tag, const std::vec
         { L1Str("mamedevices.xml"), L1Str("device") },
     };
 
-    std::vector<QString> out;
+    std::vector<SourceStamp> stamps;
+    for (const auto& blacklist_entry : blacklists) {
+        const QFileInfo finfo(resources_path % blacklist_entry.first);
+        if (finfo.exists())
+            stamps.push_back({ finfo.absoluteFilePath(), finfo.size(), finfo.lastModified().toMSecsSinceEpoch() });
+    }
+    if (stamps.empty())
+        return {};
+
+    MameBlacklist out;
+    if (!cache_path.isEmpty() && read_blacklist_cache(cache_path, stamps, out)) {
+        Log::info(log_tag, LOGMSG("%1 MAME blacklist entries loaded from cache").arg(QString::number(out.size())));
+        return out;
+    }
 
     // TODO: C++17
     for (const auto& blacklist_entry : blacklists) {
@@ -91,20 +191,28 @@ std::vector<QString> read_mame_blacklists(const QString& log_tag, const std::vec
                 continue;
 
             const int len = line.length() - line_head.length() - line_tail.length();
-            out.emplace_back(line.mid(line_head.length(), len));
+            out.emplace(line.mid(line_head.length(), len));
             hit_count++;
         }
 
         Log::info(log_tag, LOGMSG("Found `%1`, %2 entries loaded").arg(file_path, QString::number(hit_count)));
     }
 
+    if (!cache_path.isEmpty() && !write_blacklist_cache(cache_path, stamps, out))
+        Log::warning(log_tag, LOGMSG("Failed to write the MAME blacklist cache file `%1`").arg(cache_path));
+
     return out;
 }
 
+QString mame_blacklist_cache_path()
+{
+    return QDir(paths::writableCacheDir()).absoluteFilePath(QStringLiteral("es2-mame-blacklist.bin"));
+}
+
 size_t find_games_for(
     const SystemEntry& sysentry,
     SearchContext& sctx,
-    const std::vector<QString>& filename_blacklist)
+    const MameBlacklist& filename_blacklist)
 {
     model::Collection& collection = *sctx.get_or_create_collection(sysentry.name);
     collection
@@ -146,7 +254,7 @@ size_t find_games_for(
             QFileInfo fileinfo = files_it.fileInfo();
 
             const QString filename = fileinfo.completeBaseName();
-            if (use_blacklist && VEC_CONTAINS(filename_blacklist, filename))
+            if (use_blacklist && filename_blacklist.count(filename))
                 continue;
 
             QString path = ::clean_abs_path(fileinfo);
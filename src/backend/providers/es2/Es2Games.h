@@ -17,7 +17,10 @@
 
 #pragma once
 
+#include "utils/HashMap.h"
+
 #include <QString>
+#include <unordered_set>
 #include <vector>
 
 namespace model { class Game; }
@@ -28,8 +31,14 @@ namespace providers { namespace es2 { struct SystemEntry; } }
 namespace providers {
 namespace es2 {
 
-std::vector<QString> read_mame_blacklists(const QString&, const std::vector<QString>&);
-size_t find_games_for(const SystemEntry&, SearchContext&, const std::vector<QString>&);
+/// The file names of the MAME BIOS and device sets, which are not games
+using MameBlacklist = std::unordered_set<QString>;
+
+/// If a cache path is set, the lists are also saved there in binary form,
+/// and read back from it until the source files change
+MameBlacklist read_mame_blacklists(const QString&, const std::vector<QString>&, const QString& cache_path = QString());
+QString mame_blacklist_cache_path();
+size_t find_games_for(const SystemEntry&, SearchContext&, const MameBlacklist&);
 
 } // namespace es2
 } // namespace providers
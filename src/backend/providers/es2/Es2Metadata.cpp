@@ -182,10 +182,10 @@ void Metadata::process_gamelist_xml(const QDir& xml_dir, QXmlStreamReader& xml,
         // get the Game, if exists, and apply the properties
 
         const QFileInfo finfo = shell_to_finfo(xml_dir, shell_filepath);
-        if (AppSettings::general.verify_files && !finfo.exists())
+        const QString filepath = ::clean_abs_path(finfo);
+        if (AppSettings::general.verify_files && !sctx.files().exists(filepath))
             continue;
 
-        const QString filepath = ::clean_abs_path(finfo);
         model::GameFile* const entry_ptr = sctx.gamefile_by_filepath(filepath);
         if (!entry_ptr)  // ie. the file was not picked up by the system's extension list
             continue;
@@ -64,7 +64,7 @@ Provider& Es2Provider::run(SearchContext& sctx)
     float progress = 0.f;
 
     // Load MAME blacklist, if exists
-    const std::vector<QString> mame_blacklist = read_mame_blacklists(display_name(), possible_config_dirs);
+    const MameBlacklist mame_blacklist = read_mame_blacklists(display_name(), possible_config_dirs, mame_blacklist_cache_path());
 
     // Find games
     for (const SystemEntry& sysentry : systems) {
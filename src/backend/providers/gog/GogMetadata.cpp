@@ -163,16 +163,15 @@ void Metadata::fill_from_network(const QString& gogid, model::Game& game, Search
     };
 
     // TODO: C++17
-    model::Game* const game_ptr = &game;
     QString log_tag = m_log_tag;
     QString json_cache_dir = m_json_cache_dir;
     for (const auto& triplet : requests) {
         const QString json_suffix = std::get<1>(triplet);
         const JsonCallback& json_callback = std::get<2>(triplet);
-        sctx.schedule_download(std::get<0>(triplet), [log_tag, json_cache_dir, gogid, game_ptr, json_suffix, json_callback](QNetworkReply* const reply){
+        sctx.schedule_download(std::get<0>(triplet), game, [log_tag, json_cache_dir, gogid, json_suffix, json_callback](QNetworkReply* const reply, model::Game& target){
             if (reply->error()) {
                 Log::warning(log_tag, LOGMSG("Downloading metadata for `%1` failed: %2")
-                    .arg(game_ptr->title(), reply->errorString()));
+                    .arg(target.title(), reply->errorString()));
                 return;
             }
 
@@ -182,11 +181,11 @@ void Metadata::fill_from_network(const QString& gogid, model::Game& game, Search
                 Log::warning(log_tag, LOGMSG(
                        "Failed to parse the response of the server for game '%1', "
                        "either it's no longer available from the GOG Store or the GOG API has changed"
-                   ).arg(game_ptr->title()));
+                   ).arg(target.title()));
                 return;
             }
 
-            const bool success = json_callback(gogid, *game_ptr, json);
+            const bool success = json_callback(gogid, target, json);
             if (success) {
                 const QString json_name = gogid + json_suffix;
                 providers::cache_json(log_tag, json_cache_dir, json_name, json.toJson(QJsonDocument::Compact));
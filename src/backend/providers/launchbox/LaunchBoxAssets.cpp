@@ -19,9 +19,11 @@
 
 #include "model/gaming/Assets.h"
 #include "model/gaming/Game.h"
+#include "providers/MediaWalker.h"
+#include "utils/PathTools.h"
 
-#include <QDirIterator>
 #include <QStringBuilder>
+#include <algorithm>
 
 
 namespace {
@@ -91,18 +93,39 @@ void Assets::find_assets_for(const QString& platform_name, const std::vector<mod
 {
     const HashMap<QString, model::Game*> esctitle_to_game_map = build_escaped_title_map(games);
 
-    const QString images_root = m_lb_root_path % QLatin1String("Images/") % platform_name % QLatin1Char('/');
-    // TODO: C++17
-    for (const auto& assetdir_pair : m_dir_list) {
-        const QString assetdir_path = images_root + assetdir_pair.first;
-        const AssetType assetdir_type = assetdir_pair.second;
-        find_assets_in(assetdir_path, assetdir_type, esctitle_to_game_map);
+    // a single walk for all image dirs, matched by their name
+    // in the case the file system compares them
+    HashMap<QString, size_t> assetdir_to_index;
+    for (size_t i = 0; i < m_dir_list.size(); i++)
+        assetdir_to_index.emplace(::fs_name_key(m_dir_list[i].first), i);
+
+    const QString images_root = m_lb_root_path % QLatin1String("Images/") % platform_name;
+    std::vector<std::pair<size_t, const MediaFile*>> image_files;
+    const std::vector<MediaFile> all_image_files = walk_media_dir(images_root);
+    for (const MediaFile& file : all_image_files) {
+        const QStringRef rel_dir = file.rel_dir();
+        const int slash_pos = rel_dir.indexOf(QLatin1Char('/'));
+        const QStringRef assetdir_name = slash_pos < 0 ? rel_dir : rel_dir.left(slash_pos);
+
+        const auto it = assetdir_to_index.find(::fs_name_key(assetdir_name.toString()));
+        if (it != assetdir_to_index.cend())
+            image_files.emplace_back(it->second, &file);
     }
 
-    const QString music_root = m_lb_root_path % QLatin1String("Music/") % platform_name % QLatin1Char('/');
+    // keep the priority order of the dir list
+    std::stable_sort(image_files.begin(), image_files.end(),
+        [](const std::pair<size_t, const MediaFile*>& a, const std::pair<size_t, const MediaFile*>& b){
+            return a.first < b.first;
+        });
+    for (const auto& entry : image_files) {
+        const MediaFile& file = *entry.second;
+        add_asset(file.path, file.complete_basename().toString(), m_dir_list[entry.first].second, esctitle_to_game_map);
+    }
+
+    const QString music_root = m_lb_root_path % QLatin1String("Music/") % platform_name;
     find_assets_in(music_root, AssetType::MUSIC, esctitle_to_game_map);
 
-    const QString video_root = m_lb_root_path % QLatin1String("Videos/") % platform_name % QLatin1Char('/');
+    const QString video_root = m_lb_root_path % QLatin1String("Videos/") % platform_name;
     find_assets_in(video_root, AssetType::VIDEO, esctitle_to_game_map);
 }
 
@@ -111,26 +134,27 @@ void Assets::find_assets_in(
     const AssetType asset_type,
     const HashMap<QString, model::Game*>& title_to_game_map) const
 {
-    constexpr auto FIND_ONLY_FILES = QDir::Files | QDir::Readable | QDir::NoDotAndDotDot;
-    constexpr auto ITER_RECURSIVE = QDirIterator::Subdirectories;
-
-    QDirIterator file_it(asset_dir, FIND_ONLY_FILES, ITER_RECURSIVE);
-    while (file_it.hasNext()) {
-        QString path = file_it.next();
-
-        const QString basename = file_it.fileInfo().completeBaseName();
-        auto it = title_to_game_map.find(basename);
-        if (it != title_to_game_map.cend())
-            it->second->assetsMut().add_file(asset_type, path);
-
-        const bool has_number_suffix = rx_number_suffix.match(basename).hasMatch();
-        const QString game_title = has_number_suffix
-            ? basename.left(basename.length() - 3) // gamename "-xx" .ext
-            : basename;
-        it = title_to_game_map.find(game_title);
-        if (it != title_to_game_map.cend())
-            it->second->assetsMut().add_file(asset_type, std::move(path));
-    }
+    for (const MediaFile& file : walk_media_dir(asset_dir))
+        add_asset(file.path, file.complete_basename().toString(), asset_type, title_to_game_map);
+}
+
+void Assets::add_asset(
+    const QString& path,
+    const QString& basename,
+    const AssetType asset_type,
+    const HashMap<QString, model::Game*>& title_to_game_map) const
+{
+    auto it = title_to_game_map.find(basename);
+    if (it != title_to_game_map.cend())
+        it->second->assetsMut().add_file(asset_type, path);
+
+    const bool has_number_suffix = rx_number_suffix.match(basename).hasMatch();
+    const QString game_title = has_number_suffix
+        ? basename.left(basename.length() - 3) // gamename "-xx" .ext
+        : basename;
+    it = title_to_game_map.find(game_title);
+    if (it != title_to_game_map.cend())
+        it->second->assetsMut().add_file(asset_type, path);
 }
 
 } // namespace launchbox
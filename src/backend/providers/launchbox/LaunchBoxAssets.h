@@ -45,6 +45,7 @@ private:
     const QRegularExpression rx_number_suffix;
 
     void find_assets_in(const QString&, const AssetType, const HashMap<QString, model::Game*>&) const;
+    void add_asset(const QString&, const QString&, const AssetType, const HashMap<QString, model::Game*>&) const;
 };
 
 } // namespace launchbox
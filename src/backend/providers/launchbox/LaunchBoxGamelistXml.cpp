@@ -275,7 +275,8 @@ bool GamelistXml::game_fields_valid(
 bool GamelistXml::app_fields_valid(
     const QString& xml_path,
     const size_t xml_linenum,
-    const HashMap<AppField, QString>& fields) const
+    const HashMap<AppField, QString>& fields,
+    SearchContext& sctx) const
 {
     const auto id_it = fields.find(AppField::ID);
     if (id_it == fields.cend()) {
@@ -295,7 +296,7 @@ bool GamelistXml::app_fields_valid(
         return false;
     }
 
-    if (AppSettings::general.verify_files && !QFileInfo::exists(path_it->second)) {
+    if (AppSettings::general.verify_files && !sctx.files().exists(path_it->second)) {
         log_xml_warning(xml_path, xml_linenum, LOGMSG("Additional application file `%1` doesn't seem to exist, entry ignored")
             .arg(::pretty_path(path_it->second)));
         return false;
@@ -427,12 +428,12 @@ std::vector<model::Game*> GamelistXml::find_games_for(
             }
             else {
                 const QFileInfo finfo(m_lb_root, game_path);
-                if (AppSettings::general.verify_files && !finfo.exists()) {
+                QString abs_path = ::clean_abs_path(finfo);
+                if (AppSettings::general.verify_files && !sctx.files().exists(abs_path)) {
                     log_xml_warning(xml_path, linenum, LOGMSG("Game file `%1` doesn't seem to exist, entry ignored").arg(::pretty_path(game_path)));
                     continue;
                 }
 
-                QString abs_path = ::clean_abs_path(finfo);
                 game_ptr = sctx.game_by_filepath(abs_path);
                 if (!game_ptr) {
                     game_ptr = sctx.create_game_for(collection);
@@ -451,7 +452,7 @@ std::vector<model::Game*> GamelistXml::find_games_for(
             const size_t linenum = xml.lineNumber();
 
             HashMap<AppField, QString> fields = read_app_node(xml);
-            if (app_fields_valid(xml_path, linenum, fields))
+            if (app_fields_valid(xml_path, linenum, fields, sctx))
                 addiapps.emplace_back(std::move(fields));
 
             continue;
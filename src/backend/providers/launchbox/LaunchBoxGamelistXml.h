@@ -54,7 +54,7 @@ private:
     HashMap<GameField, QString> read_game_node(QXmlStreamReader&) const;
     HashMap<AppField, QString> read_app_node(QXmlStreamReader&) const;
     bool game_fields_valid(const QString&, const size_t, const HashMap<GameField, QString>&, const HashMap<QString, Emulator>&) const;
-    bool app_fields_valid(const QString&, const size_t, const HashMap<AppField, QString>&) const;
+    bool app_fields_valid(const QString&, const size_t, const HashMap<AppField, QString>&, SearchContext&) const;
 };
 
 } // namespace launchbox
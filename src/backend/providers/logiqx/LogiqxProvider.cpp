@@ -165,13 +165,13 @@ void read_datfile_game_entry(
             }
 
             const QFileInfo finfo(root_dir, relpath);
-            if (AppSettings::general.verify_files && !finfo.exists()) {
+            const QString abs_path = ::clean_abs_path(finfo);
+            if (AppSettings::general.verify_files && !sctx.files().exists(abs_path)) {
                 Log::warning(log_tag, LOGMSG("The `rom` element in `%1` at line %2 refers to file `%3`, which doesn't seem to exist")
                     .arg(pretty_path, QString::number(xml.lineNumber()), ::pretty_path(finfo)));
                 continue;
             }
 
-            const QString abs_path = ::clean_abs_path(finfo);
             const auto it = std::find(rom_paths.cbegin(), rom_paths.cend(), abs_path);
             if (it != rom_paths.cend()) {
                 Log::warning(log_tag, LOGMSG("The `rom` element in `%1` at line %2 seems to be a duplicate entry, ignored")
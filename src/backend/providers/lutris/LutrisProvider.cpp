@@ -64,7 +64,7 @@ QString find_assetdir()
     return {};
 }
 
-void find_banner_for(model::Game& game, const QString& slug, const QString& base_path)
+void find_banner_for(model::Game& game, const QString& slug, const QString& base_path, providers::FileCache& files)
 {
     const std::array<QLatin1String, 2> exts {
         QLatin1String(".png"),
@@ -72,7 +72,7 @@ void find_banner_for(model::Game& game, const QString& slug, const QString& base
     };
     for (const QLatin1String& ext : exts) {
         QString path = base_path % slug % ext;
-        if (QFileInfo::exists(path)) {
+        if (files.exists(path)) {
             game.assetsMut()
                 .add_file(AssetType::UI_STEAMGRID, path)
                 .add_file(AssetType::UI_BANNER, path);
@@ -81,7 +81,7 @@ void find_banner_for(model::Game& game, const QString& slug, const QString& base
     }
 }
 
-void find_coverart_for(model::Game& game, const QString& slug, const QString& base_path)
+void find_coverart_for(model::Game& game, const QString& slug, const QString& base_path, providers::FileCache& files)
 {
     const std::array<QLatin1String, 2> exts {
         QLatin1String(".png"),
@@ -89,7 +89,7 @@ void find_coverart_for(model::Game& game, const QString& slug, const QString& ba
     };
     for (const QLatin1String& ext : exts) {
         QString path = base_path % slug % ext;
-        if (QFileInfo::exists(path)) {
+        if (files.exists(path)) {
             game.assetsMut()
                 .add_file(AssetType::BACKGROUND, path)
                 .add_file(AssetType::POSTER, path)
@@ -99,10 +99,10 @@ void find_coverart_for(model::Game& game, const QString& slug, const QString& ba
     }
 }
 
-void find_icon_for(model::Game& game, const QString& slug, const QString& base_path)
+void find_icon_for(model::Game& game, const QString& slug, const QString& base_path, providers::FileCache& files)
 {
     const QString path = base_path % slug % QLatin1String(".png");
-    if (QFileInfo::exists(path))
+    if (files.exists(path))
         game.assetsMut().add_file(AssetType::UI_TILE, path);
 }
 } // namespace
@@ -227,9 +227,9 @@ Provider& LutrisProvider::run(SearchContext& sctx)
         if (game.launchCmd().isEmpty())
             game.setLaunchCmd(QLatin1String("lutris rungameid/") + id_str);
 
-        find_banner_for(game, slug, base_path_banners);
-        find_coverart_for(game, slug, base_path_coverart);
-        find_icon_for(game, slug, base_path_icons);
+        find_banner_for(game, slug, base_path_banners, sctx.files());
+        find_coverart_for(game, slug, base_path_coverart, sctx.files());
+        find_icon_for(game, slug, base_path_icons, sctx.files());
     }
 
     return *this;
@@ -27,15 +27,82 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QSaveFile>
 #include <QTextStream>
 #include <QtConcurrent/QtConcurrent>
 
+#include <algorithm>
+
 
 namespace {
+const QLatin1String REMOVE_MARK("- ");
+constexpr size_t COMPACT_MIN_LINES = 64;
+
 QString default_db_path()
 {
     return paths::writableConfigDir() + QStringLiteral("/favorites.txt");
 }
+
+QString header_line()
+{
+    return QStringLiteral("# List of favorites, one path per line");
+}
+
+std::vector<QString> written_paths(const model::Game& game)
+{
+    const QDir config_dir(paths::writableConfigDir());
+
+    std::vector<QString> out;
+    for (const model::GameFile* const file : game.filesConst()) {
+        QString written_path;
+        if (!file->fileinfo().exists()) {
+            written_path = file->path();
+        } else {
+            const QString full_path = ::clean_abs_path(file->fileinfo());
+            written_path = AppSettings::general.portable
+                 ? config_dir.relativeFilePath(full_path)
+                 : full_path;
+        }
+        if (Q_LIKELY(!written_path.isEmpty()))
+            out.emplace_back(std::move(written_path));
+    }
+    return out;
+}
+
+bool append_lines(const QString& db_path, const QStringList& lines)
+{
+    QFile db_file(db_path);
+    if (!db_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        return false;
+
+    QTextStream db_stream(&db_file);
+    db_stream.setCodec("UTF-8");
+
+    if (db_file.size() == 0)
+        db_stream << header_line() << '\n';
+    for (const QString& line : lines)
+        db_stream << line << '\n';
+
+    db_stream.flush();
+    return db_stream.status() == QTextStream::Ok;
+}
+
+bool rewrite_file(const QString& db_path, const QStringList& entries)
+{
+    QSaveFile db_file(db_path);
+    if (!db_file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QTextStream db_stream(&db_file);
+    db_stream.setCodec("UTF-8");
+
+    db_stream << header_line() << '\n';
+    for (const QString& entry : entries)
+        db_stream << entry << '\n';
+
+    db_stream.flush();
+    return db_file.commit();
+}
 } // namespace
 
 
@@ -47,36 +114,115 @@ Favorites::Favorites(QObject* parent)
 {}
 
 Favorites::Favorites(QString db_path, QObject* parent)
-    : Provider(QLatin1String("pegasus_favorites"), QStringLiteral("Pegasus Favorites"), PROVIDER_FLAG_INTERNAL | PROVIDER_FLAG_HIDE_PROGRESS, parent)
+    : Provider(QLatin1String("pegasus_favorites"), QStringLiteral("Pegasus Favorites"), PROVIDER_FLAG_INTERNAL | PROVIDER_FLAG_HIDE_PROGRESS | PROVIDER_FLAG_DECORATOR, parent)
     , m_db_path(std::move(db_path))
+    , m_base_dir(QFileInfo(m_db_path).dir())
+    , m_next_order(0)
+    , m_file_lines(0)
+    , m_loaded(false)
+    , m_compact_pending(false)
+    , m_writing(false)
 {}
 
-Provider& Favorites::run(SearchContext& sctx)
+QString Favorites::entry_key(const QString& line) const
+{
+    return ::clean_abs_path(QFileInfo(m_base_dir, line));
+}
+
+void Favorites::load_entries()
 {
+    m_entries.clear();
+    m_next_order = 0;
+    m_file_lines = 0;
+    m_loaded = true;
+
     if (!QFileInfo::exists(m_db_path))
-        return *this;
+        return;
 
     QFile db_file(m_db_path);
     if (!db_file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         Log::error(display_name(), LOGMSG("Could not open `%1` for reading, favorites not loaded").arg(m_db_path));
-        return *this;
+        return;
     }
 
-    const QDir base_dir = QFileInfo(m_db_path).dir();
-
     QTextStream db_stream(&db_file);
     db_stream.setCodec("UTF-8");
 
     QString line;
     while (db_stream.readLineInto(&line)) {
-        if (line.startsWith('#'))
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        m_file_lines++;
+
+        if (line.startsWith(REMOVE_MARK)) {
+            const QString removed_line = line.mid(REMOVE_MARK.size());
+            const auto it = m_entries.find(entry_key(removed_line));
+            if (it != m_entries.end()) {
+                it->second.lines.removeAll(removed_line);
+                if (it->second.lines.isEmpty())
+                    m_entries.erase(it);
+            }
             continue;
+        }
+
+        const auto result = m_entries.emplace(entry_key(line), Entry { m_next_order, {} });
+        if (result.second)
+            m_next_order++;
+        if (!result.first->second.lines.contains(line))
+            result.first->second.lines.append(line);
+    }
+}
+
+bool Favorites::needs_compaction() const
+{
+    return m_file_lines > COMPACT_MIN_LINES
+        && m_file_lines > m_entries.size() * 2;
+}
+
+QStringList Favorites::sorted_entries() const
+{
+    std::vector<const Entry*> ordered;
+    ordered.reserve(m_entries.size());
+    for (const auto& entry : m_entries)
+        ordered.emplace_back(&entry.second);
+
+    std::sort(ordered.begin(), ordered.end(),
+        [](const Entry* const a, const Entry* const b){
+            return a->order < b->order;
+        });
+
+    QStringList out;
+    out.reserve(static_cast<int>(ordered.size()));
+    for (const Entry* const entry : ordered)
+        out << entry->lines;
+    return out;
+}
+
+Provider& Favorites::run(SearchContext& sctx)
+{
+    // The lock is only held while reading the entries, so changing
+    // a favorite on the main thread doesn't wait for the whole scan
+    std::vector<std::pair<QString, QString>> lines; // line -> resolved path
+    {
+        const QMutexLocker lock(&m_task_guard);
+
+        // While a write is in progress, the in-memory state is the newer one
+        if (!m_writing)
+            load_entries();
 
-        model::Game* game_ptr = sctx.game_by_uri(line);
-        if (!game_ptr) {
-            const QString path = ::clean_abs_path(QFileInfo(base_dir, line));
-            game_ptr = sctx.game_by_filepath(path);
+        lines.reserve(m_entries.size());
+        for (const auto& entry : m_entries) {
+            for (const QString& line : entry.second.lines)
+                lines.emplace_back(line, entry.first);
         }
+    }
+
+    for (const auto& line : lines) {
+
+        model::Game* game_ptr = sctx.game_by_uri(line.first);
+        if (!game_ptr)
+            game_ptr = sctx.game_by_filepath(line.second);
 
         if (game_ptr)
             game_ptr->setFavorite(true);
@@ -85,67 +231,83 @@ Provider& Favorites::run(SearchContext& sctx)
     return *this;
 }
 
-void Favorites::onGameFavoriteChanged(const std::vector<model::Game*>& game_list)
+void Favorites::onGameFavoriteChanged(model::Game* const game)
 {
+    const std::vector<QString> paths = written_paths(*game);
+    const bool is_favorite = game->isFavorite();
+
     const QMutexLocker lock(&m_task_guard);
-    const QDir config_dir(paths::writableConfigDir());
+    if (!m_loaded)
+        load_entries();
 
-    m_pending_task.clear();
-    m_pending_task << QStringLiteral("# List of favorites, one path per line");
-    for (const model::Game* const game : game_list) {
-        if (game->isFavorite()) {
-            for (const model::GameFile* const file : game->filesModel()->entries()) {
-                QString written_path;
-                if (!file->fileinfo().exists()) {
-                    written_path = file->path();
-                } else {
-                    const QString full_path = ::clean_abs_path(file->fileinfo());
-                    written_path = AppSettings::general.portable
-                         ? config_dir.relativeFilePath(full_path)
-                         : full_path;
-                }
-                if (Q_LIKELY(!written_path.isEmpty()))
-                    m_pending_task << written_path;
+    bool changed = false;
+    for (const QString& path : paths) {
+        if (is_favorite) {
+            if (!m_entries.emplace(entry_key(path), Entry { m_next_order, { path } }).second)
+                continue;
 
-            }
+            m_next_order++;
+            m_pending_task << path;
+            m_file_lines++;
+        }
+        else {
+            // every line that resolves to this path has to be removed,
+            // even if it was written differently than it would be now
+            const auto it = m_entries.find(entry_key(path));
+            if (it == m_entries.end())
+                continue;
+
+            for (const QString& line : qAsConst(it->second.lines))
+                m_pending_task << (REMOVE_MARK + line);
+            m_file_lines += static_cast<size_t>(it->second.lines.size());
+            m_entries.erase(it);
         }
+        changed = true;
+    }
+    if (!changed)
+        return;
+
+    if (m_compact_pending || needs_compaction()) {
+        m_compact_pending = true;
+        m_pending_task.clear();
     }
 
-    if (m_active_task.isEmpty())
+    if (!m_writing)
         start_processing();
 }
 
 void Favorites::start_processing()
 {
-    m_active_task = m_pending_task;
-    m_pending_task.clear();
+    m_writing = true;
+    emit startedWriting();
 
     QtConcurrent::run([this]{
-        emit startedWriting();
+        QMutexLocker lock(&m_task_guard);
 
-        while (true) {
-            QFile db_file(m_db_path);
-            if (!db_file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                Log::error(display_name(), LOGMSG("Could not open `%1` for writing, favorites are not saved")
-                    .arg(m_db_path));
-                break;
-            }
+        while (m_compact_pending || !m_pending_task.isEmpty()) {
+            const bool compact = m_compact_pending;
+            const QStringList lines = compact ? sorted_entries() : m_pending_task;
+            if (compact)
+                m_file_lines = static_cast<size_t>(lines.size());
 
-            QTextStream db_stream(&db_file);
-            db_stream.setCodec("UTF-8");
-
-            for (const QString& fav : qAsConst(m_active_task))
-                db_stream << fav << Qt::endl;
+            m_pending_task.clear();
+            m_compact_pending = false;
+            lock.unlock();
 
-            QMutexLocker lock(&m_task_guard);
-            m_active_task.clear();
-            if (m_pending_task.isEmpty())
-                break;
+            const bool success = compact
+                ? rewrite_file(m_db_path, lines)
+                : append_lines(m_db_path, lines);
+            if (!success) {
+                Log::error(display_name(), LOGMSG("Could not write `%1`, favorites are not saved")
+                    .arg(m_db_path));
+            }
 
-            m_active_task = m_pending_task;
-            m_pending_task.clear();
+            lock.relock();
         }
 
+        m_writing = false;
+        lock.unlock();
+
         emit finishedWriting();
     });
 }
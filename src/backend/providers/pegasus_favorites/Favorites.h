@@ -18,7 +18,9 @@
 #pragma once
 
 #include "providers/Provider.h"
+#include "utils/HashMap.h"
 
+#include <QDir>
 #include <QMutex>
 
 
@@ -34,19 +36,40 @@ public:
 
     Provider& run(SearchContext&) final;
 
-    void onGameFavoriteChanged(const std::vector<model::Game*>&) final;
+    void onGameFavoriteChanged(model::Game* const) final;
 
 signals:
     void startedWriting();
     void finishedWriting();
 
 private:
+    struct Entry {
+        size_t order;
+        QStringList lines; // the lines as written, that resolve to the same path
+    };
+
     const QString m_db_path;
+    const QDir m_base_dir;
+
+    // The database is a journal: plain lines add a favorite, lines starting
+    // with `REMOVE_MARK` remove one. Changes are appended to the end of the
+    // file, and the whole file is rewritten only when it grows too long.
+    // The entries are keyed by their resolved path, so a game can be removed
+    // even if its line was written in a different form (eg. relative).
+    HashMap<QString, Entry> m_entries;
+    size_t m_next_order;
+    size_t m_file_lines;
+    bool m_loaded;
 
     QStringList m_pending_task;
-    QStringList m_active_task;
+    bool m_compact_pending;
+    bool m_writing;
     QMutex m_task_guard;
 
+    QString entry_key(const QString& line) const;
+    void load_entries();
+    bool needs_compaction() const;
+    QStringList sorted_entries() const;
     void start_processing();
 };
 
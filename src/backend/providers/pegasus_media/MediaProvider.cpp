@@ -22,11 +22,10 @@
 #include "model/gaming/Game.h"
 #include "model/gaming/GameFile.h"
 #include "types/AssetType.h"
+#include "providers/MediaWalker.h"
 #include "providers/SearchContext.h"
 #include "utils/PathTools.h"
 
-#include <QDir>
-#include <QDirIterator>
 #include <QFileInfo>
 #include <QStringBuilder>
 #include <QStringList>
@@ -88,13 +87,11 @@ namespace providers {
 namespace media {
 
 MediaProvider::MediaProvider(QObject* parent)
-    : Provider(QLatin1String("pegasus_media"), QStringLiteral("Pegasus Media"), PROVIDER_FLAG_CACHEABLE, parent)
+    : Provider(QLatin1String("pegasus_media"), QStringLiteral("Pegasus Media"), PROVIDER_FLAG_CACHEABLE | PROVIDER_FLAG_DECORATOR, parent)
 {}
 
 Provider& MediaProvider::run(SearchContext& sctx)
 {
-    constexpr auto dir_filters = QDir::Files | QDir::NoDotAndDotDot;
-    constexpr auto dir_flags = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
     const std::array<QLatin1String, 2> MEDIA_SUBDIRS {
         QLatin1String("/media"),
         QLatin1String("/.media"),
@@ -104,23 +101,21 @@ Provider& MediaProvider::run(SearchContext& sctx)
 
     for (const QString& dir_base : sctx.pegasus_game_dirs()) {
         for (const QLatin1String& media_subdir_name : MEDIA_SUBDIRS) {
-            const QString media_dir = dir_base % media_subdir_name;
+            for (const MediaFile& file : sctx.media_files(dir_base % media_subdir_name)) {
+                const QStringRef rel_dir = file.rel_dir();
+                QString lookup_key = dir_base;
+                if (!rel_dir.isEmpty())
+                    lookup_key += QLatin1Char('/') % rel_dir;
 
-            QDirIterator dir_it(media_dir, dir_filters, dir_flags);
-            while (dir_it.hasNext()) {
-                dir_it.next();
-                const QFileInfo fileinfo = dir_it.fileInfo();
-
-                const QString lookup_key = ::clean_abs_dir(fileinfo).remove(dir_base.length(), media_subdir_name.size());
                 const auto lookup_it = lookup_map.find(lookup_key);
                 if (lookup_it == lookup_map.cend())
                     continue;
 
-                const AssetType asset_type = detect_asset_type(fileinfo.completeBaseName(), fileinfo.suffix());
+                const AssetType asset_type = detect_asset_type(file.complete_basename().toString(), file.suffix().toString());
                 if (asset_type == AssetType::UNKNOWN)
                     continue;
 
-                lookup_it->second->assetsMut().add_file(asset_type, dir_it.filePath());
+                lookup_it->second->assetsMut().add_file(asset_type, file.path);
             }
         }
     }
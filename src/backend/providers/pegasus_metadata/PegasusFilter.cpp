@@ -67,28 +67,13 @@ std::vector<QString> resolve_filelist(const std::vector<QString>& relpaths, cons
     return found_paths;
 }
 
-bool rx_match(const QRegularExpression& rx, const QString& str) {
-    return !rx.pattern().isEmpty() && rx.match(str).hasMatch();
-}
-
-bool file_passes_filter(
-    const QFileInfo& finfo,
-    const providers::pegasus::FileFilter& filter,
-    const std::vector<QString>& exclude_files)
+// An unusable regex is treated as if it was not set
+bool prepare_regex(QRegularExpression& rx)
 {
-    const QString file_ext = finfo.suffix().toLower();
-
-    const bool exclude = VEC_CONTAINS(filter.exclude.extensions, file_ext)
-        || VEC_CONTAINS(exclude_files, ::clean_abs_path(finfo))
-        || rx_match(filter.exclude.regex, finfo.filePath());
-    if (exclude)
-        return false;
-
-    const bool include = VEC_CONTAINS(filter.include.extensions, file_ext)
-        || rx_match(filter.include.regex, finfo.filePath());
-    if (!include)
+    if (rx.pattern().isEmpty() || !rx.isValid())
         return false;
 
+    rx.optimize();
     return true;
 }
 
@@ -122,6 +107,38 @@ FileFilter::FileFilter(model::Collection* const collection_ptr, QString base_dir
     Q_ASSERT(!directories.front().isEmpty());
 }
 
+CompiledFilter::CompiledFilter(const FileFilter& filter)
+    : m_include_exts(filter.include.extensions.cbegin(), filter.include.extensions.cend())
+    , m_exclude_exts(filter.exclude.extensions.cbegin(), filter.exclude.extensions.cend())
+    , m_include_rx(filter.include.regex)
+    , m_exclude_rx(filter.exclude.regex)
+    , m_has_include_rx(prepare_regex(m_include_rx))
+    , m_has_exclude_rx(prepare_regex(m_exclude_rx))
+{
+    std::vector<QString> exclude_files = resolve_filelist(filter.exclude.files, filter.directories);
+    m_exclude_files.reserve(exclude_files.size());
+    for (QString& path : exclude_files)
+        m_exclude_files.emplace(std::move(path));
+
+    m_include_files = resolve_filelist(filter.include.files, filter.directories);
+    VEC_REMOVE_IF(m_include_files, [this](const QString& path){ return m_exclude_files.count(path) > 0; });
+}
+
+bool CompiledFilter::passes(const QFileInfo& finfo, const QString& clean_path) const
+{
+    const QString file_ext = finfo.suffix().toLower();
+
+    const bool exclude = m_exclude_exts.count(file_ext)
+        || m_exclude_files.count(clean_path)
+        || (m_has_exclude_rx && m_exclude_rx.match(finfo.filePath()).hasMatch());
+    if (exclude)
+        return false;
+
+    const bool include = m_include_exts.count(file_ext)
+        || (m_has_include_rx && m_include_rx.match(finfo.filePath()).hasMatch());
+    return include;
+}
+
 void apply_filter(FileFilter& filter, SearchContext& sctx)
 {
     VEC_REMOVE_DUPLICATES(filter.directories);
@@ -133,19 +150,14 @@ void apply_filter(FileFilter& filter, SearchContext& sctx)
     Q_ASSERT(filter.collection);
     model::Collection& collection = *filter.collection;
 
-    const std::vector<QString> include_files = resolve_filelist(filter.include.files, filter.directories);
-    const std::vector<QString> exclude_files = resolve_filelist(filter.exclude.files, filter.directories);
-    for (const QString& filepath: include_files) {
-        if (VEC_CONTAINS(exclude_files, filepath))
-            continue;
-        if (AppSettings::general.verify_files && !AppSettings::general.show_missing_games && !QFileInfo::exists(filepath))
+    const CompiledFilter compiled(filter);
+    for (const QString& filepath: compiled.include_files()) {
+        if (AppSettings::general.verify_files && !AppSettings::general.show_missing_games && !sctx.files().exists(filepath))
             continue;
         accept_filtered_file(filepath, collection, sctx);
     }
 
-    const bool has_valid_regex = !filter.include.regex.pattern().isEmpty() && filter.include.regex.isValid();
-    const bool needs_scan = !filter.include.extensions.empty() || has_valid_regex;
-    if (!needs_scan)
+    if (!compiled.needs_scan())
         return;
 
     constexpr auto entry_filters_files = QDir::Files | QDir::NoDotAndDotDot;
@@ -159,7 +171,7 @@ void apply_filter(FileFilter& filter, SearchContext& sctx)
         while (file_it.hasNext()) {
             file_it.next();
             const QString path = ::clean_abs_path(file_it.fileInfo());
-            if (file_passes_filter(file_it.fileInfo(), filter, exclude_files))
+            if (compiled.passes(file_it.fileInfo(), path))
                 accept_filtered_file(path, collection, sctx);
         }
 
@@ -170,7 +182,7 @@ void apply_filter(FileFilter& filter, SearchContext& sctx)
             while (subdir_it.hasNext()) {
                 subdir_it.next();
                 const QString path = ::clean_abs_path(subdir_it.fileInfo());
-                if (file_passes_filter(subdir_it.fileInfo(), filter, exclude_files))
+                if (compiled.passes(subdir_it.fileInfo(), path))
                     accept_filtered_file(path, collection, sctx);
             }
         }
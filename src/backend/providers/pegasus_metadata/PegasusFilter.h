@@ -17,11 +17,15 @@
 
 #pragma once
 
+#include "utils/HashMap.h"
 #include "utils/MoveOnly.h"
 
 #include <QRegularExpression>
+#include <unordered_set>
 #include <vector>
 
+class QFileInfo;
+
 namespace model { class Collection; }
 namespace providers { class SearchContext; }
 
@@ -49,6 +53,31 @@ struct FileFilter {
     MOVE_ONLY(FileFilter)
 };
 
+/// The lookup structures of a filter, built once before matching files
+class CompiledFilter {
+public:
+    explicit CompiledFilter(const FileFilter&);
+    MOVE_ONLY(CompiledFilter)
+
+    /// The explicitly listed files that are not excluded, as clean absolute paths
+    const std::vector<QString>& include_files() const { return m_include_files; }
+    /// True if files can be matched by their extension or path
+    bool needs_scan() const { return !m_include_exts.empty() || m_has_include_rx; }
+    /// Takes the file and its clean absolute path
+    bool passes(const QFileInfo&, const QString&) const;
+
+private:
+    std::unordered_set<QString> m_include_exts;
+    std::unordered_set<QString> m_exclude_exts;
+    std::unordered_set<QString> m_exclude_files;
+    std::vector<QString> m_include_files;
+
+    QRegularExpression m_include_rx;
+    QRegularExpression m_exclude_rx;
+    bool m_has_include_rx;
+    bool m_has_exclude_rx;
+};
+
 void apply_filter(FileFilter&, SearchContext&);
 
 } // namespace pegasus
@@ -202,6 +202,16 @@ void Metadata::replace_newlines(QString& text) const
         .replace(QLatin1String(R"(\\n)"), QLatin1String(R"(\n)"));  // '\\n' -> '\n'
 }
 
+QFileInfo Metadata::file_info(ParserState& ps, const QString& line) const
+{
+    if (ps.file_infos) {
+        const auto it = ps.file_infos->find(line);
+        if (it != ps.file_infos->cend())
+            return it->second;
+    }
+    return QFileInfo(ps.dir, line);
+}
+
 void Metadata::apply_collection_entry(ParserState& ps, const metafile::Entry& entry) const
 {
     Q_ASSERT(ps.cur_coll);
@@ -231,7 +241,7 @@ void Metadata::apply_collection_entry(ParserState& ps, const metafile::Entry& en
             break;
         case CollAttrib::DIRECTORIES:
             for (const QString& line : entry.values) {
-                const QFileInfo finfo(ps.dir, line);
+                const QFileInfo finfo = file_info(ps, line);
                 if (!finfo.isDir()) {
                     print_warning(ps, entry, LOGMSG("Directory path `%1` doesn't seem to exist").arg(::pretty_path(finfo)));
                     continue;
@@ -315,8 +325,8 @@ void Metadata::apply_game_entry(ParserState& ps, const metafile::Entry& entry, S
                     sctx.game_add_uri(*ps.cur_game, line);
                 }
                 else {
-                    QFileInfo finfo(ps.dir, line);
-                    if (AppSettings::general.verify_files && !finfo.exists()) {
+                    const QFileInfo finfo = file_info(ps, line);
+                    if (AppSettings::general.verify_files && !ps.files->exists(finfo.absoluteFilePath())) {
                         print_warning(ps, entry, LOGMSG("Game file `%1` doesn't seem to exist").arg(::pretty_path(finfo)));
                         ps.cur_game->setMissing(true);
                         if (!AppSettings::general.show_missing_games)
@@ -464,8 +474,8 @@ QString Metadata::assetline_to_url(ParserState& ps, const metafile::Entry& entry
     if (value.startsWith(QLatin1String("http://")) || value.startsWith(QLatin1String("https://")))
         return value;
 
-    const QFileInfo finfo(ps.dir, value);
-    if (AppSettings::general.verify_files && !finfo.exists()) {
+    const QFileInfo finfo = file_info(ps, value);
+    if (AppSettings::general.verify_files && !ps.files->exists(finfo.absoluteFilePath())) {
         print_warning(ps, entry, LOGMSG("Asset file `%1` doesn't seem to exist").arg(finfo.absoluteFilePath()));
         return QString();
     }
@@ -548,18 +558,71 @@ void Metadata::apply_entry(ParserState& ps, const metafile::Entry& entry, Search
 
 std::vector<FileFilter> Metadata::apply_metafile(const QString& metafile_path, SearchContext& sctx) const
 {
-    ParserState ps(metafile_path);
+    MetafileRecords metafile;
+    metafile.path = metafile_path;
+    read_metafile(metafile);
+    return apply_metafile(metafile, sctx);
+}
+
+void Metadata::read_metafile(MetafileRecords& metafile) const
+{
+    const QDir dir = QFileInfo(metafile.path).absoluteDir();
+    bool in_game = false;
+
+    // The directory checks are slow, and QFileInfo caches the results,
+    // so those are done here in advance. Game and asset files are checked
+    // later through the file cache of the search context.
+    const auto query_files = [&](const metafile::Entry& entry){
+        const bool is_dir_list = !in_game && (entry.key == QLatin1String("directory") || entry.key == QLatin1String("directories"));
+        if (!is_dir_list)
+            return;
+
+        for (const QString& line : entry.values) {
+            if (line.isEmpty() || metafile.file_infos.count(line) || rx_uri.match(line).hasMatch())
+                continue;
+
+            QFileInfo finfo(dir, line);
+            finfo.exists();
+            metafile.file_infos.emplace(line, std::move(finfo));
+        }
+    };
 
     const auto on_error = [&](const metafile::Error& error){
-        print_error(ps, error);
+        metafile.records.push_back({ metafile::Entry { error.line, {}, {} }, error.message });
     };
-    const auto on_entry = [&](const metafile::Entry& entry){
-        apply_entry(ps, entry, sctx);
+    const auto on_entry = [&](const metafile::EntryView& entry_view){
+        metafile::Entry entry {0, {}, {}};
+        entry_view.copy_to(entry);
+
+        if (entry.key == m_primary_key_collection)
+            in_game = false;
+        else if (entry.key == m_primary_key_game)
+            in_game = true;
+        else
+            query_files(entry);
+
+        metafile.records.push_back({ std::move(entry), QString() });
     };
 
-    if (!metafile::read_file(metafile_path, on_entry, on_error)) {
+    metafile.readable = metafile::read_mapped_file(metafile.path, on_entry, on_error);
+}
+
+std::vector<FileFilter> Metadata::apply_metafile(const MetafileRecords& metafile, SearchContext& sctx) const
+{
+    ParserState ps(metafile.path);
+    ps.file_infos = &metafile.file_infos;
+    ps.files = &sctx.files();
+
+    for (const MetafileRecords::Record& record : metafile.records) {
+        if (record.error.isEmpty())
+            apply_entry(ps, record.entry, sctx);
+        else
+            print_error(ps, { record.entry.line, record.error });
+    }
+
+    if (!metafile.readable) {
         Log::error(m_log_tag, LOGMSG("Failed to read metadata file `%1`")
-            .arg(::pretty_path(metafile_path)));
+            .arg(::pretty_path(metafile.path)));
     }
     if (ps.found_issues > ISSUE_LOG_LIMIT) {
         Log::warning(m_log_tag, LOGMSG("%1 other issues omitted").arg(QString::number(ps.found_issues - ISSUE_LOG_LIMIT)));
@@ -17,17 +17,18 @@
 
 #pragma once
 
+#include "parsers/MetaFile.h"
 #include "utils/HashMap.h"
 #include "utils/NoCopyNoMove.h"
 
 #include <QDir>
+#include <QFileInfo>
 #include <QString>
 #include <QRegularExpression>
 
-namespace metafile { struct Entry; }
-namespace metafile { struct Error; }
 namespace model { class Game; }
 namespace model { class Collection; }
+namespace providers { class FileCache; }
 namespace providers { class SearchContext; }
 
 
@@ -39,9 +40,27 @@ enum class GameAttrib : unsigned char;
 struct FileFilter;
 
 
+/// The contents of a metafile, read without touching the search context,
+/// so multiple files can be read in parallel
+struct MetafileRecords {
+    struct Record {
+        metafile::Entry entry;
+        QString error; // if set, a parser error on the line of the entry
+    };
+
+    QString path;
+    bool readable = false;
+    std::vector<Record> records;
+    // The directories mentioned, with their details already queried
+    HashMap<QString, QFileInfo> file_infos;
+};
+
+
 struct ParserState {
     const QString& path;
     const QDir dir;
+    const HashMap<QString, QFileInfo>* file_infos = nullptr;
+    FileCache* files = nullptr;
     model::Game* cur_game = nullptr;
     model::Collection* cur_coll = nullptr;
     std::vector<FileFilter> filters;
@@ -59,6 +78,11 @@ public:
 
     std::vector<FileFilter> apply_metafile(const QString&, SearchContext&) const;
 
+    /// The parallel part of applying a metafile
+    void read_metafile(MetafileRecords&) const;
+    /// The serialized part, should be called in the original file order
+    std::vector<FileFilter> apply_metafile(const MetafileRecords&, SearchContext&) const;
+
 private:
     const QString m_log_tag;
 
@@ -83,6 +107,7 @@ private:
 
     const QString& first_line_of(ParserState&, const metafile::Entry&) const;
     void replace_newlines(QString&) const;
+    QFileInfo file_info(ParserState&, const QString&) const;
 
     void apply_collection_entry(ParserState&, const metafile::Entry&) const;
     void apply_game_entry(ParserState&, const metafile::Entry&, SearchContext&) const;
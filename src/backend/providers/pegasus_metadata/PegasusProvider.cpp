@@ -26,6 +26,8 @@
 #include "utils/StdHelpers.h"
 
 #include <QDirIterator>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
 
 
 namespace {
@@ -56,10 +58,13 @@ std::vector<QString> find_metafiles_in(const QString& dir_path)
     return result;
 }
 
-std::vector<QString> find_all_metafiles(const QStringList& gamedirs)
+std::vector<QString> find_all_metafiles(const QStringList& gamedirs, bool include_global)
 {
-    const QString global_metafile_dir = paths::writableConfigDir() + QLatin1String("/metafiles");
-    std::vector<QString> result = find_metafiles_in(global_metafile_dir);
+    std::vector<QString> result;
+    if (include_global) {
+        const QString global_metafile_dir = paths::writableConfigDir() + QLatin1String("/metafiles");
+        result = find_metafiles_in(global_metafile_dir);
+    }
 
     result.reserve(result.size() + gamedirs.size());
     for (const QString& dir_path : gamedirs) {
@@ -79,12 +84,12 @@ namespace providers {
 namespace pegasus {
 
 PegasusProvider::PegasusProvider(QObject* parent)
-    : Provider(QLatin1String("pegasus_metafiles"), QStringLiteral("Pegasus Metafiles"), PROVIDER_FLAG_INTERNAL | PROVIDER_FLAG_CACHEABLE, parent)
+    : Provider(QLatin1String("pegasus_metafiles"), QStringLiteral("Pegasus Metafiles"), PROVIDER_FLAG_INTERNAL | PROVIDER_FLAG_CACHEABLE | PROVIDER_FLAG_GAMEDIR_SCOPED, parent)
 {}
 
 Provider& PegasusProvider::run(SearchContext& sctx)
 {
-    const std::vector<QString> metafile_paths = find_all_metafiles(sctx.root_game_dirs());
+    const std::vector<QString> metafile_paths = find_all_metafiles(sctx.root_game_dirs(), !sctx.is_partial_scan());
     if (metafile_paths.empty()) {
         Log::info(display_name(), LOGMSG("No metadata files found"));
         return *this;
@@ -93,13 +98,41 @@ Provider& PegasusProvider::run(SearchContext& sctx)
     const Metadata metahelper(display_name());
     std::vector<FileFilter> all_filters;
 
+    // The files are read in parallel, but applied one by one in the original order,
+    // as soon as they are ready, to keep the results deterministic
+    std::vector<MetafileRecords> metafiles(metafile_paths.size());
+    std::vector<QFuture<void>> read_futures;
+    read_futures.reserve(metafile_paths.size());
+    for (size_t i = 0; i < metafile_paths.size(); i++) {
+        MetafileRecords& metafile = metafiles[i];
+        metafile.path = metafile_paths[i];
+        read_futures.emplace_back(QtConcurrent::run([&metahelper, &metafile]{
+            metahelper.read_metafile(metafile);
+        }));
+    }
+
     const float progress_step = 1.f / metafile_paths.size();
     float progress = 0.f;
 
-    for (const QString& path : metafile_paths) {
+    for (size_t i = 0; i < metafiles.size(); i++) {
+        const QString& path = metafile_paths[i];
         Log::info(display_name(), LOGMSG("Found `%1`").arg(::pretty_path(path)));
 
-        std::vector<FileFilter> filters = metahelper.apply_metafile(path, sctx);
+        read_futures[i].waitForFinished();
+        std::vector<FileFilter> filters = metahelper.apply_metafile(metafiles[i], sctx);
+        metafiles[i] = MetafileRecords();
+
+        // Used for rescanning only the changed game dirs later
+        const QString metafile_dir = QFileInfo(path).path();
+        const QString source_dir = sctx.root_game_dirs().contains(metafile_dir) ? metafile_dir : QString();
+        for (const FileFilter& filter : filters) {
+            sctx.collection_add_source_dir(*filter.collection, source_dir);
+            if (!source_dir.isEmpty()) {
+                for (const QString& dir_path : filter.directories)
+                    sctx.source_add_game_dir(source_dir, dir_path);
+            }
+        }
+
         all_filters.insert(all_filters.end(),
             std::make_move_iterator(filters.begin()),
             std::make_move_iterator(filters.end()));
@@ -22,6 +22,8 @@
 #include "model/gaming/Game.h"
 #include "model/gaming/GameFile.h"
 #include "providers/SearchContext.h"
+#include "utils/HashMap.h"
+#include "utils/NoCopyNoMove.h"
 #include "utils/PathTools.h"
 #include "utils/SqliteDb.h"
 
@@ -29,6 +31,7 @@
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QVersionNumber>
 #include <QtConcurrent/QtConcurrent>
 
 
@@ -51,10 +54,47 @@ void on_create_table_fail(const QString& log_tag, QSqlQuery& query)
     print_query_error(log_tag, query);
 }
 
+QString play_summary_select(const QString& where_clause)
+{
+    return QStringLiteral(
+        "SELECT path_id"
+        ", COUNT(*) AS play_count"
+        ", SUM(MAX(duration, 0)) AS total_duration"
+        ", MAX(start_time + MAX(duration, 0)) AS last_played"
+        " FROM plays%1"
+        " GROUP BY path_id"
+    ).arg(where_clause);
+}
+
+// Recalculates the summary of one path, or all paths if `path_id` is -1
+bool exec_play_summary_rebuild(QSqlQuery& query, int path_id = -1)
+{
+    if (path_id == -1) {
+        query.prepare(QStringLiteral("INSERT OR REPLACE INTO play_summary ")
+            + play_summary_select(QString()) + QLatin1Char(';'));
+    }
+    else {
+        query.prepare(QStringLiteral("INSERT OR REPLACE INTO play_summary ")
+            + play_summary_select(QStringLiteral(" WHERE path_id = ?")) + QLatin1Char(';'));
+        query.addBindValue(path_id);
+    }
+    return query.exec();
+}
+
+bool rebuild_play_summary(const QString& log_tag, QSqlDatabase& db, int path_id = -1)
+{
+    QSqlQuery query(db);
+    if (!exec_play_summary_rebuild(query, path_id)) {
+        print_query_error(log_tag, query);
+        return false;
+    }
+    return true;
+}
+
 bool create_missing_tables(const QString& log_tag, SqliteDb& channel)
 {
     if (!channel.hasTable(QStringLiteral("paths"))) {
-        QSqlQuery query;
+        QSqlQuery query(channel.database());
         query.prepare(QStringLiteral(
             "CREATE TABLE paths"
               "(" "id INTEGER PRIMARY KEY"
@@ -67,7 +107,7 @@ bool create_missing_tables(const QString& log_tag, SqliteDb& channel)
         }
     }
     if (!channel.hasTable(QStringLiteral("plays"))) {
-        QSqlQuery query;
+        QSqlQuery query(channel.database());
         query.prepare(QStringLiteral(
             "CREATE TABLE plays"
               "(" "id INTEGER PRIMARY KEY"
@@ -81,69 +121,47 @@ bool create_missing_tables(const QString& log_tag, SqliteDb& channel)
             return false;
         }
     }
-
-    return true;
-}
-
-int get_path_id(const QString& log_tag, const QString& game_key, bool insert_on_missing = true)
-{
     {
-        QSqlQuery query;
-        query.prepare(QStringLiteral("SELECT id FROM paths WHERE path = ?;"));
-        query.addBindValue(game_key);
+        // `paths.path` is already indexed by its UNIQUE constraint
+        QSqlQuery query(channel.database());
+        query.prepare(QStringLiteral("CREATE INDEX IF NOT EXISTS plays_path_id ON plays(path_id);"));
         if (!query.exec()) {
-            print_query_error(log_tag, query);
-            return -1;
+            on_create_table_fail(log_tag, query);
+            return false;
         }
-        if (query.next())
-            return query.value(0).toInt();
     }
-    // no hit -> insert
-    if (insert_on_missing) {
-        QSqlQuery query;
-        query.prepare(QStringLiteral("INSERT INTO paths VALUES(null, ?);"));
-        query.addBindValue(game_key);
+    if (!channel.hasTable(QStringLiteral("play_summary"))) {
+        QSqlQuery query(channel.database());
+        query.prepare(QStringLiteral(
+            "CREATE TABLE play_summary"
+              "(" "path_id INTEGER PRIMARY KEY REFERENCES paths(id)"
+              "," "play_count INTEGER NOT NULL"
+              "," "total_duration INTEGER NOT NULL"
+              "," "last_played INTEGER NOT NULL"
+            ");"
+        ));
         if (!query.exec()) {
-            print_query_error(log_tag, query);
-            return -1;
+            on_create_table_fail(log_tag, query);
+            return false;
         }
-    }
-    if (insert_on_missing) {
-        QSqlQuery query;
-        query.prepare(QStringLiteral("SELECT last_insert_rowid() FROM paths;"));
-        if (!query.exec()) {
-            print_query_error(log_tag, query);
-            return -1;
+        // one-time migration from the play history
+        QSqlQuery rebuild_query(channel.database());
+        if (!exec_play_summary_rebuild(rebuild_query)) {
+            on_create_table_fail(log_tag, rebuild_query);
+            return false;
         }
-        if (query.next())
-            return query.value(0).toInt();
     }
 
-    return -1;
-}
-
-void save_play_entry(const QString& log_tag, const int path_id, const QDateTime& start_time, const qint64 duration)
-{
-    Q_ASSERT(path_id != -1);
-    Q_ASSERT(start_time.isValid());
-    Q_ASSERT(0 <= duration);
-
-    QSqlQuery query;
-    query.prepare(QStringLiteral("INSERT INTO plays VALUES(null, ?, ?, ?);"));
-    query.addBindValue(path_id);
-    query.addBindValue(start_time.toSecsSinceEpoch());
-    query.addBindValue(duration);
-    if (!query.exec())
-        print_query_error(log_tag, query);
+    return true;
 }
 
-void migrate_play_entry(const QString& log_tag, int old_path_id, int new_path_id)
+void migrate_play_entry(const QString& log_tag, QSqlDatabase& db, int old_path_id, int new_path_id)
 {
     Q_ASSERT(old_path_id != -1);
     Q_ASSERT(new_path_id != -1);
 
     // update plays to use new path
-    QSqlQuery update_plays_query;
+    QSqlQuery update_plays_query(db);
     update_plays_query.prepare(QStringLiteral("UPDATE plays SET path_id = ? WHERE path_id = ?;"));
     update_plays_query.addBindValue(new_path_id);
     update_plays_query.addBindValue(old_path_id);
@@ -153,11 +171,23 @@ void migrate_play_entry(const QString& log_tag, int old_path_id, int new_path_id
     }
 
     // delete old path
-    QSqlQuery delete_path_query;
+    QSqlQuery delete_path_query(db);
     delete_path_query.prepare(QStringLiteral("DELETE FROM paths WHERE id = ?;"));
     delete_path_query.addBindValue(old_path_id);
-    if (!delete_path_query.exec())
+    if (!delete_path_query.exec()) {
         print_query_error(log_tag, delete_path_query);
+        return;
+    }
+
+    // merge the summaries
+    QSqlQuery delete_summary_query(db);
+    delete_summary_query.prepare(QStringLiteral("DELETE FROM play_summary WHERE path_id = ?;"));
+    delete_summary_query.addBindValue(old_path_id);
+    if (!delete_summary_query.exec()) {
+        print_query_error(log_tag, delete_summary_query);
+        return;
+    }
+    rebuild_play_summary(log_tag, db, new_path_id);
 }
 
 void update_modelgame(model::GameFile* const gamefile, const QDateTime& start_time, const qint64 duration)
@@ -172,14 +202,213 @@ void update_modelgame(model::GameFile* const gamefile, const QDateTime& start_ti
 namespace providers {
 namespace playtime {
 
+// Keeps the database connection and the frequently used statements between
+// writes. Must be created, used and destroyed in the same thread.
+class PlaytimeWriter {
+public:
+    PlaytimeWriter(const QString& db_path, const QString& connection_name, QString log_tag);
+    NO_COPY_NO_MOVE(PlaytimeWriter)
+
+    bool open();
+
+    bool begin() { return m_channel.startTransaction(); }
+    void add_play(const QString& path, const QDateTime& start_time, qint64 duration);
+    void migrate(const QString& old_path, const QString& new_path);
+    bool commit();
+
+private:
+    SqliteDb m_channel;
+    const QString m_log_tag;
+
+    bool m_has_returning;
+    QSqlQuery m_select_path;
+    QSqlQuery m_insert_path;
+    QSqlQuery m_insert_play;
+    QSqlQuery m_update_summary;
+    QSqlQuery m_insert_summary;
+
+    HashMap<QString, int> m_path_ids;
+
+    bool prepare(QSqlQuery& query, const QString& sql);
+    bool exec(QSqlQuery& query);
+    int path_id(const QString& path, bool insert_on_missing = true);
+};
+
+PlaytimeWriter::PlaytimeWriter(const QString& db_path, const QString& connection_name, QString log_tag)
+    : m_channel(db_path, connection_name)
+    , m_log_tag(std::move(log_tag))
+    , m_has_returning(false)
+{}
+
+bool PlaytimeWriter::prepare(QSqlQuery& query, const QString& sql)
+{
+    query = QSqlQuery(m_channel.database());
+    if (!query.prepare(sql)) {
+        print_query_error(m_log_tag, query);
+        return false;
+    }
+    return true;
+}
+
+bool PlaytimeWriter::exec(QSqlQuery& query)
+{
+    const bool success = query.exec();
+    if (!success)
+        print_query_error(m_log_tag, query);
+    return success;
+}
+
+bool PlaytimeWriter::open()
+{
+    if (!m_channel.open())
+        return false;
+
+    // Readers are not blocked by the writer, and commits are cheaper
+    QSqlQuery pragma_query(m_channel.database());
+    if (!pragma_query.exec(QStringLiteral("PRAGMA journal_mode=WAL;")))
+        print_query_error(m_log_tag, pragma_query);
+    if (!pragma_query.exec(QStringLiteral("PRAGMA synchronous=NORMAL;")))
+        print_query_error(m_log_tag, pragma_query);
+
+    m_channel.startTransaction();
+    if (!create_missing_tables(m_log_tag, m_channel)) {
+        m_channel.rollback();
+        return false;
+    }
+    m_channel.commit();
+
+    // `RETURNING` requires SQLite 3.35
+    QSqlQuery version_query(m_channel.database());
+    if (version_query.exec(QStringLiteral("SELECT sqlite_version();")) && version_query.next()) {
+        const QVersionNumber version = QVersionNumber::fromString(version_query.value(0).toString());
+        m_has_returning = QVersionNumber(3, 35) <= version;
+    }
+
+    const QString insert_path_sql = m_has_returning
+        ? QStringLiteral(
+            "INSERT INTO paths VALUES(null, ?)"
+            " ON CONFLICT(path) DO UPDATE SET path = excluded.path"
+            " RETURNING id;")
+        : QStringLiteral("INSERT OR IGNORE INTO paths VALUES(null, ?);");
+
+    return prepare(m_select_path, QStringLiteral("SELECT id FROM paths WHERE path = ?;"))
+        && prepare(m_insert_path, insert_path_sql)
+        && prepare(m_insert_play, QStringLiteral("INSERT INTO plays VALUES(null, ?, ?, ?);"))
+        && prepare(m_update_summary, QStringLiteral(
+            "UPDATE play_summary"
+            " SET play_count = play_count + 1"
+            ", total_duration = total_duration + ?"
+            ", last_played = MAX(last_played, ?)"
+            " WHERE path_id = ?;"))
+        && prepare(m_insert_summary, QStringLiteral("INSERT INTO play_summary VALUES(?, 1, ?, ?);"));
+}
+
+int PlaytimeWriter::path_id(const QString& path, bool insert_on_missing)
+{
+    const auto it = m_path_ids.find(path);
+    if (it != m_path_ids.cend())
+        return it->second;
+
+    int id = -1;
+    if (insert_on_missing && m_has_returning) {
+        m_insert_path.addBindValue(path);
+        if (exec(m_insert_path) && m_insert_path.next())
+            id = m_insert_path.value(0).toInt();
+        m_insert_path.finish();
+    }
+    else {
+        if (insert_on_missing) {
+            m_insert_path.addBindValue(path);
+            exec(m_insert_path);
+        }
+        m_select_path.addBindValue(path);
+        if (exec(m_select_path) && m_select_path.next())
+            id = m_select_path.value(0).toInt();
+        m_select_path.finish();
+    }
+
+    if (id != -1)
+        m_path_ids.emplace(path, id);
+    return id;
+}
+
+void PlaytimeWriter::add_play(const QString& path, const QDateTime& start_time, const qint64 duration)
+{
+    Q_ASSERT(start_time.isValid());
+    Q_ASSERT(0 <= duration);
+
+    const int id = path_id(path);
+    if (id == -1)
+        return;
+
+    const qint64 start_epoch = start_time.toSecsSinceEpoch();
+    const qint64 end_epoch = start_epoch + duration;
+
+    m_insert_play.addBindValue(id);
+    m_insert_play.addBindValue(start_epoch);
+    m_insert_play.addBindValue(duration);
+    if (!exec(m_insert_play))
+        return;
+
+    m_update_summary.addBindValue(duration);
+    m_update_summary.addBindValue(end_epoch);
+    m_update_summary.addBindValue(id);
+    if (!exec(m_update_summary) || m_update_summary.numRowsAffected() > 0)
+        return;
+
+    // first play of this path
+    m_insert_summary.addBindValue(id);
+    m_insert_summary.addBindValue(duration);
+    m_insert_summary.addBindValue(end_epoch);
+    exec(m_insert_summary);
+}
+
+void PlaytimeWriter::migrate(const QString& old_path, const QString& new_path)
+{
+    const int old_path_id = path_id(old_path, false);
+    // no path ID to migrate
+    if (old_path_id == -1)
+        return;
+
+    const int new_path_id = path_id(new_path);
+    if (new_path_id == -1)
+        return;
+
+    Log::info(LOGMSG("Migrating playtime stats for '%1'.").arg(new_path));
+    migrate_play_entry(m_log_tag, m_channel.database(), old_path_id, new_path_id);
+    m_path_ids.erase(old_path);
+}
+
+bool PlaytimeWriter::commit()
+{
+    if (m_channel.commit())
+        return true;
+
+    // ids inserted in this transaction are gone
+    m_channel.rollback();
+    m_path_ids.clear();
+    return false;
+}
+
+
 PlaytimeStats::PlaytimeStats(QObject* parent)
     : PlaytimeStats(default_db_path(), parent)
 {}
 
 PlaytimeStats::PlaytimeStats(QString db_path, QObject* parent)
-    : Provider(QLatin1String("pegasus_playtime"), QStringLiteral("Pegasus Playtime"), PROVIDER_FLAG_INTERNAL | PROVIDER_FLAG_HIDE_PROGRESS, parent)
+    : Provider(QLatin1String("pegasus_playtime"), QStringLiteral("Pegasus Playtime"), PROVIDER_FLAG_INTERNAL | PROVIDER_FLAG_HIDE_PROGRESS | PROVIDER_FLAG_DECORATOR, parent)
     , m_db_path(std::move(db_path))
-{}
+{
+    // A single, non-expiring thread, so the writer's connection can stay open
+    m_write_thread.setMaxThreadCount(1);
+    m_write_thread.setExpiryTimeout(-1);
+}
+
+PlaytimeStats::~PlaytimeStats()
+{
+    // The connection has to be closed in the thread that opened it
+    QtConcurrent::run(&m_write_thread, [this]{ m_writer.reset(); }).waitForFinished();
+}
 
 Provider& PlaytimeStats::run(SearchContext& sctx)
 {
@@ -196,13 +425,27 @@ Provider& PlaytimeStats::run(SearchContext& sctx)
     if (!channel.hasTable(QStringLiteral("paths")) || !channel.hasTable(QStringLiteral("plays")))
         return *this;
 
+    // Databases created by older versions have no summary yet
+    if (!channel.hasTable(QStringLiteral("play_summary"))) {
+        Log::info(display_name(), LOGMSG("Creating play time summary, this may take a while"));
+        channel.startTransaction();
+        if (create_missing_tables(display_name(), channel))
+            channel.commit();
+        else
+            channel.rollback();
+    }
 
-    QSqlQuery query;
+    // If the summary could not be created (eg. read-only file), aggregate the history in place
+    const QString summary_source = channel.hasTable(QStringLiteral("play_summary"))
+        ? QStringLiteral("play_summary")
+        : QLatin1Char('(') + play_summary_select(QString()) + QLatin1Char(')');
+
+    QSqlQuery query(channel.database());
     query.prepare(QStringLiteral(
-        "SELECT paths.path, plays.start_time, plays.duration"
-        " FROM plays"
-        " INNER JOIN paths ON plays.path_id=paths.id;"
-    ));
+        "SELECT paths.path, summary.play_count, summary.total_duration, summary.last_played"
+        " FROM %1 AS summary"
+        " INNER JOIN paths ON summary.path_id=paths.id;"
+    ).arg(summary_source));
     if (!query.exec()) {
         print_query_error(display_name(), query);
         return *this;
@@ -230,13 +473,16 @@ Provider& PlaytimeStats::run(SearchContext& sctx)
         if (!game_ptr)
             continue;
 
-        const qint64 start_epoch = query.value(1).toLongLong();
-        const qint64 duration = query.value(2).toLongLong();
+        const int playcount = query.value(1).toInt();
+        const qint64 playtime = query.value(2).toLongLong();
+        const QDateTime last_played = QDateTime::fromSecsSinceEpoch(query.value(3).toLongLong());
 
+        // a game may have rows both by path and by URI
         Stats& stats = stat_map[game_ptr];
-        stats.last_played = QDateTime::fromSecsSinceEpoch(start_epoch + duration);
-        stats.playtime += std::max(static_cast<qint64>(0), duration);
-        stats.playcount++;
+        if (!stats.last_played.isValid() || stats.last_played < last_played)
+            stats.last_played = last_played;
+        stats.playtime += playtime;
+        stats.playcount += playcount;
     }
 
     // trigger update only once
@@ -267,8 +513,10 @@ void PlaytimeStats::onGameFinished(model::GameFile* const gamefile)
 
     QMutexLocker lock(&m_queue_guard);
 
+    // The clock may have been changed while playing, the summary
+    // rebuilt from the play history clamps the durations the same way
     const auto now = QDateTime::currentDateTimeUtc();
-    const auto duration = m_last_launch_time.secsTo(now);
+    const auto duration = qMax<qint64>(m_last_launch_time.secsTo(now), 0);
 
     m_pending_tasks.emplace_back(
         gamefile,
@@ -287,56 +535,51 @@ void PlaytimeStats::start_processing()
     m_active_tasks.swap(m_pending_tasks);
     m_active_migrations.swap(m_pending_migrations);
 
-    QtConcurrent::run([this]{
+    QtConcurrent::run(&m_write_thread, [this]{
         emit startedWriting();
 
         while (!m_active_tasks.empty() || !m_active_migrations.empty()) {
             for (const QueueEntry& entry : m_active_tasks)
                 update_modelgame(entry.gamefile, entry.launch_time, entry.duration);
 
-            SqliteDb channel(m_db_path);
-            if (!channel.open()) {
-                Log::warning(display_name(), LOGMSG("Could not open or create `%1`, play time will not be saved")
-                    .arg(m_db_path));
-                break;
+            if (!m_writer) {
+                const QString connection_name = QStringLiteral("pegasus_playtime_")
+                    + QString::number(reinterpret_cast<quintptr>(this), 16);
+                m_writer.reset(new PlaytimeWriter(m_db_path, connection_name, display_name()));
+                if (!m_writer->open()) {
+                    Log::warning(display_name(), LOGMSG("Could not open or create `%1`, play time will not be saved")
+                        .arg(m_db_path));
+                    m_writer.reset();
+                }
             }
 
-            channel.startTransaction();
-
-            if (!create_missing_tables(display_name(), channel)) {
-                channel.rollback();
-                break;
+            // everything queued so far goes into one transaction
+            if (m_writer && !m_writer->begin()) {
+                Log::warning(display_name(), LOGMSG("Could not start writing `%1`, play time will not be saved")
+                    .arg(m_db_path));
+                // the connection is opened again for the next task
+                m_writer.reset();
             }
 
-            for (const QueueEntry& entry : m_active_tasks) {
-                const QString path = entry.gamefile->hasUri()
-                    ? entry.gamefile->uri()
-                    : ::clean_abs_path(entry.gamefile->fileinfo());
-                const int path_id = get_path_id(display_name(), path);
-                if (path_id >= 0)
-                    save_play_entry(display_name(), path_id, entry.launch_time, entry.duration);
-            }
+            if (m_writer) {
+                for (const QueueEntry& entry : m_active_tasks) {
+                    const QString path = entry.gamefile->hasUri()
+                        ? entry.gamefile->uri()
+                        : ::clean_abs_path(entry.gamefile->fileinfo());
+                    m_writer->add_play(path, entry.launch_time, entry.duration);
+                }
+
+                for (const MigrationQueueEntry& entry : m_active_migrations) {
+                    // we don't have a uri to migrate??
+                    if (!entry.gamefile->hasUri())
+                        continue;
 
-            for (const MigrationQueueEntry& entry : m_active_migrations) {
-                // we don't have a uri to migrate??
-                if (!entry.gamefile->hasUri())
-                    continue;
-                const QString uri = entry.gamefile->uri();
-
-                const QString path = ::clean_abs_path(entry.gamefile->fileinfo());
-                const int old_path_id = get_path_id(display_name(), path, false);
-                // no path ID to migrate
-                if (old_path_id == -1)
-                    continue;
-
-                const int new_path_id = get_path_id(display_name(), uri);
-                if (new_path_id >= 0) {
-                    Log::info(LOGMSG("Migrating playtime stats for '%1'.").arg(uri));
-                    migrate_play_entry(display_name(), old_path_id, new_path_id);
+                    m_writer->migrate(::clean_abs_path(entry.gamefile->fileinfo()), entry.gamefile->uri());
                 }
-            }
 
-            channel.commit();
+                if (!m_writer->commit())
+                    Log::warning(display_name(), LOGMSG("Failed to save play time to `%1`").arg(m_db_path));
+            }
 
             // pick up new tasks
             QMutexLocker lock(&m_queue_guard);
@@ -21,17 +21,22 @@
 
 #include <QDateTime>
 #include <QMutex>
+#include <QThreadPool>
+#include <memory>
 
 
 namespace providers {
 namespace playtime {
 
+class PlaytimeWriter;
+
 class PlaytimeStats : public Provider {
     Q_OBJECT
 
 public:
     explicit PlaytimeStats(QString db_path, QObject* parent = nullptr);
     explicit PlaytimeStats(QObject* parent = nullptr);
+    ~PlaytimeStats();
 
     Provider& run(SearchContext&) final;
 
@@ -73,6 +78,9 @@ private:
 
     QMutex m_queue_guard;
 
+    QThreadPool m_write_thread;
+    std::unique_ptr<PlaytimeWriter> m_writer; // used only in m_write_thread
+
     void start_processing();
 };
 
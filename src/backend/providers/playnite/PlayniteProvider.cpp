@@ -63,7 +63,8 @@ void apply_game_fields(
     model::Game& game,
     const PlayniteComponents& components,
     const PlayniteGame& game_info,
-    const QDir& playnite_dir)
+    const QDir& playnite_dir,
+    FileCache& files)
 {
     game.setTitle(game_info.name);
 
@@ -117,12 +118,12 @@ void apply_game_fields(
 
     const QString extra_metadata_path = QStringLiteral("%1/ExtraMetadata/games/%2").arg(playnite_dir_path, game_info.id);
     const QFileInfo logo_file(extra_metadata_path + QStringLiteral("/Logo.png"));
-    if (logo_file.exists() && logo_file.isFile()) {
+    if (files.is_file(logo_file.absoluteFilePath())) {
         game.assetsMut().add_file(AssetType::LOGO, logo_file.absoluteFilePath());
     }
 
     const QFileInfo video_trailer(extra_metadata_path + QStringLiteral("/VideoTrailer.mp4"));
-    if (video_trailer.exists() && video_trailer.isFile()) {
+    if (files.is_file(video_trailer.absoluteFilePath())) {
         game.assetsMut().add_file(AssetType::VIDEO, video_trailer.absoluteFilePath());
     }
 }
@@ -206,7 +207,7 @@ std::vector<model::Game*> PlayniteProvider::create_games(const QString& playnite
 
         game_ptr->setLaunchCmd(launch_info.launch_cmd);
         game_ptr->setLaunchWorkdir(launch_info.working_dir);
-        apply_game_fields(*game_ptr, components, game_info, playnite_dir);
+        apply_game_fields(*game_ptr, components, game_info, playnite_dir, sctx.files());
         sctx.game_add_to(*game_ptr, collection);
         output.emplace_back(game_ptr);
 
@@ -4,6 +4,9 @@ HEADERS += \
     $$PWD/ProviderUtils.h \
     $$PWD/SearchContext.h \
     $$PWD/GameDataCache.h \
+    $$PWD/LibraryWatcher.h \
+    $$PWD/MediaWalker.h \
+    $$PWD/FileCache.h \
 
 SOURCES += \
     $$PWD/Provider.cpp \
@@ -11,6 +14,9 @@ SOURCES += \
     $$PWD/ProviderUtils.cpp \
     $$PWD/SearchContext.cpp \
     $$PWD/GameDataCache.cpp \
+    $$PWD/LibraryWatcher.cpp \
+    $$PWD/MediaWalker.cpp \
+    $$PWD/FileCache.cpp \
 
 include(pegasus_favorites/pegasus_favorites.pri)
 include(pegasus_metadata/pegasus_metadata.pri)
@@ -21,11 +21,12 @@
 #include "model/gaming/Assets.h"
 #include "model/gaming/Game.h"
 #include "model/gaming/GameFile.h"
+#include "providers/MediaWalker.h"
 #include "providers/SearchContext.h"
 #include "utils/PathTools.h"
 
-#include <QDirIterator>
 #include <QStringBuilder>
+#include <algorithm>
 #include <array>
 
 
@@ -43,6 +44,13 @@ HashMap<QString, model::Game*> build_gamepath_db(const HashMap<QString, model::G
 
     return map;
 }
+
+struct AssetMatch {
+    int priority;
+    model::Game* game;
+    AssetType type;
+    const QString* path;
+};
 } // namespace
 
 
@@ -50,7 +58,7 @@ namespace providers {
 namespace skraper {
 
 SkraperAssetsProvider::SkraperAssetsProvider(QObject* parent)
-    : Provider(QLatin1String("skraper"), QStringLiteral("Skraper Assets"), PROVIDER_FLAG_CACHEABLE, parent)
+    : Provider(QLatin1String("skraper"), QStringLiteral("Skraper Assets"), PROVIDER_FLAG_CACHEABLE | PROVIDER_FLAG_DECORATOR, parent)
 {}
 
 Provider& SkraperAssetsProvider::run(SearchContext& sctx)
@@ -100,50 +108,59 @@ Provider& SkraperAssetsProvider::run(SearchContext& sctx)
         }},
     };
 
-    const std::array<QString, 3> MEDIA_DIRS {
-        QStringLiteral("/skraper/"),
-        QStringLiteral("/media/"),
-        QStringLiteral("/.media/"),
-    };
+    // The asset dir names with their type and priority, in the case the file system compares them
+    HashMap<QString, std::pair<AssetType, int>> asset_dir_map;
+    // TODO: C++17
+    for (const auto& asset_dir_entry : ASSET_DIRS) {
+        const QStringList& dir_names = asset_dir_entry.second;
+        for (int i = 0; i < dir_names.size(); i++)
+            asset_dir_map.emplace(::fs_name_key(dir_names.at(i)), std::make_pair(asset_dir_entry.first, i));
+    }
 
-    constexpr auto DIR_FILTERS = QDir::Files | QDir::Readable | QDir::NoDotAndDotDot;
-    constexpr auto DIR_FLAGS = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
+    const std::array<QLatin1String, 3> MEDIA_DIRS {
+        QLatin1String("/skraper"),
+        QLatin1String("/media"),
+        QLatin1String("/.media"),
+    };
 
 
     const HashMap<QString, model::Game*> extless_path_to_game = build_gamepath_db(sctx.current_filepath_to_entry_map());
 
     size_t found_assets_cnt = 0;
+    std::vector<AssetMatch> matches;
     for (const QString& root_dir : sctx.pegasus_game_dirs()) {
-        for (const QString& media_dir_subpath : MEDIA_DIRS) {
-            const QString game_media_dir = root_dir % media_dir_subpath;
-            if (!QFileInfo::exists(game_media_dir))
-                continue;
-
-            // TODO: C++17
-            for (const auto& asset_dir_entry : ASSET_DIRS) {
-                const AssetType asset_type = asset_dir_entry.first;
-                const QStringList& dir_names = asset_dir_entry.second;
-                for (const QString& dir_name : dir_names) {
-                    const QString search_dir = game_media_dir % dir_name;
-                    const int subpath_len = media_dir_subpath.length() + dir_name.length();
-
-                    QDirIterator dir_it(search_dir, DIR_FILTERS, DIR_FLAGS);
-                    while (dir_it.hasNext()) {
-                        dir_it.next();
-                        const QFileInfo finfo = dir_it.fileInfo();
-
-                        const QString game_path = ::clean_abs_dir(finfo).remove(root_dir.length(), subpath_len)
-                                                % '/' % finfo.completeBaseName();
-                        const auto it = extless_path_to_game.find(game_path);
-                        if (it == extless_path_to_game.cend())
-                            continue;
-
-                        model::Game& game = *(it->second);
-                        game.assetsMut().add_file(asset_type, dir_it.filePath());
-                        found_assets_cnt++;
-                    }
-                }
+        for (const QLatin1String& media_dir_subpath : MEDIA_DIRS) {
+            // the media dir is walked only once, the first component of
+            // the relative path selects the asset type
+            for (const MediaFile& file : sctx.media_files(root_dir % media_dir_subpath)) {
+                const QStringRef rel_dir = file.rel_dir();
+                const int slash_pos = rel_dir.indexOf(QLatin1Char('/'));
+                const QStringRef asset_dir_name = slash_pos < 0 ? rel_dir : rel_dir.left(slash_pos);
+
+                const auto asset_dir_it = asset_dir_map.find(::fs_name_key(asset_dir_name.toString()));
+                if (asset_dir_it == asset_dir_map.cend())
+                    continue;
+
+                QString game_path = root_dir;
+                if (slash_pos >= 0)
+                    game_path += QLatin1Char('/') % rel_dir.mid(slash_pos + 1);
+                game_path += QLatin1Char('/') % file.complete_basename();
+
+                const auto it = extless_path_to_game.find(game_path);
+                if (it == extless_path_to_game.cend())
+                    continue;
+
+                matches.push_back({ asset_dir_it->second.second, it->second, asset_dir_it->second.first, &file.path });
             }
+
+            // keep the priority order of the dir names
+            std::stable_sort(matches.begin(), matches.end(),
+                [](const AssetMatch& a, const AssetMatch& b){ return a.priority < b.priority; });
+            for (const AssetMatch& match : matches)
+                match.game->assetsMut().add_file(match.type, *match.path);
+
+            found_assets_cnt += matches.size();
+            matches.clear();
         }
     }
 
@@ -177,13 +177,12 @@ void Metadata::fill_from_network(const QString& appid, model::Game& game, Search
     if (Q_UNLIKELY(!url.isValid()))
         return;
 
-    model::Game* const game_ptr = &game;
     QString log_tag = m_log_tag;
     QString json_cache_dir = m_json_cache_dir;
-    sctx.schedule_download(url, [appid, game_ptr, log_tag, json_cache_dir](QNetworkReply* const reply){
+    sctx.schedule_download(url, game, [appid, log_tag, json_cache_dir](QNetworkReply* const reply, model::Game& target){
         if (reply->error()) {
             Log::warning(log_tag, LOGMSG("Downloading metadata for `%1` failed: %2")
-                .arg(game_ptr->title(), reply->errorString()));
+                .arg(target.title(), reply->errorString()));
             return;
         }
 
@@ -193,11 +192,11 @@ void Metadata::fill_from_network(const QString& appid, model::Game& game, Search
             Log::warning(log_tag, LOGMSG(
                    "Failed to parse the response of the server for game '%1', "
                    "either it's no longer available from the Steam Store or the Steam API has changed"
-               ).arg(game_ptr->title()));
+               ).arg(target.title()));
             return;
         }
 
-        const bool success = apply_json(*game_ptr, json);
+        const bool success = apply_json(target, json);
         if (success)
             providers::cache_json(log_tag, json_cache_dir, appid, json.toJson(QJsonDocument::Compact));
     });
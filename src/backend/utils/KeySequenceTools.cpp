@@ -53,23 +53,28 @@ int keymods_to_int(const Qt::KeyboardModifiers keymods)
 
 
 namespace utils {
-QKeySequence qmlevent_to_keyseq(const QVariant& event_variant)
+int qmlevent_to_keycode(const QVariant& event_variant)
 {
     static constexpr auto QML_KEYEVENT_CLASSNAME = "QQuickKeyEvent";
 
     const QObject* const event_qobj = event_variant.value<QObject*>();
     if (!event_qobj)
-        return {};
+        return 0;
 
     const char* const event_qobj_class = event_qobj->metaObject()->className();
     if (::strcmp(event_qobj_class, QML_KEYEVENT_CLASSNAME) != 0)
-        return {};
+        return 0;
 
     const QKeyEvent& event = static_cast<const FakeQKeyEvent*>(event_qobj)->event;
     if (is_modifier(event.key()))
-        return {};
+        return 0;
+
+    return event.key() | keymods_to_int(event.modifiers());
+}
 
-    const int keyseq_key = event.key() | keymods_to_int(event.modifiers());
-    return QKeySequence(keyseq_key);
+QKeySequence qmlevent_to_keyseq(const QVariant& event_variant)
+{
+    const int keycode = qmlevent_to_keycode(event_variant);
+    return keycode ? QKeySequence(keycode) : QKeySequence();
 }
 } // namespace utils
@@ -23,4 +23,6 @@
 
 namespace utils {
 QKeySequence qmlevent_to_keyseq(const QVariant&);
+/// The key code of the event combined with its modifiers, or 0 if it's not a usable key event
+int qmlevent_to_keycode(const QVariant&);
 } // namespace utils
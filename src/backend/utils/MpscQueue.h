@@ -0,0 +1,106 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2021  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "utils/NoCopyNoMove.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+
+namespace utils {
+/// A fixed size, lock-free queue for passing items from any number of
+/// producer threads to exactly one consumer thread
+template<typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+public:
+    MpscQueue() : m_head(0), m_tail(0) {
+        for (size_t i = 0; i < Capacity; i++)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    NO_COPY_NO_MOVE(MpscQueue)
+
+    /// Producer side; returns false if the queue is full
+    bool push(T&& item) {
+        Cell* cell = nullptr;
+        size_t tail = m_tail.value.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &m_cells[tail & (Capacity - 1)];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            if (seq == tail) {
+                // the cell is free, try to claim it
+                if (m_tail.value.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (seq < tail) {
+                // the cell still holds an item from the previous round
+                return false;
+            }
+            else {
+                tail = m_tail.value.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->item = std::move(item);
+        cell->sequence.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer side; returns false if there is no item ready
+    bool pop(T& out) {
+        const size_t head = m_head.value.load(std::memory_order_relaxed);
+        Cell& cell = m_cells[head & (Capacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != head + 1)
+            return false;
+
+        out = std::move(cell.item);
+        cell.item = T();
+        cell.sequence.store(head + Capacity, std::memory_order_release);
+        m_head.value.store(head + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Consumer side
+    bool empty() const {
+        const size_t head = m_head.value.load(std::memory_order_relaxed);
+        return m_cells[head & (Capacity - 1)].sequence.load(std::memory_order_acquire) != head + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    // padded apart, as they are written by different threads
+    struct PaddedIndex {
+        std::atomic<size_t> value;
+        char padding[64 - sizeof(std::atomic<size_t>)];
+
+        explicit PaddedIndex(size_t val) : value(val) {}
+    };
+
+    std::array<Cell, Capacity> m_cells;
+    PaddedIndex m_head;
+    PaddedIndex m_tail;
+};
+} // namespace utils
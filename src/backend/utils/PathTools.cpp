@@ -40,3 +40,11 @@ QString pretty_dir(const QFileInfo& finfo) {
 QString pretty_path(const QString& path) {
     return QDir::toNativeSeparators(QDir::cleanPath(path));
 }
+
+QString fs_name_key(const QString& name) {
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
+    return name.toLower();
+#else
+    return name;
+#endif
+}
@@ -30,6 +30,9 @@ QString pretty_path(const QFileInfo&);
 QString pretty_dir(const QFileInfo&);
 /// Returns a displayable path
 QString pretty_path(const QString&);
+/// Returns the name as the file system compares it; the default file systems
+/// of Windows and macOS ignore the case, so there it's lowercased
+QString fs_name_key(const QString&);
 
 template <typename T>
 void pretty_dir(T) = delete;
@@ -0,0 +1,73 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2021  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "utils/NoCopyNoMove.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+
+namespace utils {
+/// A fixed size, lock-free queue for passing items from exactly one
+/// producer thread to exactly one consumer thread
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+public:
+    SpscQueue() : m_head(0), m_tail(0) {}
+    NO_COPY_NO_MOVE(SpscQueue)
+
+    /// Producer side; returns false if the queue is full
+    bool push(const T& item) {
+        const size_t tail = m_tail.value.load(std::memory_order_relaxed);
+        if (tail - m_head.value.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        m_items[tail & (Capacity - 1)] = item;
+        m_tail.value.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer side; returns false if the queue is empty
+    bool pop(T& out) {
+        const size_t head = m_head.value.load(std::memory_order_relaxed);
+        if (head == m_tail.value.load(std::memory_order_acquire))
+            return false;
+
+        out = m_items[head & (Capacity - 1)];
+        m_head.value.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // padded apart, as they are written by different threads
+    struct PaddedIndex {
+        std::atomic<size_t> value;
+        char padding[64 - sizeof(std::atomic<size_t>)];
+
+        explicit PaddedIndex(size_t val) : value(val) {}
+    };
+
+    std::array<T, Capacity> m_items;
+    PaddedIndex m_head;
+    PaddedIndex m_tail;
+};
+} // namespace utils
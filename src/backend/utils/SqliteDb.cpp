@@ -26,12 +26,17 @@ SqliteDb::SqliteDb(const QString& db_path)
     m_db.setDatabaseName(db_path);
 }
 
-SqliteDb::~SqliteDb()
+SqliteDb::SqliteDb(const QString& db_path, const QString& connection_name)
+    : m_db(QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connection_name))
 {
-    if (!m_db.isOpen())
-        return;
+    m_db.setDatabaseName(db_path);
+}
 
-    m_db.rollback();
+SqliteDb::~SqliteDb()
+{
+    // the connection was added by the constructor, even if opening it failed later
+    if (m_db.isOpen())
+        m_db.rollback();
 
     const auto connection = m_db.connectionName();
     m_db = QSqlDatabase();
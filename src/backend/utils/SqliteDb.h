@@ -28,6 +28,7 @@ class QString;
 class SqliteDb {
 public:
     explicit SqliteDb(const QString& db_path);
+    SqliteDb(const QString& db_path, const QString& connection_name);
     ~SqliteDb();
 
     MOVE_ONLY(SqliteDb)
@@ -38,6 +39,7 @@ public:
     bool commit() { return m_db.commit(); }
 
     bool hasTable(const QString& table_name);
+    QSqlDatabase& database() { return m_db; }
 
 private:
     QSqlDatabase m_db;
@@ -0,0 +1,37 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2021  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "utils/HashMap.h"
+
+#include <QStringList>
+#include <unordered_set>
+
+
+namespace utils {
+/// Makes equal strings share the same implicitly shared data,
+/// so frequently repeated values are only stored once
+class StringPool {
+public:
+    void intern(QString&);
+    void intern(QStringList&);
+
+private:
+    std::unordered_set<QString> m_strings;
+};
+} // namespace utils
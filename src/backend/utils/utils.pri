@@ -6,12 +6,15 @@ HEADERS += \
     $$PWD/HashMap.h \
     $$PWD/KeySequenceTools.h \
     $$PWD/MoveOnly.h \
+    $$PWD/MpscQueue.h \
     $$PWD/NoCopyNoMove.h \
     $$PWD/PathTools.h \
     $$PWD/QmlHelpers.h \
     $$PWD/SqliteDb.h \
+    $$PWD/SpscQueue.h \
     $$PWD/StdHelpers.h \
-    $$PWD/StringHelpers.h
+    $$PWD/StringHelpers.h \
+    $$PWD/StringPool.h
 
 SOURCES += \
     $$PWD/CommandTokenizer.cpp \
@@ -21,4 +24,5 @@ SOURCES += \
     $$PWD/KeySequenceTools.cpp \
     $$PWD/PathTools.cpp \
     $$PWD/SqliteDb.cpp \
-    $$PWD/StringHelpers.cpp
+    $$PWD/StringHelpers.cpp \
+    $$PWD/StringPool.cpp
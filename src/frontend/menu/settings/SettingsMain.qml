@@ -148,6 +148,22 @@ FocusScope {
             section: "gaming"
             enabled: Internal.settings.verifyFiles
         },
+        SettingsEntry {
+            label: QT_TR_NOOP("Watch game directories")
+            desc: QT_TR_NOOP("Keep the game list up to date while Pegasus is running, by watching the game directories for changes. Only the affected directories are scanned again.")
+            type: SettingsEntry.Type.Bool
+            boolValue: Internal.settings.watchGameDirs
+            boolSetter: (val) => Internal.settings.watchGameDirs = val
+            section: "gaming"
+        },
+        SettingsEntry {
+            label: QT_TR_NOOP("Keep the theme loaded while playing")
+            desc: QT_TR_NOOP("Instead of unloading the theme when a game starts, it is only hidden and resumed when the game ends. This makes returning from games faster, but uses more memory while playing.")
+            type: SettingsEntry.Type.Bool
+            boolValue: Internal.settings.keepFrontendAlive
+            boolSetter: (val) => Internal.settings.keepFrontendAlive = val
+            section: "gaming"
+        },
         SettingsEntry {
             label: QT_TR_NOOP("Enable/disable data sources...")
             type: SettingsEntry.Type.Button
@@ -18,14 +18,111 @@
 #include <QtTest/QtTest>
 
 #include "model/Api.h"
+#include "model/gaming/GameFile.h"
+
+
+namespace {
+model::Game* create_game(const QString& title, const QString& path)
+{
+    auto* const game = new model::Game(title);
+    game->setFiles({ new model::GameFile(path, *game) });
+    return game;
+}
+
+model::Game* create_uri_game(const QString& title, const QString& uri)
+{
+    auto* const game = new model::Game(title);
+    auto* const gamefile = new model::GameFile(QString(), *game);
+    gamefile->setUri(uri);
+    game->setFiles({ gamefile });
+    return game;
+}
+} // namespace
 
 
 class test_Api : public QObject {
     Q_OBJECT
 
 private slots:
+    void patch_game_data();
+    void patch_uri_games();
 };
 
+void test_Api::patch_game_data()
+{
+    model::ApiObject api(backend::CliArgs {});
+
+    auto* const coll = new model::Collection(QStringLiteral("coll"));
+    auto* const game_a = create_game(QStringLiteral("A"), QStringLiteral("/a.bin"));
+    auto* const game_b = create_game(QStringLiteral("B"), QStringLiteral("/b.bin"));
+    coll->setGames({ game_a, game_b });
+    game_a->setCollections({ coll });
+    game_b->setCollections({ coll });
+    api.setGameData({ coll }, { game_a, game_b });
+
+    // the same collection and game A again, B replaced by C
+    auto* const new_coll = new model::Collection(QStringLiteral("coll"));
+    auto* const new_game_a = create_game(QStringLiteral("A"), QStringLiteral("/a.bin"));
+    auto* const game_c = create_game(QStringLiteral("C"), QStringLiteral("/c.bin"));
+    new_coll->setGames({ new_game_a, game_c });
+    new_game_a->setCollections({ new_coll });
+    game_c->setCollections({ new_coll });
+
+    QSignalSpy spy_reset(api.allGames(), &QAbstractItemModel::modelReset);
+    QSignalSpy spy_removed(api.allGames(), &QAbstractItemModel::rowsRemoved);
+    QSignalSpy spy_inserted(api.allGames(), &QAbstractItemModel::rowsInserted);
+    QSignalSpy spy_coll_reset(api.collections(), &QAbstractItemModel::modelReset);
+
+    LibraryPatch patch;
+    patch.old_collections = { coll };
+    patch.old_games = { game_a, game_b };
+    patch.new_collections = { new_coll };
+    patch.new_games = { new_game_a, game_c };
+    api.patchGameData(std::move(patch));
+
+    QCOMPARE(spy_reset.count(), 0);
+    QCOMPARE(spy_removed.count(), 1);
+    QCOMPARE(spy_inserted.count(), 1);
+    QCOMPARE(spy_coll_reset.count(), 0);
+
+    // unchanged entries keep their objects
+    QCOMPARE(api.allGames()->entries(), std::vector<model::Game*>({ game_a, game_c }));
+    QCOMPARE(api.collections()->entries(), std::vector<model::Collection*>({ coll }));
+    QCOMPARE(coll->gameList()->entries(), std::vector<model::Game*>({ game_a, game_c }));
+    QCOMPARE(game_c->collectionsModel()->entries(), std::vector<model::Collection*>({ coll }));
+}
+
+void test_Api::patch_uri_games()
+{
+    model::ApiObject api(backend::CliArgs {});
+
+    auto* const coll = new model::Collection(QStringLiteral("coll"));
+    auto* const game_a = create_uri_game(QStringLiteral("A"), QStringLiteral("steam:1"));
+    auto* const game_b = create_uri_game(QStringLiteral("B"), QStringLiteral("steam:2"));
+    coll->setGames({ game_a, game_b });
+    game_a->setCollections({ coll });
+    game_b->setCollections({ coll });
+    api.setGameData({ coll }, { game_a, game_b });
+
+    // games without a file path are matched by their URI
+    auto* const new_coll = new model::Collection(QStringLiteral("coll"));
+    auto* const new_game_a = create_uri_game(QStringLiteral("A"), QStringLiteral("steam:1"));
+    auto* const new_game_b = create_uri_game(QStringLiteral("B"), QStringLiteral("steam:2"));
+    new_coll->setGames({ new_game_a, new_game_b });
+    new_game_a->setCollections({ new_coll });
+    new_game_b->setCollections({ new_coll });
+
+    LibraryPatch patch;
+    patch.old_collections = { coll };
+    patch.old_games = { game_a, game_b };
+    patch.new_collections = { new_coll };
+    patch.new_games = { new_game_a, new_game_b };
+    api.patchGameData(std::move(patch));
+
+    QCOMPARE(api.allGames()->entries(), std::vector<model::Game*>({ game_a, game_b }));
+    QCOMPARE(coll->gameList()->entries(), std::vector<model::Game*>({ game_a, game_b }));
+}
+
 
 QTEST_MAIN(test_Api)
 #include "test_Api.moc"
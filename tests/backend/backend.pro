@@ -6,4 +6,5 @@ SUBDIRS += \
     model \
     processlauncher \
     providers \
+    scriptrunner \
     utils \
@@ -30,6 +30,7 @@ private slots:
     void names();
     void games();
     void sorting();
+    void patch_games();
 };
 
 void test_Collection::names()
@@ -85,6 +86,52 @@ void test_Collection::sorting()
     QCOMPARE(collections.at(3)->name(), QStringLiteral("Collection IX"));
 }
 
+void test_Collection::patch_games()
+{
+    const auto game_a = new model::Game("a", this);
+    const auto game_b = new model::Game("b", this);
+    const auto game_c = new model::Game("c", this);
+    const auto game_d = new model::Game("d", this);
+    const auto collection = new model::Collection("test", this);
+    collection->setGames({ game_a, game_b, game_c });
+
+    model::GameListModel* const games = collection->gameList();
+    QSignalSpy spy_reset(games, &QAbstractItemModel::modelReset);
+    QSignalSpy spy_removed(games, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy spy_inserted(games, &QAbstractItemModel::rowsInserted);
+    QSignalSpy spy_count(games, &model::ObjectListModel::countChanged);
+
+    // the row index is already updated when the changes are signaled
+    std::vector<int> signaled_rows;
+    connect(games, &QAbstractItemModel::rowsRemoved, this, [games, game_b, game_c, &signaled_rows]{
+        signaled_rows.push_back(games->indexOf(game_b));
+        signaled_rows.push_back(games->indexOf(game_c));
+    });
+    connect(games, &QAbstractItemModel::rowsInserted, this, [games, game_d, &signaled_rows]{
+        signaled_rows.push_back(games->indexOf(game_d));
+    });
+
+    // rows are removed and inserted without a reset
+    games->patch({ game_a, game_c, game_d });
+    QCOMPARE(spy_reset.count(), 0);
+    QCOMPARE(spy_removed.count(), 1);
+    QCOMPARE(spy_removed.at(0).at(1).toInt(), 1);
+    QCOMPARE(spy_removed.at(0).at(2).toInt(), 1);
+    QCOMPARE(spy_inserted.count(), 1);
+    QCOMPARE(spy_inserted.at(0).at(1).toInt(), 2);
+    QCOMPARE(spy_inserted.at(0).at(2).toInt(), 2);
+    QCOMPARE(spy_count.count(), 0);
+    QCOMPARE(games->entries(), std::vector<model::Game*>({ game_a, game_c, game_d }));
+    QCOMPARE(signaled_rows, std::vector<int>({ -1, 1, 2 }));
+    disconnect(games, nullptr, this, nullptr);
+
+    // a reordering of the kept entries falls back to a reset
+    games->patch({ game_d, game_a });
+    QCOMPARE(spy_reset.count(), 1);
+    QCOMPARE(spy_count.count(), 1);
+    QCOMPARE(games->entries(), std::vector<model::Game*>({ game_d, game_a }));
+}
+
 
 QTEST_MAIN(test_Collection)
 #include "test_Collection.moc"
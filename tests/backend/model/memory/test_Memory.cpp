@@ -43,6 +43,7 @@ private slots:
     void jsvalue();
 
     void settings_file();
+    void delayed_write();
 };
 
 void test_Memory::set_new()
@@ -161,6 +162,10 @@ void test_Memory::jsvalue()
     QCOMPARE(c.memory()->get("test").userType(), qMetaTypeId<QVariantMap>());
     QCOMPARE(c.memory()->get("test").value<QVariantMap>(), jsval_outer.toVariant());
 
+    // written in the background
+    QVERIFY(c.memory()->hasPendingWrites());
+    QTRY_VERIFY_WITH_TIMEOUT(!c.memory()->hasPendingWrites(), 5000);
+
     QCOMPARE(QFileInfo::exists(json_path), true);
     QFile json_file(json_path);
     json_file.open(QFile::ReadOnly);
@@ -220,6 +225,42 @@ void test_Memory::settings_file()
     json_file.remove();
 }
 
+void test_Memory::delayed_write()
+{
+    QString temp_path = QDir::tempPath();
+    if (!temp_path.endsWith('/'))
+        temp_path += '/';
+
+    const QString json_path = temp_path + "QtAutoTestDelayed.json";
+    QFile(json_path).remove();
+
+    Container c(temp_path);
+    c.memory()->changeTheme("/path/to/QtAutoTestDelayed/");
+
+    // frequent changes are written together
+    for (int i = 0; i < 100; i++)
+        c.memory()->set("index", i);
+
+    QCOMPARE(c.memory()->hasPendingWrites(), true);
+    QCOMPARE(QFileInfo::exists(json_path), false);
+
+    c.memory()->flush();
+    QCOMPARE(c.memory()->hasPendingWrites(), false);
+
+    QFile json_file(json_path);
+    QVERIFY(json_file.open(QFile::ReadOnly));
+    QCOMPARE(json_file.readAll(), QByteArrayLiteral(R"({"index":99})"));
+    json_file.close();
+
+    // removing the last value is saved too
+    c.memory()->unset("index");
+    QTRY_VERIFY_WITH_TIMEOUT(!c.memory()->hasPendingWrites(), 5000);
+
+    QVERIFY(json_file.open(QFile::ReadOnly));
+    QCOMPARE(json_file.readAll(), QByteArrayLiteral("{}"));
+    json_file.remove();
+}
+
 
 QTEST_MAIN(test_Memory)
 #include "test_Memory.moc"
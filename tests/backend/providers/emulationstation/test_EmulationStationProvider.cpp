@@ -22,8 +22,11 @@
 #include "model/gaming/Game.h"
 #include "model/gaming/Assets.h"
 #include "providers/SearchContext.h"
+#include "providers/es2/Es2Games.h"
 #include "providers/es2/Es2Provider.h"
 
+#include <QTemporaryDir>
+
 
 class test_EmulationStationProvider : public QObject {
     Q_OBJECT
@@ -36,6 +39,7 @@ private slots:
     void empty();
     void basic();
     void gamelist();
+    void mame_blacklist_cache();
 };
 
 
@@ -120,5 +124,45 @@ void test_EmulationStationProvider::gamelist()
 }
 
 
+void test_EmulationStationProvider::mame_blacklist_cache()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    QDir root(tmp_dir.path());
+    QVERIFY(root.mkpath(QStringLiteral("es/resources")));
+
+    const auto write_file = [&root](const QString& rel_path, const QByteArray& content){
+        QFile file(root.filePath(rel_path));
+        QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+        file.write(content);
+    };
+    write_file(QStringLiteral("es/resources/mamebioses.xml"),
+        "<bioses>\n<bios>neogeo</bios>\n<bios>pgm</bios>\n</bioses>\n");
+    write_file(QStringLiteral("es/resources/mamedevices.xml"),
+        "<devices>\n<device>z80</device>\n</devices>\n");
+
+    const std::vector<QString> config_dirs { root.filePath(QStringLiteral("es")) };
+    const QString cache_path = root.filePath(QStringLiteral("cache/blacklist.bin"));
+    const providers::es2::MameBlacklist expected {
+        QStringLiteral("neogeo"),
+        QStringLiteral("pgm"),
+        QStringLiteral("z80"),
+    };
+
+    QCOMPARE(providers::es2::read_mame_blacklists(QStringLiteral("ES2"), config_dirs, cache_path), expected);
+    QVERIFY(QFileInfo::exists(cache_path));
+
+    QTest::ignoreMessage(QtInfoMsg, "ES2: 3 MAME blacklist entries loaded from cache");
+    QCOMPARE(providers::es2::read_mame_blacklists(QStringLiteral("ES2"), config_dirs, cache_path), expected);
+
+    // a changed source file invalidates the cache
+    write_file(QStringLiteral("es/resources/mamedevices.xml"),
+        "<devices>\n<device>z80</device>\n<device>m68000</device>\n</devices>\n");
+    const providers::es2::MameBlacklist changed = providers::es2::read_mame_blacklists(QStringLiteral("ES2"), config_dirs, cache_path);
+    QCOMPARE(changed.size(), size_t(4));
+    QCOMPARE(changed.count(QStringLiteral("m68000")), size_t(1));
+}
+
+
 QTEST_MAIN(test_EmulationStationProvider)
 #include "test_EmulationStationProvider.moc"
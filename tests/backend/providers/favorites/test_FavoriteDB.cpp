@@ -19,6 +19,7 @@
 
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
 #include "providers/pegasus_favorites/Favorites.h"
 #include "providers/SearchContext.h"
 
@@ -41,6 +42,34 @@ void create_dummy_data(providers::SearchContext& sctx)
     model::Game& game_d = *sctx.create_game_for(collection_b);
     sctx.game_add_uri(game_d, QStringLiteral("steam:1337"));
 }
+
+QString create_db_path()
+{
+    QTemporaryFile tmp_file;
+    tmp_file.setAutoRemove(false);
+    if (!tmp_file.open())
+        return QString();
+
+    const QString db_path = tmp_file.fileName();
+    tmp_file.close();
+    return db_path;
+}
+
+QStringList read_entries(const QString& db_path)
+{
+    QFile db_file(db_path);
+    if (!db_file.open(QFile::ReadOnly | QFile::Text))
+        return {};
+
+    QTextStream db_stream(&db_file);
+    QStringList found_items;
+    QString line;
+    while (db_stream.readLineInto(&line)) {
+        if (!line.startsWith('#'))
+            found_items << line;
+    }
+    return found_items;
+}
 } // namespace
 
 
@@ -50,7 +79,10 @@ class test_FavoriteDB : public QObject {
 private slots:
     void write();
     void rewrite_empty();
+    void compaction();
     void read();
+    void read_journal();
+    void remove_unclean();
 };
 
 
@@ -58,17 +90,10 @@ void test_FavoriteDB::write()
 {
     providers::SearchContext sctx;
     create_dummy_data(sctx);
-    sctx.game_by_filepath(QStringLiteral(":/coll1dummy2"))->setFavorite(true);
-    sctx.game_by_filepath(QStringLiteral(":/x/y/z/coll2dummy1"))->setFavorite(true);
-    sctx.game_by_uri(QStringLiteral("steam:1337"))->setFavorite(true);
     const auto [collections, games] = sctx.finalize(this->thread());
 
-    QTemporaryFile tmp_file;
-    tmp_file.setAutoRemove(false);
-    QVERIFY(tmp_file.open());
-
-    const QString db_path = tmp_file.fileName();
-    tmp_file.close();
+    const QString db_path = create_db_path();
+    QVERIFY(!db_path.isEmpty());
 
 
     providers::favorites::Favorites favorite_db(db_path);
@@ -78,24 +103,17 @@ void test_FavoriteDB::write()
     QVERIFY(spy_start.isValid());
     QVERIFY(spy_end.isValid());
 
-    favorite_db.onGameFavoriteChanged(games);
-
-    QVERIFY(spy_start.count() || spy_start.wait());
-    QVERIFY(spy_end.count() || spy_end.wait());
-    QCOMPARE(spy_start.count(), 1);
-    QCOMPARE(spy_end.count(), 1);
+    for (model::Game* const game : games) {
+        const bool is_favorite = game->filesConst().front()->path() != QLatin1String(":/a/b/coll1dummy1");
+        game->setFavorite(is_favorite);
+        favorite_db.onGameFavoriteChanged(game);
+    }
 
+    QVERIFY(spy_start.count() >= 1);
+    QTRY_COMPARE(spy_end.count(), spy_start.count());
 
-    QFile db_file(db_path);
-    QVERIFY(db_file.open(QFile::ReadOnly | QFile::Text));
 
-    QTextStream db_stream(&db_file);
-    QStringList found_items;
-    QString line;
-    while (db_stream.readLineInto(&line)) {
-        if (!line.startsWith('#'))
-            found_items << line;
-    }
+    const QStringList found_items = read_entries(db_path);
     QFile::remove(db_path);
 
     QCOMPARE(found_items.count(), 3);
@@ -110,40 +128,67 @@ void test_FavoriteDB::rewrite_empty()
     create_dummy_data(sctx);
     const auto [collections, games] = sctx.finalize(this->thread());
 
-    QTemporaryFile tmp_file;
-    tmp_file.setAutoRemove(false);
-    QVERIFY(tmp_file.open());
-
-    const QString db_path = tmp_file.fileName();
-    tmp_file.close();
+    const QString db_path = create_db_path();
+    QVERIFY(!db_path.isEmpty());
 
 
     providers::favorites::Favorites favorite_db(db_path);
+    QSignalSpy spy_start(&favorite_db, &providers::favorites::Favorites::startedWriting);
     QSignalSpy spy_end(&favorite_db, &providers::favorites::Favorites::finishedWriting);
     QVERIFY(spy_end.isValid());
 
     games.at(1)->setFavorite(true);
-    favorite_db.onGameFavoriteChanged(games);
+    favorite_db.onGameFavoriteChanged(games.at(1));
 
     games.at(1)->setFavorite(false);
-    favorite_db.onGameFavoriteChanged(games);
+    favorite_db.onGameFavoriteChanged(games.at(1));
 
-    QVERIFY(spy_end.count() == 2 || spy_end.wait());
+    QTRY_COMPARE(spy_end.count(), spy_start.count());
 
 
-    QFile db_file(db_path);
-    QVERIFY(db_file.open(QFile::ReadOnly | QFile::Text));
+    providers::SearchContext reader_sctx;
+    create_dummy_data(reader_sctx);
+    providers::favorites::Favorites(db_path).run(reader_sctx);
+    const auto [reader_collections, reader_games] = reader_sctx.finalize(this->thread());
+    QFile::remove(db_path);
 
-    QTextStream db_stream(&db_file);
-    QStringList found_items;
-    QString line;
-    while (db_stream.readLineInto(&line)) {
-        if (!line.startsWith('#'))
-            found_items << line;
+    for (const model::Game* const game : reader_games)
+        QCOMPARE(game->isFavorite(), false);
+}
+
+void test_FavoriteDB::compaction()
+{
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+    const auto [collections, games] = sctx.finalize(this->thread());
+
+    const QString db_path = create_db_path();
+    QVERIFY(!db_path.isEmpty());
+
+
+    providers::favorites::Favorites favorite_db(db_path);
+    QSignalSpy spy_start(&favorite_db, &providers::favorites::Favorites::startedWriting);
+    QSignalSpy spy_end(&favorite_db, &providers::favorites::Favorites::finishedWriting);
+    QVERIFY(spy_end.isValid());
+
+    model::Game* const game = games.at(0);
+    for (int i = 0; i < 1000; i++) {
+        game->setFavorite(i % 2 == 0);
+        favorite_db.onGameFavoriteChanged(game);
     }
+    QTRY_COMPARE(spy_end.count(), spy_start.count());
+
+
+    const QStringList found_items = read_entries(db_path);
+    QVERIFY(found_items.count() < 100);
+
+    providers::SearchContext reader_sctx;
+    create_dummy_data(reader_sctx);
+    providers::favorites::Favorites(db_path).run(reader_sctx);
     QFile::remove(db_path);
 
-    QCOMPARE(found_items.count(), 0);
+    const QString game_path = game->filesConst().front()->path();
+    QCOMPARE(reader_sctx.game_by_filepath(game_path)->isFavorite(), false);
 }
 
 void test_FavoriteDB::read()
@@ -175,6 +220,82 @@ void test_FavoriteDB::read()
     QCOMPARE(games[3]->isFavorite(), true);
 }
 
+void test_FavoriteDB::read_journal()
+{
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+
+    QTemporaryFile tmp_file;
+    tmp_file.setAutoRemove(false);
+    QVERIFY(tmp_file.open());
+    {
+        QTextStream tmp_stream(&tmp_file);
+        tmp_stream << QStringLiteral("# Favorite journal test") << Qt::endl;
+        tmp_stream << QStringLiteral(":/x/y/z/coll2dummy1") << Qt::endl;
+        tmp_stream << QStringLiteral(":/coll1dummy2") << Qt::endl;
+        tmp_stream << QStringLiteral("steam:1337") << Qt::endl;
+        tmp_stream << QStringLiteral("- :/coll1dummy2") << Qt::endl;
+        tmp_stream << QStringLiteral("- steam:1337") << Qt::endl;
+        tmp_stream << QStringLiteral("steam:1337") << Qt::endl;
+    }
+    const QString db_path = tmp_file.fileName();
+    tmp_file.close();
+
+    providers::favorites::Favorites(db_path).run(sctx);
+    QFile::remove(db_path);
+
+    QCOMPARE(sctx.game_by_filepath(QStringLiteral(":/a/b/coll1dummy1"))->isFavorite(), false);
+    QCOMPARE(sctx.game_by_filepath(QStringLiteral(":/coll1dummy2"))->isFavorite(), false);
+    QCOMPARE(sctx.game_by_filepath(QStringLiteral(":/x/y/z/coll2dummy1"))->isFavorite(), true);
+    QCOMPARE(sctx.game_by_uri(QStringLiteral("steam:1337"))->isFavorite(), true);
+}
+
+void test_FavoriteDB::remove_unclean()
+{
+    QTemporaryFile tmp_file;
+    tmp_file.setAutoRemove(false);
+    QVERIFY(tmp_file.open());
+    {
+        QTextStream tmp_stream(&tmp_file);
+        tmp_stream << QStringLiteral("# Favorite removal test") << Qt::endl;
+        tmp_stream << QStringLiteral(":/a/b/../b/coll1dummy1") << Qt::endl;
+        tmp_stream << QStringLiteral(":/a/b/coll1dummy1") << Qt::endl;
+        tmp_stream << QStringLiteral(":/coll1dummy2") << Qt::endl;
+    }
+    const QString db_path = tmp_file.fileName();
+    tmp_file.close();
+
+
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+    providers::favorites::Favorites favorite_db(db_path);
+    favorite_db.run(sctx);
+    const auto [collections, games] = sctx.finalize(this->thread());
+
+    const auto game_it = std::find_if(games.cbegin(), games.cend(),
+        [](const model::Game* const game){ return game->filesConst().front()->path() == QLatin1String(":/a/b/coll1dummy1"); });
+    QVERIFY(game_it != games.cend());
+    model::Game* const game = *game_it;
+    QVERIFY(game->isFavorite());
+
+    QSignalSpy spy_start(&favorite_db, &providers::favorites::Favorites::startedWriting);
+    QSignalSpy spy_end(&favorite_db, &providers::favorites::Favorites::finishedWriting);
+    QVERIFY(spy_end.isValid());
+
+    game->setFavorite(false);
+    favorite_db.onGameFavoriteChanged(game);
+    QTRY_COMPARE(spy_end.count(), spy_start.count());
+
+
+    providers::SearchContext reader_sctx;
+    create_dummy_data(reader_sctx);
+    providers::favorites::Favorites(db_path).run(reader_sctx);
+    QFile::remove(db_path);
+
+    QCOMPARE(reader_sctx.game_by_filepath(QStringLiteral(":/a/b/coll1dummy1"))->isFavorite(), false);
+    QCOMPARE(reader_sctx.game_by_filepath(QStringLiteral(":/coll1dummy2"))->isFavorite(), true);
+}
+
 
 QTEST_MAIN(test_FavoriteDB)
 #include "test_FavoriteDB.moc"
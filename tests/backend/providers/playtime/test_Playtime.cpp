@@ -19,10 +19,12 @@
 
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
 #include "providers/SearchContext.h"
 #include "providers/pegasus_playtime/PlaytimeStats.h"
 
 #include <QSqlDatabase>
+#include <algorithm>
 
 
 namespace {
@@ -40,6 +42,13 @@ void create_dummy_data(providers::SearchContext& sctx)
     model::Game& game_c = *sctx.create_game_for(collection_b);
     sctx.game_add_filepath(game_c, QStringLiteral(":/x/y/z/coll2dummy1"));
 }
+
+int writer_connection_count()
+{
+    const QStringList names = QSqlDatabase::connectionNames();
+    return static_cast<int>(std::count_if(names.cbegin(), names.cend(),
+        [](const QString& name){ return name.startsWith(QLatin1String("pegasus_playtime_")); }));
+}
 } // namespace
 
 
@@ -50,6 +59,9 @@ private slots:
     void read();
     void write();
     void write_queue();
+    void write_then_read();
+    void writer_connection();
+    void writer_open_fail();
 };
 
 void test_Playtime::read()
@@ -134,6 +146,101 @@ void test_Playtime::write_queue()
 #endif
 }
 
+void test_Playtime::write_then_read()
+{
+    QTemporaryFile db_file;
+    QVERIFY(db_file.open());
+
+    const QString game_path = QStringLiteral(":/x/y/z/coll2dummy1");
+
+    {
+        providers::SearchContext sctx;
+        create_dummy_data(sctx);
+        providers::playtime::PlaytimeStats playtime(db_file.fileName());
+        model::GameFile* const gamefile = sctx.gamefile_by_filepath(game_path);
+        sctx.finalize(this);
+
+        QSignalSpy spy_end(&playtime, &providers::playtime::PlaytimeStats::finishedWriting);
+        QVERIFY(spy_end.isValid());
+
+        playtime.onGameLaunched(gamefile);
+        playtime.onGameFinished(gamefile);
+        QVERIFY(spy_end.count() || spy_end.wait());
+
+        playtime.onGameLaunched(gamefile);
+        playtime.onGameFinished(gamefile);
+        QVERIFY(spy_end.count() == 2 || spy_end.wait());
+    }
+
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+    providers::playtime::PlaytimeStats(db_file.fileName()).run(sctx);
+
+    const model::GameFile* const gamefile = sctx.gamefile_by_filepath(game_path);
+    QVERIFY(gamefile);
+    QCOMPARE(gamefile->playCount(), 2);
+    sctx.finalize(this);
+}
+
+void test_Playtime::writer_connection()
+{
+    QTemporaryFile db_file;
+    QVERIFY(db_file.open());
+
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+    const auto [collections, games] = sctx.finalize(this);
+    model::GameFile* const gamefile = games.at(0)->filesModel()->entries().front();
+
+    {
+        providers::playtime::PlaytimeStats playtime(db_file.fileName());
+        QSignalSpy spy_end(&playtime, &providers::playtime::PlaytimeStats::finishedWriting);
+        QVERIFY(spy_end.isValid());
+
+        playtime.onGameLaunched(gamefile);
+        playtime.onGameFinished(gamefile);
+        QVERIFY(spy_end.count() || spy_end.wait());
+
+        playtime.onGameLaunched(gamefile);
+        playtime.onGameFinished(gamefile);
+        QVERIFY(spy_end.count() == 2 || spy_end.wait());
+
+        // the same connection is used for every write
+        QCOMPARE(writer_connection_count(), 1);
+    }
+
+    QCOMPARE(writer_connection_count(), 0);
+    QCOMPARE(games.at(0)->property("playCount").toInt(), 2);
+}
+
+void test_Playtime::writer_open_fail()
+{
+    const QString db_path = QDir::tempPath() + QStringLiteral("/pegasus-nonexistent-dir/stats.db");
+    QVERIFY(!QFileInfo::exists(QFileInfo(db_path).path()));
+
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+    const auto [collections, games] = sctx.finalize(this);
+    model::GameFile* const gamefile = games.at(0)->filesModel()->entries().front();
+
+    providers::playtime::PlaytimeStats playtime(db_path);
+    QSignalSpy spy_end(&playtime, &providers::playtime::PlaytimeStats::finishedWriting);
+    QVERIFY(spy_end.isValid());
+
+    playtime.onGameLaunched(gamefile);
+    playtime.onGameFinished(gamefile);
+    QVERIFY(spy_end.count() || spy_end.wait());
+
+    // the failed connection is not left behind
+    QCOMPARE(writer_connection_count(), 0);
+
+    // and the next play is still processed
+    playtime.onGameLaunched(gamefile);
+    playtime.onGameFinished(gamefile);
+    QVERIFY(spy_end.count() == 2 || spy_end.wait());
+    QCOMPARE(games.at(0)->property("playCount").toInt(), 2);
+}
+
 
 QTEST_MAIN(test_Playtime)
 #include "test_Playtime.moc"
@@ -7,6 +7,7 @@ SUBDIRS += \
     favorites \
     logiqx \
     playtime \
+    searchcontext \
 
 win32: SUBDIRS += \
     launchbox \
@@ -0,0 +1,279 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "Log.h"
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
+#include "providers/SearchContext.h"
+
+#include <QTemporaryDir>
+
+
+class test_SearchContext : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        Log::init_qttest();
+    }
+
+    void merge_new_entries();
+    void merge_same_collection();
+    void merge_same_file();
+    void merge_launch_fields();
+    void merge_origins();
+    void media_files();
+    void file_cache();
+};
+
+void test_SearchContext::merge_new_entries()
+{
+    providers::SearchContext sctx(QStringList {});
+    providers::SearchContext staging(QStringList {});
+
+    model::Collection& coll = *staging.get_or_create_collection(QStringLiteral("coll"));
+    model::Game& game = *staging.create_game_for(coll);
+    staging.game_add_filepath(game, QStringLiteral("/games/game.ext"));
+    staging.pegasus_add_game_dir(QStringLiteral("/games"));
+
+    sctx.merge(staging);
+    QCOMPARE(sctx.game_by_filepath(QStringLiteral("/games/game.ext")), &game);
+    QCOMPARE(sctx.pegasus_game_dirs(), QStringList { QStringLiteral("/games") });
+    QVERIFY(staging.current_filepath_to_entry_map().empty());
+
+    const auto [collections, games] = sctx.finalize(this);
+    QCOMPARE(collections.size(), 1);
+    QCOMPARE(games.size(), 1);
+    QCOMPARE(games.front()->collectionsModel()->entries().front(), &coll);
+}
+
+void test_SearchContext::merge_same_collection()
+{
+    providers::SearchContext sctx(QStringList {});
+    providers::SearchContext staging(QStringList {});
+
+    model::Collection& coll_a = *sctx.get_or_create_collection(QStringLiteral("coll"));
+    coll_a.setShortName(QStringLiteral("a"));
+    sctx.game_add_filepath(*sctx.create_game_for(coll_a), QStringLiteral("/games/a.ext"));
+
+    model::Collection& coll_b = *staging.get_or_create_collection(QStringLiteral("coll"));
+    coll_b.setShortName(QStringLiteral("b"))
+        .setCommonLaunchCmd(QStringLiteral("runner {file.path}"));
+    staging.game_add_filepath(*staging.create_game_for(coll_b), QStringLiteral("/games/b.ext"));
+
+    sctx.merge(staging);
+
+    const auto [collections, games] = sctx.finalize(this);
+    QCOMPARE(collections.size(), 1);
+    QCOMPARE(collections.front(), &coll_a);
+    QCOMPARE(coll_a.shortName(), QStringLiteral("a"));
+    QCOMPARE(coll_a.commonLaunchCmd(), QStringLiteral("runner {file.path}"));
+    QCOMPARE(coll_a.gameList()->entries().size(), 2);
+    QCOMPARE(games.size(), 2);
+}
+
+void test_SearchContext::merge_same_file()
+{
+    providers::SearchContext sctx(QStringList {});
+    providers::SearchContext staging(QStringList {});
+
+    model::Collection& coll_a = *sctx.get_or_create_collection(QStringLiteral("coll A"));
+    model::Game& game_a = *sctx.create_game_for(coll_a);
+    sctx.game_add_filepath(game_a, QStringLiteral("/games/game.ext"));
+    game_a.setSummary(QStringLiteral("summary A"));
+
+    model::Collection& coll_b = *staging.get_or_create_collection(QStringLiteral("coll B"));
+    model::Game& game_b = *staging.create_game_for(coll_b);
+    staging.game_add_filepath(game_b, QStringLiteral("/games/game.ext"));
+    staging.game_add_filepath(game_b, QStringLiteral("/games/game.ext2"));
+    game_b.setTitle(QStringLiteral("Title B"))
+        .setSummary(QStringLiteral("summary B"))
+        .setDescription(QStringLiteral("description B"));
+
+    sctx.merge(staging);
+    QCOMPARE(sctx.game_by_filepath(QStringLiteral("/games/game.ext")), &game_a);
+    QCOMPARE(sctx.game_by_filepath(QStringLiteral("/games/game.ext2")), &game_a);
+
+    const auto [collections, games] = sctx.finalize(this);
+    QCOMPARE(collections.size(), 2);
+    QCOMPARE(games.size(), 1);
+    QCOMPARE(games.front(), &game_a);
+    QCOMPARE(game_a.title(), QStringLiteral("Title B"));
+    QCOMPARE(game_a.summary(), QStringLiteral("summary B"));
+    QCOMPARE(game_a.description(), QStringLiteral("description B"));
+    QCOMPARE(game_a.filesModel()->entries().size(), 2);
+    QCOMPARE(game_a.collectionsModel()->entries().size(), 2);
+}
+
+void test_SearchContext::merge_launch_fields()
+{
+    providers::SearchContext sctx(QStringList {});
+    providers::SearchContext staging(QStringList {});
+
+    model::Collection& coll_a = *sctx.get_or_create_collection(QStringLiteral("coll A"));
+    model::Game& game_a = *sctx.create_game_for(coll_a);
+    sctx.game_add_filepath(game_a, QStringLiteral("/games/game.ext"));
+    game_a.setLaunchCmd(QStringLiteral("launch A"));
+
+    // the game of the second provider inherits the launch fields of its collection
+    model::Collection& coll_b = *staging.get_or_create_collection(QStringLiteral("coll B"));
+    coll_b.setCommonLaunchCmd(QStringLiteral("launch B"));
+    coll_b.setCommonLaunchWorkdir(QStringLiteral("/workdir/b"));
+    model::Game& game_b = *staging.create_game_for(coll_b);
+    staging.game_add_filepath(game_b, QStringLiteral("/games/game.ext"));
+    QCOMPARE(game_b.launchCmd(), QStringLiteral("launch B"));
+
+    sctx.merge(staging);
+    sctx.finalize(this);
+
+    // only the missing launch fields are filled in
+    QCOMPARE(game_a.launchCmd(), QStringLiteral("launch A"));
+    QCOMPARE(game_a.launchWorkdir(), QStringLiteral("/workdir/b"));
+}
+
+void test_SearchContext::merge_origins()
+{
+    providers::SearchContext sctx(QStringList {});
+    providers::SearchContext staging(QStringList {});
+
+    model::Collection& coll_a = *sctx.get_or_create_collection(QStringLiteral("coll A"));
+    sctx.collection_add_source_dir(coll_a, QStringLiteral("/games/a"));
+    model::Game& game_a = *sctx.create_game_for(coll_a);
+    sctx.game_add_filepath(game_a, QStringLiteral("/games/a/game.ext"));
+
+    model::Collection& coll_b = *staging.get_or_create_collection(QStringLiteral("coll B"));
+    staging.collection_add_source_dir(coll_b, QStringLiteral("/games/b"));
+    model::Collection& coll_a2 = *staging.get_or_create_collection(QStringLiteral("coll A"));
+    staging.game_add_filepath(*staging.create_game_for(coll_a2), QStringLiteral("/games/a/other.ext"));
+    model::Game& game_b = *staging.create_game_for(coll_b);
+    staging.game_add_filepath(game_b, QStringLiteral("/games/b/game.ext"));
+    staging.game_add_filepath(*staging.create_game_for(coll_b), QStringLiteral("/games/a/game.ext"));
+
+    sctx.merge(staging);
+    QCOMPARE(sctx.collection_source_dir(coll_a), QString());
+    QCOMPARE(sctx.collection_source_dir(coll_b), QStringLiteral("/games/b"));
+    QVERIFY(sctx.game_is_shared(game_a));
+    QVERIFY(!sctx.game_is_shared(game_b));
+
+    // Defined by metafiles in different directories
+    sctx.collection_add_source_dir(coll_b, QStringLiteral("/games/c"));
+    QCOMPARE(sctx.collection_source_dir(coll_b), QString());
+
+    const auto [collections, games] = sctx.finalize(this);
+    QCOMPARE(collections.size(), 2);
+    QCOMPARE(games.size(), 3);
+}
+
+
+void test_SearchContext::media_files()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    QDir root(tmp_dir.path());
+
+    const QStringList file_paths {
+        QStringLiteral("Game 1/box_front.png"),
+        QStringLiteral("Game 1/video.mp4"),
+        QStringLiteral("sub/dir/archive.tar.gz"),
+        QStringLiteral("noext"),
+        QStringLiteral(".hidden.png"),
+        QStringLiteral(".hidden/box_front.png"),
+    };
+    for (const QString& path : file_paths) {
+        QVERIFY(root.mkpath(QFileInfo(root.filePath(path)).path()));
+        QFile file(root.filePath(path));
+        QVERIFY(file.open(QFile::WriteOnly));
+    }
+#ifdef Q_OS_UNIX
+    // must not loop forever
+    QVERIFY(QFile::link(root.path(), root.filePath(QStringLiteral("sub/loop"))));
+#endif
+
+    providers::SearchContext sctx;
+    const std::vector<providers::MediaFile>& files = sctx.media_files(root.path());
+    QCOMPARE(&sctx.media_files(root.path()), &files);
+
+    QStringList rel_paths;
+    for (const providers::MediaFile& file : files) {
+        QVERIFY(file.path.startsWith(QDir::cleanPath(root.path()) + QLatin1Char('/')));
+        rel_paths.append(file.rel_path().toString());
+    }
+    rel_paths.sort();
+    const QStringList expected {
+        QStringLiteral("Game 1/box_front.png"),
+        QStringLiteral("Game 1/video.mp4"),
+        QStringLiteral("noext"),
+        QStringLiteral("sub/dir/archive.tar.gz"),
+    };
+    QCOMPARE(rel_paths, expected);
+
+    const auto it = std::find_if(files.cbegin(), files.cend(),
+        [](const providers::MediaFile& file){ return file.rel_path() == QLatin1String("sub/dir/archive.tar.gz"); });
+    QVERIFY(it != files.cend());
+    QCOMPARE(it->rel_dir().toString(), QStringLiteral("sub/dir"));
+    QCOMPARE(it->complete_basename().toString(), QStringLiteral("archive.tar"));
+    QCOMPARE(it->suffix().toString(), QStringLiteral("gz"));
+}
+
+void test_SearchContext::file_cache()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    QDir root(tmp_dir.path());
+
+    QVERIFY(root.mkpath(QStringLiteral("sub")));
+    {
+        QFile file(root.filePath(QStringLiteral("game.bin")));
+        QVERIFY(file.open(QFile::WriteOnly));
+        QCOMPARE(file.write("12345"), qint64(5));
+    }
+
+    providers::SearchContext sctx;
+    providers::FileCache& files = sctx.files();
+
+    QVERIFY(files.exists(root.filePath(QStringLiteral("game.bin"))));
+    QVERIFY(files.is_file(root.filePath(QStringLiteral("game.bin"))));
+    QVERIFY(!files.is_dir(root.filePath(QStringLiteral("game.bin"))));
+    QCOMPARE(files.size(root.filePath(QStringLiteral("game.bin"))), qint64(5));
+    QVERIFY(files.last_modified(root.filePath(QStringLiteral("game.bin"))).isValid());
+    QVERIFY(files.is_dir(root.filePath(QStringLiteral("sub"))));
+    QVERIFY(files.is_file(root.filePath(QStringLiteral("sub/../game.bin"))));
+    QVERIFY(!files.exists(root.filePath(QStringLiteral("missing.bin"))));
+    QVERIFY(!files.exists(root.filePath(QStringLiteral("missing/game.bin"))));
+
+    // the listings are not refreshed
+    {
+        QFile file(root.filePath(QStringLiteral("late.bin")));
+        QVERIFY(file.open(QFile::WriteOnly));
+    }
+    QVERIFY(!files.exists(root.filePath(QStringLiteral("late.bin"))));
+
+    // staging contexts can reuse the listings
+    providers::SearchContext staging(QStringList {});
+    staging.share_files_with(sctx);
+    QVERIFY(staging.files().is_file(root.filePath(QStringLiteral("game.bin"))));
+
+    QCOMPARE(files.query_count(), size_t(11));
+    QCOMPARE(files.dir_read_count(), size_t(2));
+}
+
+
+QTEST_MAIN(test_SearchContext)
+#include "test_SearchContext.moc"
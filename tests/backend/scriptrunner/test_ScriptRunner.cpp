@@ -0,0 +1,250 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "AppSettings.h"
+#include "Paths.h"
+#include "ScriptRunner.h"
+
+
+namespace {
+#ifndef Q_OS_WIN
+// The scripts are looked up next to the executable too
+QString script_dir(const QString& dirname)
+{
+    return paths::app_dir_path() + QStringLiteral("/scripts/") + dirname;
+}
+
+// The scripts get the output file as their first argument. Their order is controlled
+// by marker files created next to it, instead of relying on the timing of sleeps.
+QString wait_for(const QString& marker)
+{
+    // gives up after about 10 seconds, so a broken test fails instead of hanging
+    return QStringLiteral(
+        "i=0\n"
+        "while [ ! -e \"$(dirname \"$1\")/%1\" ] && [ $i -lt 1000 ]; do sleep 0.01; i=$((i+1)); done\n")
+        .arg(marker);
+}
+
+// Appends the line to the output, then creates the `<line>.done` marker
+QString write_line(const QString& line)
+{
+    return QStringLiteral(
+        "echo %1 >> \"$1\"\n"
+        "touch \"$(dirname \"$1\")/%1.done\"\n")
+        .arg(line);
+}
+
+void create_script(const QString& path, const QString& body)
+{
+    QVERIFY(QDir().mkpath(QFileInfo(path).path()));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.write(QStringLiteral("#!/bin/sh\n").toUtf8());
+    file.write(body.toUtf8());
+    file.close();
+    QVERIFY(file.setPermissions(file.permissions() | QFileDevice::ExeOwner));
+}
+
+QStringList read_lines(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return {};
+
+    return QString::fromUtf8(file.readAll()).split(QChar('\n'), Qt::SkipEmptyParts);
+}
+
+void create_marker(const QString& path)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+}
+#endif
+} // namespace
+
+
+class test_ScriptRunner : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+#ifndef Q_OS_WIN
+    void parallel();
+    void listing_cache();
+    void async_order();
+    void async_queue();
+    void timeout();
+#endif
+
+private:
+    QTemporaryDir m_output_dir;
+};
+
+void test_ScriptRunner::initTestCase()
+{
+    // don't pick up the scripts of the user
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_output_dir.isValid());
+}
+
+void test_ScriptRunner::cleanupTestCase()
+{
+#ifndef Q_OS_WIN
+    QDir(paths::app_dir_path() + QStringLiteral("/scripts")).removeRecursively();
+#endif
+}
+
+#ifndef Q_OS_WIN
+void test_ScriptRunner::parallel()
+{
+    // the first serial script can only finish if the parallel one runs meanwhile
+    const QString dir = script_dir(QStringLiteral("config-changed"));
+    create_script(dir + QStringLiteral("/01-serial"), wait_for(QStringLiteral("p-parallel.done")) + write_line(QStringLiteral("p-serial1")));
+    create_script(dir + QStringLiteral("/02-serial"), write_line(QStringLiteral("p-serial2")));
+    create_script(dir + QStringLiteral("/parallel/01-parallel"), write_line(QStringLiteral("p-parallel")));
+
+    const QString out_path = m_output_dir.filePath(QStringLiteral("parallel.txt"));
+    ScriptRunner::run(ScriptEvent::CONFIG_CHANGED, { out_path });
+
+    QCOMPARE(read_lines(out_path), QStringList({
+        QStringLiteral("p-parallel"),
+        QStringLiteral("p-serial1"),
+        QStringLiteral("p-serial2"),
+    }));
+}
+
+void test_ScriptRunner::listing_cache()
+{
+    const QString dir = script_dir(QStringLiteral("settings-changed"));
+    create_script(dir + QStringLiteral("/01-first"), write_line(QStringLiteral("c-first")));
+
+    const QString out_path = m_output_dir.filePath(QStringLiteral("cache.txt"));
+    ScriptRunner::run(ScriptEvent::SETTINGS_CHANGED, { out_path });
+    QCOMPARE(read_lines(out_path), QStringList({ QStringLiteral("c-first") }));
+
+    // a new file changes the modification time of the directory,
+    // which may have a resolution of one second
+    QTest::qWait(1100);
+    create_script(dir + QStringLiteral("/02-second"), write_line(QStringLiteral("c-second")));
+    QFile::remove(out_path);
+    ScriptRunner::run(ScriptEvent::SETTINGS_CHANGED, { out_path });
+    QCOMPARE(read_lines(out_path), QStringList({ QStringLiteral("c-first"), QStringLiteral("c-second") }));
+
+    // the permissions are checked on every run, even if the listing is cached
+    QFile first_file(dir + QStringLiteral("/01-first"));
+    QVERIFY(first_file.setPermissions(first_file.permissions() & ~QFileDevice::ExeOwner & ~QFileDevice::ExeUser));
+    QFile::remove(out_path);
+    ScriptRunner::run(ScriptEvent::SETTINGS_CHANGED, { out_path });
+    QCOMPARE(read_lines(out_path), QStringList({ QStringLiteral("c-second") }));
+}
+
+void test_ScriptRunner::async_order()
+{
+    // the parallel script finishes last
+    const QString dir = script_dir(QStringLiteral("controls-changed"));
+    create_script(dir + QStringLiteral("/01-serial"), write_line(QStringLiteral("a-serial1")));
+    create_script(dir + QStringLiteral("/02-serial"), write_line(QStringLiteral("a-serial2")));
+    create_script(dir + QStringLiteral("/parallel/01-parallel"), wait_for(QStringLiteral("a-serial2.done")) + write_line(QStringLiteral("a-parallel")));
+
+    const QString out_path = m_output_dir.filePath(QStringLiteral("async.txt"));
+
+    int finish_count = 0;
+    QStringList lines_when_finished;
+    ScriptRunner::run_async(ScriptEvent::CONTROLS_CHANGED, { out_path }, [&finish_count, &lines_when_finished, &out_path]{
+        finish_count++;
+        lines_when_finished = read_lines(out_path);
+    });
+
+    // returns right away
+    QCOMPARE(finish_count, 0);
+
+    // the callback comes after every script has finished, only once
+    QTRY_COMPARE_WITH_TIMEOUT(finish_count, 1, 15000);
+    QCOMPARE(lines_when_finished, QStringList({
+        QStringLiteral("a-serial1"),
+        QStringLiteral("a-serial2"),
+        QStringLiteral("a-parallel"),
+    }));
+    QCoreApplication::processEvents();
+    QCOMPARE(finish_count, 1);
+
+    // without scripts, the callback is called right away
+    bool called = false;
+    ScriptRunner::run_async(ScriptEvent::QUIT, {}, [&called]{ called = true; });
+    QVERIFY(called);
+}
+
+void test_ScriptRunner::async_queue()
+{
+    // the script stays running until the release marker is created
+    const QString dir = script_dir(QStringLiteral("game-start"));
+    create_script(dir + QStringLiteral("/01-script"),
+        QStringLiteral("echo start >> \"$1\"\n") + wait_for(QStringLiteral("q-release")) + QStringLiteral("echo end >> \"$1\"\n"));
+
+    const QString out_path = m_output_dir.filePath(QStringLiteral("queue.txt"));
+
+    QStringList finished;
+    ScriptRunner::run_async(ScriptEvent::PROCESS_STARTED, { out_path }, [&finished]{ finished << QStringLiteral("first"); });
+    ScriptRunner::run_async(ScriptEvent::PROCESS_STARTED, { out_path }, [&finished]{ finished << QStringLiteral("second"); });
+
+    // the second run waits for the first one
+    QTRY_COMPARE_WITH_TIMEOUT(read_lines(out_path), QStringList({ QStringLiteral("start") }), 5000);
+    QCOMPARE(finished, QStringList());
+    create_marker(m_output_dir.filePath(QStringLiteral("q-release")));
+
+    QTRY_COMPARE_WITH_TIMEOUT(finished.size(), 2, 15000);
+    QCOMPARE(finished, QStringList({ QStringLiteral("first"), QStringLiteral("second") }));
+    QCOMPARE(read_lines(out_path), QStringList({
+        QStringLiteral("start"),
+        QStringLiteral("end"),
+        QStringLiteral("start"),
+        QStringLiteral("end"),
+    }));
+}
+
+void test_ScriptRunner::timeout()
+{
+    const QString dir = script_dir(QStringLiteral("game-end"));
+    create_script(dir + QStringLiteral("/01-slow"), wait_for(QStringLiteral("t-release")) + write_line(QStringLiteral("t-slow")));
+
+    const QString out_path = m_output_dir.filePath(QStringLiteral("timeout.txt"));
+    const QString release_path = m_output_dir.filePath(QStringLiteral("t-release"));
+
+    // no limit by default
+    QCOMPARE(AppSettings::general.script_timeout_sec, 0);
+    create_marker(release_path);
+    ScriptRunner::run(ScriptEvent::PROCESS_FINISHED, { out_path });
+    QCOMPARE(read_lines(out_path), QStringList({ QStringLiteral("t-slow") }));
+
+    // without the marker, the script would wait much longer than the limit
+    QVERIFY(QFile::remove(release_path));
+    AppSettings::general.script_timeout_sec = 1;
+    QFile::remove(out_path);
+    ScriptRunner::run(ScriptEvent::PROCESS_FINISHED, { out_path });
+    AppSettings::general.script_timeout_sec = 0;
+    QCOMPARE(read_lines(out_path), QStringList());
+}
+#endif
+
+
+QTEST_MAIN(test_ScriptRunner)
+#include "test_ScriptRunner.moc"
@@ -2,4 +2,13 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     configfile \
+    es2_mame \
+    game_index \
+    game_list_model \
+    keys \
+    log \
+    pegasus_filter \
     pegasus_provider \
+    playtime \
+    search_context \
+    sort_ranks \
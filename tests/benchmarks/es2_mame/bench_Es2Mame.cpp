@@ -0,0 +1,136 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "Log.h"
+#include "providers/SearchContext.h"
+#include "providers/es2/Es2Games.h"
+#include "providers/es2/Es2Systems.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+
+namespace {
+// Roughly the size of a full MAME romset and the blacklists of ES2
+constexpr int BIOS_COUNT = 100;
+constexpr int DEVICE_COUNT = 4000;
+constexpr int GAME_COUNT = 36000;
+
+void touch(const QString& path)
+{
+    QFile file(path);
+    QVERIFY(file.open(QFile::WriteOnly));
+}
+
+void write_list(const QString& path, const QString& root_tag, const QString& tag, const QString& prefix, int count)
+{
+    QFile file(path);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Text));
+
+    QTextStream stream(&file);
+    stream << '<' << root_tag << ">\n";
+    for (int i = 0; i < count; i++)
+        stream << '<' << tag << '>' << prefix << i << "</" << tag << ">\n";
+    stream << "</" << root_tag << ">\n";
+}
+} // namespace
+
+
+class bench_Es2Mame : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+    std::vector<QString> m_config_dirs;
+
+private slots:
+    void initTestCase() {
+        Log::init_qttest();
+
+        QVERIFY(m_dir.isValid());
+        QDir root(m_dir.path());
+        QVERIFY(root.mkpath(QStringLiteral("es/resources")));
+        QVERIFY(root.mkpath(QStringLiteral("roms/mame")));
+        m_config_dirs.emplace_back(root.filePath(QStringLiteral("es")));
+
+        write_list(root.filePath(QStringLiteral("es/resources/mamebioses.xml")),
+            QStringLiteral("bioses"), QStringLiteral("bios"), QStringLiteral("bios"), BIOS_COUNT);
+        write_list(root.filePath(QStringLiteral("es/resources/mamedevices.xml")),
+            QStringLiteral("devices"), QStringLiteral("device"), QStringLiteral("device"), DEVICE_COUNT);
+
+        // every blacklisted set is present too, like in a full romset
+        const QDir rom_dir(root.filePath(QStringLiteral("roms/mame")));
+        for (int i = 0; i < BIOS_COUNT; i++)
+            touch(rom_dir.filePath(QStringLiteral("bios%1.zip").arg(i)));
+        for (int i = 0; i < DEVICE_COUNT; i++)
+            touch(rom_dir.filePath(QStringLiteral("device%1.zip").arg(i)));
+        for (int i = 0; i < GAME_COUNT; i++)
+            touch(rom_dir.filePath(QStringLiteral("game%1.zip").arg(i)));
+    }
+
+    void read_blacklists();
+    void read_blacklists_cached();
+    void scan_romset();
+};
+
+void bench_Es2Mame::read_blacklists()
+{
+    size_t entry_count = 0;
+    QBENCHMARK {
+        entry_count = providers::es2::read_mame_blacklists(QStringLiteral("ES2"), m_config_dirs).size();
+    }
+    QCOMPARE(entry_count, static_cast<size_t>(BIOS_COUNT + DEVICE_COUNT));
+}
+
+void bench_Es2Mame::read_blacklists_cached()
+{
+    const QString cache_path = m_dir.filePath(QStringLiteral("cache/blacklist.bin"));
+    providers::es2::read_mame_blacklists(QStringLiteral("ES2"), m_config_dirs, cache_path);
+    QVERIFY(QFileInfo::exists(cache_path));
+
+    size_t entry_count = 0;
+    QBENCHMARK {
+        entry_count = providers::es2::read_mame_blacklists(QStringLiteral("ES2"), m_config_dirs, cache_path).size();
+    }
+    QCOMPARE(entry_count, static_cast<size_t>(BIOS_COUNT + DEVICE_COUNT));
+}
+
+void bench_Es2Mame::scan_romset()
+{
+    const providers::es2::MameBlacklist blacklist = providers::es2::read_mame_blacklists(QStringLiteral("ES2"), m_config_dirs);
+
+    providers::es2::SystemEntry sysentry;
+    sysentry.name = QStringLiteral("MAME");
+    sysentry.shortname = QStringLiteral("mame");
+    sysentry.path = m_dir.filePath(QStringLiteral("roms/mame"));
+    sysentry.extensions = QStringLiteral(".zip");
+    sysentry.platforms = QStringLiteral("arcade");
+
+    size_t found_games = 0;
+    QBENCHMARK {
+        providers::SearchContext sctx;
+        found_games = providers::es2::find_games_for(sysentry, sctx, blacklist);
+    }
+    QCOMPARE(found_games, static_cast<size_t>(GAME_COUNT));
+}
+
+
+QTEST_MAIN(bench_Es2Mame)
+#include "bench_Es2Mame.moc"
@@ -0,0 +1,337 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "Log.h"
+#include "model/gaming/Assets.h"
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
+#include "providers/GameDataCache.h"
+#include "providers/SearchContext.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <functional>
+
+
+namespace {
+constexpr int GAME_COUNT = 50000;
+constexpr int COLLECTION_COUNT = 50;
+
+// Linux only: the peak resident set size can be reset through `clear_refs`
+void reset_peak_rss()
+{
+    QFile file(QStringLiteral("/proc/self/clear_refs"));
+    if (file.open(QIODevice::WriteOnly))
+        file.write("5");
+}
+
+qint64 read_status_kb(const QByteArray& field)
+{
+    QFile file(QStringLiteral("/proc/self/status"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return 0;
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        if (line.startsWith(field))
+            return line.mid(field.size()).trimmed().split(' ').constFirst().toLongLong();
+    }
+    return 0;
+}
+
+
+// A separate copy, like the ones produced by parsing
+QString copy_of(const QString& str)
+{
+    return QString(str.constData(), str.size());
+}
+
+void create_library(providers::SearchContext& sctx)
+{
+    const QStringList companies {
+        QStringLiteral("Capcom"), QStringLiteral("Konami"), QStringLiteral("Namco"),
+        QStringLiteral("Nintendo"), QStringLiteral("Sega"), QStringLiteral("SNK"),
+        QStringLiteral("Square"), QStringLiteral("Taito"), QStringLiteral("Technos"),
+    };
+    const QStringList genres {
+        QStringLiteral("Action"), QStringLiteral("Platform"), QStringLiteral("Puzzle"),
+        QStringLiteral("Racing"), QStringLiteral("Role-playing"), QStringLiteral("Shooter"),
+    };
+
+    std::vector<model::Collection*> collections;
+    for (int c = 0; c < COLLECTION_COUNT; c++) {
+        model::Collection* const coll = sctx.get_or_create_collection(QStringLiteral("System %1").arg(c));
+        coll->setCommonLaunchCmd(QStringLiteral("emulator --system %1 {file.path}").arg(c));
+        collections.emplace_back(coll);
+    }
+
+    for (int i = 0; i < GAME_COUNT; i++) {
+        const int c = i % COLLECTION_COUNT;
+        const QString dir = QStringLiteral("/games/system%1/").arg(c);
+
+        model::Game& game = *sctx.create_game_for(*collections[c]);
+        sctx.game_add_filepath(game, dir + QStringLiteral("game%1.ext").arg(i));
+        game.setTitle(QStringLiteral("Game Title %1").arg(i))
+            .setSummary(QStringLiteral("Short summary of game %1").arg(i))
+            .setDescription(QStringLiteral("A much longer description of game %1, which usually spans multiple sentences.").arg(i))
+            .setReleaseDate(QDate(1980 + i % 40, 1 + i % 12, 1 + i % 28));
+        game.setRating((i % 100) / 100.f)
+            .setPlayerCount(1 + i % 4);
+        game.developerList().append(copy_of(companies.at(i % companies.size())));
+        game.publisherList().append(copy_of(companies.at((i / 7) % companies.size())));
+        game.genreList().append(copy_of(genres.at(i % genres.size())));
+        game.assetsMut()
+            .add_file(AssetType::BOX_FRONT, dir + QStringLiteral("media/game%1/boxFront.png").arg(i))
+            .add_file(AssetType::SCREENSHOT, dir + QStringLiteral("media/game%1/screenshot.png").arg(i));
+    }
+}
+
+
+// The previous JSON based cache format, as a reference point
+QJsonArray to_json(const QStringList& list)
+{
+    return QJsonArray::fromStringList(list);
+}
+
+QByteArray write_json(const std::vector<model::Collection*>& collections, const std::vector<model::Game*>& games)
+{
+    QJsonArray coll_array;
+    for (const model::Collection* const coll : collections) {
+        QJsonObject obj;
+        obj[QStringLiteral("name")] = coll->name();
+        obj[QStringLiteral("sort_by")] = coll->sortBy();
+        obj[QStringLiteral("short_name")] = coll->shortName();
+        obj[QStringLiteral("common_launch_cmd")] = coll->commonLaunchCmd();
+        coll_array.append(obj);
+    }
+
+    QJsonArray game_array;
+    for (const model::Game* const game : games) {
+        QJsonObject obj;
+        obj[QStringLiteral("title")] = game->title();
+        obj[QStringLiteral("sort_by")] = game->sortBy();
+        obj[QStringLiteral("summary")] = game->summary();
+        obj[QStringLiteral("description")] = game->description();
+        obj[QStringLiteral("developers")] = to_json(game->developerListConst());
+        obj[QStringLiteral("publishers")] = to_json(game->publisherListConst());
+        obj[QStringLiteral("genres")] = to_json(game->genreListConst());
+        obj[QStringLiteral("player_count")] = game->playerCount();
+        obj[QStringLiteral("rating")] = game->rating();
+        obj[QStringLiteral("release_date")] = game->releaseDate().toString(Qt::ISODate);
+        obj[QStringLiteral("launch_cmd")] = game->launchCmd();
+
+        QJsonObject assets;
+        assets[QStringLiteral("box_front")] = to_json(game->assets().boxFrontList());
+        assets[QStringLiteral("screenshot")] = to_json(game->assets().screenshotList());
+        obj[QStringLiteral("assets")] = assets;
+
+        QJsonArray coll_names;
+        for (const model::Collection* const coll : game->collectionsModel()->entries())
+            coll_names.append(coll->name());
+        obj[QStringLiteral("collections")] = coll_names;
+
+        QJsonArray files;
+        for (const model::GameFile* const file : game->filesModel()->entries()) {
+            QJsonObject file_obj;
+            file_obj[QStringLiteral("path")] = file->path();
+            file_obj[QStringLiteral("name")] = file->name();
+            files.append(file_obj);
+        }
+        obj[QStringLiteral("files")] = files;
+
+        game_array.append(obj);
+    }
+
+    QJsonObject root;
+    root[QStringLiteral("collections")] = coll_array;
+    root[QStringLiteral("games")] = game_array;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+void read_json(const QString& path, providers::SearchContext& sctx)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    for (const QJsonValue& value : root.value(QStringLiteral("collections")).toArray()) {
+        const QJsonObject obj = value.toObject();
+        model::Collection& coll = *sctx.get_or_create_collection(obj.value(QStringLiteral("name")).toString());
+        coll.setSortBy(obj.value(QStringLiteral("sort_by")).toString())
+            .setShortName(obj.value(QStringLiteral("short_name")).toString())
+            .setCommonLaunchCmd(obj.value(QStringLiteral("common_launch_cmd")).toString());
+    }
+
+    const auto to_list = [](const QJsonValue& value){
+        QStringList out;
+        for (const QJsonValue& item : value.toArray())
+            out.append(item.toString());
+        return out;
+    };
+
+    for (const QJsonValue& value : root.value(QStringLiteral("games")).toArray()) {
+        const QJsonObject obj = value.toObject();
+
+        model::Game& game = *sctx.create_game();
+        game.setTitle(obj.value(QStringLiteral("title")).toString())
+            .setSortBy(obj.value(QStringLiteral("sort_by")).toString())
+            .setSummary(obj.value(QStringLiteral("summary")).toString())
+            .setDescription(obj.value(QStringLiteral("description")).toString())
+            .setReleaseDate(QDate::fromString(obj.value(QStringLiteral("release_date")).toString(), Qt::ISODate))
+            .setLaunchCmd(obj.value(QStringLiteral("launch_cmd")).toString());
+        game.setPlayerCount(obj.value(QStringLiteral("player_count")).toInt(1))
+            .setRating(static_cast<float>(obj.value(QStringLiteral("rating")).toDouble()));
+        game.developerList().append(to_list(obj.value(QStringLiteral("developers"))));
+        game.publisherList().append(to_list(obj.value(QStringLiteral("publishers"))));
+        game.genreList().append(to_list(obj.value(QStringLiteral("genres"))));
+
+        const QJsonObject assets = obj.value(QStringLiteral("assets")).toObject();
+        for (const QString& uri : to_list(assets.value(QStringLiteral("box_front"))))
+            game.assetsMut().add_uri(AssetType::BOX_FRONT, uri);
+        for (const QString& uri : to_list(assets.value(QStringLiteral("screenshot"))))
+            game.assetsMut().add_uri(AssetType::SCREENSHOT, uri);
+
+        for (const QString& coll_name : to_list(obj.value(QStringLiteral("collections"))))
+            sctx.game_add_to(game, *sctx.get_or_create_collection(coll_name));
+
+        for (const QJsonValue& file_value : obj.value(QStringLiteral("files")).toArray()) {
+            const QJsonObject file_obj = file_value.toObject();
+            sctx.game_add_filepath(game, file_obj.value(QStringLiteral("path")).toString())
+                ->setName(file_obj.value(QStringLiteral("name")).toString());
+        }
+    }
+}
+} // namespace
+
+
+class bench_GameIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void load_binary();
+    void load_json();
+    void library_memory();
+
+private:
+    QTemporaryDir m_tmpdir;
+    QString m_fingerprint;
+    QString m_binary_path;
+    QString m_json_path;
+
+    void run_load(const std::function<void(providers::SearchContext&)>&);
+};
+
+void bench_GameIndex::initTestCase()
+{
+    Log::init_qttest();
+    QVERIFY(m_tmpdir.isValid());
+
+    m_fingerprint = QString(64, QLatin1Char('0'));
+    m_binary_path = m_tmpdir.filePath(QStringLiteral("gameindex.bin"));
+    m_json_path = m_tmpdir.filePath(QStringLiteral("gameindex.json"));
+
+    providers::SearchContext sctx(QStringList {});
+    create_library(sctx);
+    const auto [collections, games] = sctx.finalize(this);
+    QCOMPARE(games.size(), GAME_COUNT);
+
+    QVERIFY(GameDataCache::writeIndex(m_binary_path, m_fingerprint, collections, games));
+
+    QFile json_file(m_json_path);
+    QVERIFY(json_file.open(QIODevice::WriteOnly));
+    json_file.write(write_json(collections, games));
+    json_file.close();
+
+    qInfo().noquote() << QStringLiteral("Index sizes: binary %1 KiB, JSON %2 KiB")
+        .arg(QFileInfo(m_binary_path).size() / 1024)
+        .arg(QFileInfo(m_json_path).size() / 1024);
+
+    qDeleteAll(games);
+    qDeleteAll(collections);
+}
+
+void bench_GameIndex::run_load(const std::function<void(providers::SearchContext&)>& loader)
+{
+    reset_peak_rss();
+    const qint64 rss_before = read_status_kb(QByteArrayLiteral("VmRSS:"));
+
+    QBENCHMARK {
+        providers::SearchContext sctx(QStringList {});
+        loader(sctx);
+
+        const auto [collections, games] = sctx.finalize();
+        QCOMPARE(games.size(), GAME_COUNT);
+        qDeleteAll(games);
+        qDeleteAll(collections);
+    }
+
+    const qint64 rss_peak = read_status_kb(QByteArrayLiteral("VmHWM:"));
+    if (rss_before > 0 && rss_peak > 0)
+        qInfo().noquote() << QStringLiteral("Peak RSS growth: %1 KiB").arg(rss_peak - rss_before);
+}
+
+void bench_GameIndex::load_binary()
+{
+    run_load([this](providers::SearchContext& sctx){
+        QVERIFY(GameDataCache::readIndex(m_binary_path, m_fingerprint, sctx));
+    });
+}
+
+void bench_GameIndex::load_json()
+{
+    run_load([this](providers::SearchContext& sctx){
+        read_json(m_json_path, sctx);
+    });
+}
+
+void bench_GameIndex::library_memory()
+{
+    const qint64 rss_before = read_status_kb(QByteArrayLiteral("VmRSS:"));
+
+    providers::SearchContext sctx(QStringList {});
+    create_library(sctx);
+    const auto [collections, games] = sctx.finalize(this);
+    QCOMPARE(games.size(), GAME_COUNT);
+    const qint64 rss_library = read_status_kb(QByteArrayLiteral("VmRSS:"));
+
+    // the list models are only created when QML uses them, as if every game was shown
+    for (const model::Game* const game : games) {
+        QCOMPARE(game->filesModel()->entries().size(), static_cast<size_t>(1));
+        QCOMPARE(game->collectionsModel()->entries().size(), static_cast<size_t>(1));
+    }
+    const qint64 rss_models = read_status_kb(QByteArrayLiteral("VmRSS:"));
+
+    if (rss_before > 0 && rss_library > 0 && rss_models > 0) {
+        qInfo().noquote() << QStringLiteral("RSS growth of %1 games: %2 KiB, with all list models created: %3 KiB")
+            .arg(QString::number(GAME_COUNT), QString::number(rss_library - rss_before), QString::number(rss_models - rss_before));
+    }
+
+    qDeleteAll(games);
+    qDeleteAll(collections);
+}
+
+
+QTEST_MAIN(bench_GameIndex)
+#include "bench_GameIndex.moc"
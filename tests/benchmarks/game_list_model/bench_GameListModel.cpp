@@ -0,0 +1,112 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <QtTest/QtTest>
+
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
+#include "model/gaming/GameListModel.h"
+#include "providers/SearchContext.h"
+
+#include <QRandomGenerator>
+
+
+namespace {
+constexpr int GAME_COUNT = 50000;
+constexpr int UPDATE_COUNT = 10000;
+} // namespace
+
+
+class bench_GameListModel : public QObject {
+    Q_OBJECT
+
+private:
+    std::vector<model::Game*> m_games;
+
+private slots:
+    void initTestCase();
+
+    void playstat_updates_data();
+    void playstat_updates();
+};
+
+void bench_GameListModel::initTestCase()
+{
+    providers::SearchContext sctx;
+    model::Collection& collection = *sctx.get_or_create_collection(QStringLiteral("coll"));
+    for (int i = 0; i < GAME_COUNT; i++) {
+        model::Game& game = *sctx.create_game_for(collection);
+        sctx.game_add_filepath(game, QStringLiteral("/roms/game%1.bin").arg(i));
+    }
+
+    auto result = sctx.finalize(this);
+    m_games = std::move(result.second);
+    QCOMPARE(static_cast<int>(m_games.size()), GAME_COUNT);
+}
+
+void bench_GameListModel::playstat_updates_data()
+{
+    QTest::addColumn<bool>("sequential");
+
+    // eg. when loading stats for a whole collection
+    QTest::newRow("sequential games") << true;
+    // eg. scattered updates after a rescan
+    QTest::newRow("random games") << false;
+}
+
+// Like PlaytimeStats::run for a large library: the changes arrive in a
+// single burst, then the event loop gets to process them
+void bench_GameListModel::playstat_updates()
+{
+    QFETCH(bool, sequential);
+
+    model::GameListModel model;
+    std::vector<model::Game*> entries = m_games;
+    model.update(std::move(entries));
+
+    std::vector<model::GameFile*> targets;
+    targets.reserve(UPDATE_COUNT);
+    QRandomGenerator rng(42);
+    for (int i = 0; i < UPDATE_COUNT; i++) {
+        const int game_idx = sequential ? i : rng.bounded(GAME_COUNT);
+        targets.push_back(m_games[game_idx]->filesConst().front());
+    }
+
+    int signal_count = 0;
+    connect(&model, &QAbstractItemModel::dataChanged,
+            this, [&signal_count](){ signal_count++; });
+
+    const QDateTime now = QDateTime::currentDateTime();
+    QBENCHMARK {
+        signal_count = 0;
+        for (model::GameFile* const gamefile : targets)
+            gamefile->update_playstats(1, 60, now);
+        QCoreApplication::sendPostedEvents();
+    }
+
+    QVERIFY(signal_count > 0);
+    if (sequential)
+        QCOMPARE(signal_count, 1);
+    qInfo().noquote() << QStringLiteral("%1 dataChanged signals for %2 updates")
+        .arg(QString::number(signal_count), QString::number(UPDATE_COUNT));
+}
+
+
+QTEST_MAIN(bench_GameListModel)
+#include "bench_GameListModel.moc"
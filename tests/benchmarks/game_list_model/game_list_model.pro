@@ -0,0 +1,4 @@
+TARGET = bench_GameListModel
+SOURCES = $${TARGET}.cpp
+
+include($${TOP_SRCDIR}/tests/cxxtest_common.pri)
@@ -0,0 +1,7 @@
+TARGET = bench_Keys
+SOURCES = $${TARGET}.cpp
+
+OTHER_FILES += \
+    tst_keys.qml
+
+include($${TOP_SRCDIR}/tests/qmltest_common.pri)
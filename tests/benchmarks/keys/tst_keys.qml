@@ -0,0 +1,121 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+import QtQuick 2.0
+import QtTest 1.11
+
+
+Item {
+    id: root
+
+    width: 100
+    height: 100
+
+    // the number of key presses per benchmark run
+    readonly property int pressCount: 100
+
+    property bool useMask: false
+    property int lastResult: -1
+
+    readonly property int leftMask: keys.leftMask
+    readonly property int rightMask: keys.rightMask
+    readonly property int upMask: keys.upMask
+    readonly property int downMask: keys.downMask
+    readonly property int acceptMask: keys.acceptMask
+    readonly property int cancelMask: keys.cancelMask
+    readonly property int detailsMask: keys.detailsMask
+    readonly property int filtersMask: keys.filtersMask
+    readonly property int nextPageMask: keys.nextPageMask
+    readonly property int prevPageMask: keys.prevPageMask
+
+    // the checks of a typical theme, an unbound key goes through all of them
+    function classifySeparately(event) {
+        if (keys.isLeft(event)) return 1;
+        if (keys.isRight(event)) return 2;
+        if (keys.isUp(event)) return 3;
+        if (keys.isDown(event)) return 4;
+        if (keys.isAccept(event)) return 5;
+        if (keys.isCancel(event)) return 6;
+        if (keys.isDetails(event)) return 7;
+        if (keys.isFilters(event)) return 8;
+        if (keys.isNextPage(event)) return 9;
+        if (keys.isPrevPage(event)) return 10;
+        return 0;
+    }
+
+    function classifyByMask(event) {
+        const mask = keys.matches(event);
+        if (mask & leftMask) return 1;
+        if (mask & rightMask) return 2;
+        if (mask & upMask) return 3;
+        if (mask & downMask) return 4;
+        if (mask & acceptMask) return 5;
+        if (mask & cancelMask) return 6;
+        if (mask & detailsMask) return 7;
+        if (mask & filtersMask) return 8;
+        if (mask & nextPageMask) return 9;
+        if (mask & prevPageMask) return 10;
+        return 0;
+    }
+
+    Item {
+        focus: true
+        Keys.onPressed: root.lastResult = root.useMask
+            ? root.classifyByMask(event)
+            : root.classifySeparately(event)
+    }
+
+
+    TestCase {
+        when: windowShown
+
+        function classify(key, modifiers, use_mask) {
+            root.useMask = use_mask;
+            root.lastResult = -1;
+            keyClick(key, modifiers);
+            return root.lastResult;
+        }
+
+        function test_same_results_data() {
+            return [
+                { tag: "left", key: Qt.Key_Left, modifiers: Qt.NoModifier },
+                { tag: "accept", key: Qt.Key_Return, modifiers: Qt.NoModifier },
+                { tag: "cancel", key: Qt.Key_Escape, modifiers: Qt.NoModifier },
+                { tag: "details", key: Qt.Key_I, modifiers: Qt.NoModifier },
+                { tag: "unbound", key: Qt.Key_F12, modifiers: Qt.NoModifier },
+                { tag: "modifier", key: Qt.Key_Return, modifiers: Qt.ControlModifier },
+            ];
+        }
+        function test_same_results(data) {
+            const expected = classify(data.key, data.modifiers, false);
+            verify(expected >= 0);
+            compare(classify(data.key, data.modifiers, true), expected);
+        }
+
+        function benchmark_separate_checks() {
+            root.useMask = false;
+            for (let i = 0; i < pressCount; i++)
+                keyClick(Qt.Key_F12);
+        }
+
+        function benchmark_single_match() {
+            root.useMask = true;
+            for (let i = 0; i < pressCount; i++)
+                keyClick(Qt.Key_F12);
+        }
+    }
+}
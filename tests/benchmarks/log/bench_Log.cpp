@@ -0,0 +1,177 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <QtTest/QtTest>
+
+#include "AppSettings.h"
+#include "Log.h"
+#include "Paths.h"
+#include "providers/SearchContext.h"
+#include "providers/pegasus_metadata/PegasusProvider.h"
+
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <memory>
+#include <vector>
+
+
+namespace {
+// A broken library: every game has two issues, and every file has more than
+// what the Pegasus provider would log from it
+constexpr int BROKEN_FILE_COUNT = 50;
+constexpr int BROKEN_GAME_COUNT = 200;
+
+constexpr int THREAD_COUNT = 4;
+constexpr int LINES_PER_THREAD = 5000;
+
+void write_broken_metafile(const QString& path, const QString& name)
+{
+    QFile file(path);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Text));
+
+    QTextStream stream(&file);
+    stream << "collection: " << name << "\n"
+           << "extensions: ext\n\n";
+
+    for (int i = 0; i < BROKEN_GAME_COUNT; i++) {
+        stream << "game: Broken Game " << i << "\n"
+               << "file: game" << i << ".ext\n"
+               << "release: someday\n"
+               << "rating: lots\n\n";
+    }
+}
+
+void log_from_threads()
+{
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        threads.emplace_back(QThread::create([t](){
+            for (int i = 0; i < LINES_PER_THREAD; i++)
+                Log::info(QStringLiteral("Thread %1, message %2").arg(QString::number(t), QString::number(i)));
+        }));
+        threads.back()->start();
+    }
+    for (const auto& thread : threads)
+        thread->wait();
+}
+
+QString log_file_path()
+{
+    return paths::writableConfigDir() + QLatin1String("/lastrun.log");
+}
+} // namespace
+
+
+class bench_Log : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        QVERIFY(QDir().mkpath(paths::writableConfigDir()));
+
+        // the games don't exist
+        AppSettings::general.verify_files = false;
+
+        QVERIFY(m_dir.isValid());
+        for (int i = 0; i < BROKEN_FILE_COUNT; i++) {
+            const QString name = QStringLiteral("Broken%1").arg(i);
+            write_broken_metafile(m_dir.filePath(name + QStringLiteral(".metadata.pegasus.txt")), name);
+        }
+    }
+    void cleanup() {
+        Log::close();
+    }
+
+    void scan_logging_off();
+    void scan_logging_on();
+    void lines_logging_on();
+    void threads_logging_on();
+    void threads_no_lost_lines();
+};
+
+void bench_Log::scan_logging_off()
+{
+    providers::pegasus::PegasusProvider provider;
+
+    QBENCHMARK {
+        providers::SearchContext sctx({m_dir.path()});
+        provider.run(sctx);
+    }
+}
+
+void bench_Log::scan_logging_on()
+{
+    Log::init(true);
+    providers::pegasus::PegasusProvider provider;
+
+    QBENCHMARK {
+        providers::SearchContext sctx({m_dir.path()});
+        provider.run(sctx);
+        Log::flush();
+    }
+}
+
+void bench_Log::lines_logging_on()
+{
+    Log::init(true);
+
+    QBENCHMARK {
+        for (int i = 0; i < LINES_PER_THREAD; i++)
+            Log::info(QStringLiteral("Message %1").arg(QString::number(i)));
+        Log::flush();
+    }
+}
+
+void bench_Log::threads_logging_on()
+{
+    Log::init(true);
+
+    QBENCHMARK {
+        log_from_threads();
+        Log::flush();
+    }
+}
+
+void bench_Log::threads_no_lost_lines()
+{
+    Log::init(true);
+    log_from_threads();
+    Log::close();
+
+    QFile file(log_file_path());
+    QVERIFY(file.open(QFile::ReadOnly | QFile::Text));
+
+    int line_count = 0;
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        if (stream.readLine().contains(QLatin1String("Thread ")))
+            line_count++;
+    }
+    QCOMPARE(line_count, THREAD_COUNT * LINES_PER_THREAD);
+}
+
+
+QTEST_MAIN(bench_Log)
+#include "bench_Log.moc"
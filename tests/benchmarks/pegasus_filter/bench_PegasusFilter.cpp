@@ -0,0 +1,141 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <QtTest/QtTest>
+
+#include "Log.h"
+#include "model/gaming/Collection.h"
+#include "providers/SearchContext.h"
+#include "providers/pegasus_metadata/PegasusFilter.h"
+#include "utils/PathTools.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QTemporaryDir>
+
+
+namespace {
+// The number of files matched by extension, and also the size of the include and exclude lists
+constexpr int LIST_SIZE = 10000;
+
+void touch(const QString& path)
+{
+    QFile file(path);
+    QVERIFY(file.open(QFile::WriteOnly));
+}
+
+providers::pegasus::FileFilter create_filter(model::Collection* collection, const QString& dir)
+{
+    providers::pegasus::FileFilter filter(collection, dir);
+    filter.include.extensions = { QStringLiteral("ext") };
+    filter.exclude.extensions = { QStringLiteral("bak"), QStringLiteral("tmp") };
+    filter.exclude.regex = QRegularExpression(QStringLiteral("[/\\\\]ignored[^/\\\\]*$"));
+
+    filter.include.files.reserve(LIST_SIZE);
+    filter.exclude.files.reserve(LIST_SIZE);
+    for (int i = 0; i < LIST_SIZE; i++) {
+        filter.include.files.emplace_back(QStringLiteral("extra%1.dat").arg(i));
+        // half of them exist, the rest is never found
+        filter.exclude.files.emplace_back(i % 2
+            ? QStringLiteral("game%1.ext").arg(i)
+            : QStringLiteral("missing%1.ext").arg(i));
+    }
+    return filter;
+}
+} // namespace
+
+
+class bench_PegasusFilter : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+private slots:
+    void initTestCase() {
+        Log::init_qttest();
+
+        QVERIFY(m_dir.isValid());
+        for (int i = 0; i < LIST_SIZE; i++) {
+            touch(m_dir.filePath(QStringLiteral("game%1.ext").arg(i)));
+            touch(m_dir.filePath(QStringLiteral("extra%1.dat").arg(i)));
+        }
+        for (int i = 0; i < 100; i++) {
+            touch(m_dir.filePath(QStringLiteral("game%1.bak").arg(i)));
+            touch(m_dir.filePath(QStringLiteral("ignored%1.ext").arg(i)));
+        }
+    }
+
+    void compile_large_lists();
+    void match_large_lists();
+    void scan_large_lists();
+};
+
+void bench_PegasusFilter::compile_large_lists()
+{
+    model::Collection collection(QStringLiteral("Test"));
+    const providers::pegasus::FileFilter filter = create_filter(&collection, m_dir.path());
+
+    size_t include_count = 0;
+    QBENCHMARK {
+        const providers::pegasus::CompiledFilter compiled(filter);
+        include_count = compiled.include_files().size();
+    }
+    QCOMPARE(include_count, static_cast<size_t>(LIST_SIZE));
+}
+
+void bench_PegasusFilter::match_large_lists()
+{
+    model::Collection collection(QStringLiteral("Test"));
+    const providers::pegasus::FileFilter filter = create_filter(&collection, m_dir.path());
+    const providers::pegasus::CompiledFilter compiled(filter);
+
+    std::vector<std::pair<QFileInfo, QString>> files;
+    QDirIterator dir_it(m_dir.path(), QDir::Files | QDir::NoDotAndDotDot);
+    while (dir_it.hasNext()) {
+        dir_it.next();
+        files.emplace_back(dir_it.fileInfo(), ::clean_abs_path(dir_it.fileInfo()));
+    }
+
+    // without the directory walk
+    int passed = 0;
+    QBENCHMARK {
+        passed = 0;
+        for (const auto& entry : files)
+            passed += compiled.passes(entry.first, entry.second);
+    }
+    QCOMPARE(passed, LIST_SIZE / 2);
+}
+
+void bench_PegasusFilter::scan_large_lists()
+{
+    // the listed extras, and every even game
+    constexpr size_t expected_count = LIST_SIZE + LIST_SIZE / 2;
+
+    QBENCHMARK {
+        providers::SearchContext sctx;
+        model::Collection* collection = sctx.get_or_create_collection(QStringLiteral("Test"));
+        providers::pegasus::FileFilter filter = create_filter(collection, m_dir.path());
+        providers::pegasus::apply_filter(filter, sctx);
+        QCOMPARE(sctx.current_filepath_to_entry_map().size(), expected_count);
+    }
+}
+
+
+QTEST_MAIN(bench_PegasusFilter)
+#include "bench_PegasusFilter.moc"
@@ -17,23 +17,90 @@
 
 #include <QtTest/QtTest>
 
+#include "AppSettings.h"
 #include "Log.h"
+#include "parsers/MetaFile.h"
 #include "providers/SearchContext.h"
 #include "providers/pegasus_metadata/PegasusProvider.h"
 
 #include <QString>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+
+namespace {
+// Roughly 12 MB of metadata, similar to the generated ones of large collections
+constexpr int LARGE_GAME_COUNT = 20000;
+// The same amount, split into per-system files
+constexpr int SPLIT_FILE_COUNT = 16;
+
+void write_large_metafile(const QString& path, const QString& name, const int first_game, const int game_count)
+{
+    QFile file(path);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Text));
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    stream << "collection: " << name << "\n"
+           << "shortname: " << name.toLower() << "\n"
+           << "extensions: ext, bin\n"
+           << "launch: emulator \"{file.path}\"\n\n";
+
+    for (int i = first_game; i < first_game + game_count; i++) {
+        stream << "game: Generated Game Nr. " << i << QStringLiteral(" \u00e9dition\n")
+               << "file: game" << i << ".ext\n"
+               << "developer: Developer " << (i % 97) << "\n"
+               << "publisher: Publisher " << (i % 31) << "\n"
+               << "genre: Action, Platform\n"
+               << "players: 1-" << (1 + i % 4) << "\n"
+               << "release: " << (1980 + i % 40) << "-0" << (1 + i % 9) << "-1" << (i % 9) << "\n"
+               << "rating: " << (i % 100) << "%\n"
+               << "x-id: " << i << "\n"
+               << "assets.boxfront: media/game" << i << "/boxFront.png\n"
+               << "description:\n";
+        for (int line = 0; line < 4; line++) {
+            stream << "  Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor\n"
+                   << "  incididunt ut labore et dolore magna aliqua.\n";
+        }
+        stream << "  .\n"
+               << "  Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris.\n\n";
+    }
+}
+} // namespace
 
 
 class bench_PegasusProvider : public QObject {
     Q_OBJECT
 
+private:
+    QTemporaryDir m_large_dir;
+    QTemporaryDir m_split_dir;
+    QString large_metafile_path() const { return m_large_dir.filePath(QStringLiteral("metadata.pegasus.txt")); }
+
 private slots:
     void initTestCase() {
         Log::init_qttest();
+
+        QVERIFY(m_large_dir.isValid());
+        write_large_metafile(large_metafile_path(), QStringLiteral("Large"), 0, LARGE_GAME_COUNT);
+
+        QVERIFY(m_split_dir.isValid());
+        constexpr int games_per_file = LARGE_GAME_COUNT / SPLIT_FILE_COUNT;
+        for (int i = 0; i < SPLIT_FILE_COUNT; i++) {
+            const QString name = QStringLiteral("System%1").arg(i);
+            write_large_metafile(m_split_dir.filePath(name + QStringLiteral(".metadata.pegasus.txt")),
+                                 name, i * games_per_file, games_per_file);
+        }
     }
 
     void find_in_empty_dir();
     void find_in_filled_dir();
+    void find_in_large_dir();
+    void find_in_split_dir();
+
+    void parse_large_same_results();
+    void parse_large_stream();
+    void parse_large_mapped();
 };
 
 void bench_PegasusProvider::find_in_empty_dir()
@@ -61,6 +128,113 @@ void bench_PegasusProvider::find_in_filled_dir()
     }
 }
 
+void bench_PegasusProvider::find_in_large_dir()
+{
+    // the generated games don't exist
+    const bool verify_files = AppSettings::general.verify_files;
+    AppSettings::general.verify_files = false;
+
+    providers::pegasus::PegasusProvider provider;
+
+    const QString msg = QStringLiteral("Pegasus Metafiles: Found `%1`")
+        .arg(QDir::toNativeSeparators(large_metafile_path()));
+
+    QBENCHMARK {
+        providers::SearchContext sctx({m_large_dir.path()});
+        QTest::ignoreMessage(QtInfoMsg, qUtf8Printable(msg));
+        provider.run(sctx);
+        QCOMPARE(sctx.current_filepath_to_entry_map().size(), static_cast<size_t>(LARGE_GAME_COUNT));
+    }
+
+    AppSettings::general.verify_files = verify_files;
+}
+
+void bench_PegasusProvider::find_in_split_dir()
+{
+    const bool verify_files = AppSettings::general.verify_files;
+    AppSettings::general.verify_files = false;
+
+    providers::pegasus::PegasusProvider provider;
+
+    // the files are read in parallel, but applied in order
+    QBENCHMARK {
+        providers::SearchContext sctx({m_split_dir.path()});
+        for (int i = 0; i < SPLIT_FILE_COUNT; i++)
+            QTest::ignoreMessage(QtInfoMsg, QRegularExpression(QStringLiteral("Found `.*`")));
+        provider.run(sctx);
+        QCOMPARE(sctx.current_collection_map().size(), static_cast<size_t>(SPLIT_FILE_COUNT));
+    }
+
+    AppSettings::general.verify_files = verify_files;
+}
+
+void bench_PegasusProvider::parse_large_same_results()
+{
+    using Attrib = std::pair<QString, std::vector<QString>>;
+    const auto on_error = [](const metafile::Error&){ QFAIL("Unexpected parse error"); };
+
+    std::vector<Attrib> stream_attribs;
+    metafile::read_file(large_metafile_path(),
+        [&](const metafile::Entry& entry){ stream_attribs.emplace_back(entry.key, entry.values); },
+        on_error);
+
+    std::vector<Attrib> mapped_attribs;
+    metafile::Entry entry {0, {}, {}};
+    metafile::read_mapped_file(large_metafile_path(),
+        [&](const metafile::EntryView& entry_view){
+            entry_view.copy_to(entry);
+            mapped_attribs.emplace_back(entry.key, entry.values);
+        },
+        on_error);
+
+    QVERIFY(!stream_attribs.empty());
+    QVERIFY(stream_attribs == mapped_attribs);
+}
+
+void bench_PegasusProvider::parse_large_stream()
+{
+    size_t entry_count = 0;
+    size_t value_count = 0;
+
+    QBENCHMARK {
+        entry_count = 0;
+        value_count = 0;
+        metafile::read_file(large_metafile_path(),
+            [&](const metafile::Entry& entry){
+                entry_count++;
+                value_count += entry.values.size();
+            },
+            [](const metafile::Error&){ QFAIL("Unexpected parse error"); });
+    }
+
+    QVERIFY(entry_count > static_cast<size_t>(LARGE_GAME_COUNT));
+    QVERIFY(value_count > entry_count);
+}
+
+void bench_PegasusProvider::parse_large_mapped()
+{
+    size_t entry_count = 0;
+    size_t value_count = 0;
+    metafile::Entry entry {0, {}, {}};
+
+    // decodes every value, like the provider does
+    QBENCHMARK {
+        entry_count = 0;
+        value_count = 0;
+        metafile::read_mapped_file(large_metafile_path(),
+            [&](const metafile::EntryView& entry_view){
+                entry_view.copy_to(entry);
+                entry_count++;
+                value_count += entry.values.size();
+                entry.reset();
+            },
+            [](const metafile::Error&){ QFAIL("Unexpected parse error"); });
+    }
+
+    QVERIFY(entry_count > static_cast<size_t>(LARGE_GAME_COUNT));
+    QVERIFY(value_count > entry_count);
+}
+
 
 QTEST_MAIN(bench_PegasusProvider)
 #include "bench_PegasusProvider.moc"
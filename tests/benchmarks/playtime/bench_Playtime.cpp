@@ -0,0 +1,198 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <QtTest/QtTest>
+
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
+#include "providers/SearchContext.h"
+#include "providers/pegasus_playtime/PlaytimeStats.h"
+
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+
+namespace {
+constexpr int PATH_COUNT = 5000;
+constexpr int PLAY_COUNT = 1000000;
+
+QString game_path(int idx)
+{
+    return QStringLiteral("/roms/game%1.bin").arg(idx);
+}
+
+// Creates a database in the format of previous versions, with no summary table
+bool create_history_db(const QString& db_path)
+{
+    const QString connection = QStringLiteral("bench_setup");
+    bool success = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connection);
+        db.setDatabaseName(db_path);
+        if (!db.open())
+            return false;
+
+        db.transaction();
+
+        QSqlQuery query(db);
+        success &= query.exec(QStringLiteral(
+            "CREATE TABLE paths(id INTEGER PRIMARY KEY, path TEXT UNIQUE NOT NULL);"));
+        success &= query.exec(QStringLiteral(
+            "CREATE TABLE plays(id INTEGER PRIMARY KEY, path_id INTEGER NOT NULL REFERENCES plays(id),"
+            " start_time INTEGER NOT NULL, duration INTEGER NOT NULL);"));
+
+        query.prepare(QStringLiteral("INSERT INTO paths VALUES(?, ?);"));
+        for (int i = 0; i < PATH_COUNT && success; i++) {
+            query.addBindValue(i + 1);
+            query.addBindValue(game_path(i));
+            success &= query.exec();
+        }
+
+        QRandomGenerator rng(42);
+        qint64 start_time = 1500000000;
+        query.prepare(QStringLiteral("INSERT INTO plays VALUES(null, ?, ?, ?);"));
+        for (int i = 0; i < PLAY_COUNT && success; i++) {
+            const qint64 duration = rng.bounded(7200);
+            query.addBindValue(rng.bounded(PATH_COUNT) + 1);
+            query.addBindValue(start_time);
+            query.addBindValue(duration);
+            success &= query.exec();
+            start_time += duration + rng.bounded(600);
+        }
+
+        success &= db.commit();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connection);
+    return success;
+}
+
+void create_games(providers::SearchContext& sctx)
+{
+    model::Collection& collection = *sctx.get_or_create_collection(QStringLiteral("coll"));
+    for (int i = 0; i < PATH_COUNT; i++) {
+        model::Game& game = *sctx.create_game_for(collection);
+        sctx.game_add_filepath(game, game_path(i));
+    }
+}
+
+int total_playcount(const providers::SearchContext& sctx)
+{
+    int sum = 0;
+    for (int i = 0; i < PATH_COUNT; i++)
+        sum += sctx.gamefile_by_filepath(game_path(i))->playCount();
+    return sum;
+}
+} // namespace
+
+
+class bench_Playtime : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_tmp_dir;
+    QString m_history_db;
+
+private slots:
+    void initTestCase();
+
+    void history_query();
+    void first_run();
+    void run();
+};
+
+void bench_Playtime::initTestCase()
+{
+    QVERIFY(m_tmp_dir.isValid());
+    m_history_db = m_tmp_dir.filePath(QStringLiteral("history.db"));
+    QVERIFY(create_history_db(m_history_db));
+}
+
+// What reading the stats used to cost: every play row is sent to C++
+void bench_Playtime::history_query()
+{
+    const QString connection = QStringLiteral("bench_history");
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connection);
+        db.setDatabaseName(m_history_db);
+        QVERIFY(db.open());
+
+        QBENCHMARK {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            QVERIFY(query.exec(QStringLiteral(
+                "SELECT paths.path, plays.start_time, plays.duration"
+                " FROM plays"
+                " INNER JOIN paths ON plays.path_id=paths.id;")));
+
+            int rows = 0;
+            while (query.next())
+                rows++;
+            QCOMPARE(rows, PLAY_COUNT);
+        }
+
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connection);
+}
+
+// Includes building the summary table from the history
+void bench_Playtime::first_run()
+{
+    const QString db_path = m_tmp_dir.filePath(QStringLiteral("first_run.db"));
+    QVERIFY(QFile::copy(m_history_db, db_path));
+
+    providers::SearchContext sctx;
+    create_games(sctx);
+
+    QBENCHMARK_ONCE {
+        providers::playtime::PlaytimeStats(db_path).run(sctx);
+    }
+
+    QCOMPARE(total_playcount(sctx), PLAY_COUNT);
+    sctx.finalize(this->thread());
+}
+
+void bench_Playtime::run()
+{
+    const QString db_path = m_tmp_dir.filePath(QStringLiteral("summary.db"));
+    QVERIFY(QFile::copy(m_history_db, db_path));
+    {
+        providers::SearchContext sctx;
+        create_games(sctx);
+        providers::playtime::PlaytimeStats(db_path).run(sctx);
+        sctx.finalize(this->thread());
+    }
+
+    providers::SearchContext sctx;
+    create_games(sctx);
+    providers::playtime::PlaytimeStats playtime(db_path);
+
+    QBENCHMARK {
+        playtime.run(sctx);
+    }
+
+    sctx.finalize(this->thread());
+}
+
+
+QTEST_MAIN(bench_Playtime)
+#include "bench_Playtime.moc"
@@ -0,0 +1,102 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <QtTest/QtTest>
+
+#include "Log.h"
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "providers/SearchContext.h"
+
+#include <QElapsedTimer>
+
+
+class bench_SearchContext : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        Log::init_qttest();
+    }
+
+    void add_games_to_collections_data();
+    void add_games_to_collections();
+};
+
+void bench_SearchContext::add_games_to_collections_data()
+{
+    QTest::addColumn<int>("game_count");
+    QTest::addColumn<int>("collection_count");
+
+    for (const int game_count : { 1000, 10000, 50000, 100000, 200000 }) {
+        for (const int collection_count : { 1, 16 }) {
+            const QByteArray name = QByteArray::number(game_count) + " games, "
+                                  + QByteArray::number(collection_count) + " collections";
+            QTest::newRow(name.constData()) << game_count << collection_count;
+        }
+    }
+}
+
+// Reports the time of one insert, which should not grow with the number of games
+void bench_SearchContext::add_games_to_collections()
+{
+    QFETCH(int, game_count);
+    QFETCH(int, collection_count);
+
+    providers::SearchContext sctx;
+
+    std::vector<model::Collection*> collections;
+    for (int i = 0; i < collection_count; i++)
+        collections.emplace_back(sctx.get_or_create_collection(QStringLiteral("Collection %1").arg(i)));
+    model::Collection* const all_games = sctx.get_or_create_collection(QStringLiteral("All"));
+
+    // the games start out without a collection
+    std::vector<model::Game*> games;
+    games.reserve(game_count);
+    for (int i = 0; i < game_count; i++) {
+        model::Game* const game = sctx.create_game();
+        sctx.game_add_filepath(*game, QStringLiteral("/games/game%1.ext").arg(i));
+        games.emplace_back(game);
+    }
+
+    // every game is added twice to the same collection, like when
+    // multiple sources find it
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < game_count; i++) {
+        model::Game& game = *games[i];
+        model::Collection& collection = *collections[i % collection_count];
+        sctx.game_add_to(game, collection);
+        sctx.game_add_to(game, *all_games);
+        sctx.game_add_to(game, collection);
+    }
+    const qint64 elapsed_ns = timer.nsecsElapsed();
+
+    const qreal insert_count = game_count * 3.0;
+    QTest::setBenchmarkResult(elapsed_ns / insert_count, QTest::WalltimeNanoseconds);
+
+    QObject parent;
+    const auto results = sctx.finalize(&parent);
+    QCOMPARE(results.first.size(), static_cast<size_t>(collection_count + 1));
+    QCOMPARE(results.second.size(), static_cast<size_t>(game_count));
+    QCOMPARE(all_games->gameList()->entries().size(), static_cast<size_t>(game_count));
+}
+
+
+QTEST_MAIN(bench_SearchContext)
+#include "bench_SearchContext.moc"
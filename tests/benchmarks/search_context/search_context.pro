@@ -0,0 +1,4 @@
+TARGET = bench_SearchContext
+SOURCES = $${TARGET}.cpp
+
+include($${TOP_SRCDIR}/tests/cxxtest_common.pri)
@@ -0,0 +1,149 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <QtTest/QtTest>
+
+#include "model/gaming/SortRank.h"
+
+#include <QRandomGenerator>
+#include <algorithm>
+#include <random>
+
+
+namespace {
+constexpr int TITLE_COUNT = 100000;
+
+// Has the same interface as games and collections
+struct Item {
+    QString sort_by;
+    int sort_rank = 0;
+
+    const QString& sortBy() const { return sort_by; }
+    void setSortRank(int rank) { sort_rank = rank; }
+};
+
+std::vector<Item> create_items()
+{
+    const QStringList words {
+        QStringLiteral("Super"), QStringLiteral("Dragon"), QStringLiteral("\u00c9lan"), QStringLiteral("\u014ckami"),
+        QStringLiteral("Stra\u00dfe"), QStringLiteral("\u00c1ngel"), QStringLiteral("zero"), QStringLiteral("Quest"),
+        QStringLiteral("\u041a\u043e\u0441\u043c\u043e\u0441"), QStringLiteral("\u0413\u0435\u0440\u043e\u0439"), QStringLiteral("\u03a9\u03bc\u03ad\u03b3\u03b1"), QStringLiteral("\u0386\u03bb\u03c6\u03b1"),
+        QStringLiteral("\u30c9\u30e9\u30b4\u30f3"), QStringLiteral("\u9b54\u754c\u6751"), QStringLiteral("\uc2a4\ud0c0"), QStringLiteral("\u4e09\u56fd\u5fd7"),
+    };
+
+    QRandomGenerator rng(42);
+    std::vector<Item> items(TITLE_COUNT);
+    for (int i = 0; i < TITLE_COUNT; i++) {
+        QString title = words.at(rng.bounded(words.size()));
+        title += QLatin1Char(' ') + words.at(rng.bounded(words.size()));
+        title += QLatin1Char(' ') + QString::number(rng.bounded(100));
+        items[i].sort_by = std::move(title);
+    }
+    return items;
+}
+
+std::vector<Item*> shuffled_ptrs(std::vector<Item>& items)
+{
+    std::vector<Item*> ptrs;
+    ptrs.reserve(items.size());
+    for (Item& item : items)
+        ptrs.push_back(&item);
+
+    std::shuffle(ptrs.begin(), ptrs.end(), std::mt19937(7));
+    return ptrs;
+}
+} // namespace
+
+
+class bench_SortRanks : public QObject {
+    Q_OBJECT
+
+private:
+    std::vector<Item> m_items;
+
+private slots:
+    void initTestCase() {
+        m_items = create_items();
+    }
+
+    void sort_locale_aware_compare();
+    void sort_collator_compare();
+    void assign_ranks();
+    void sort_by_ranks();
+};
+
+// The previous way of sorting
+void bench_SortRanks::sort_locale_aware_compare()
+{
+    const std::vector<Item*> input = shuffled_ptrs(m_items);
+
+    QBENCHMARK {
+        std::vector<Item*> ptrs = input;
+        std::sort(ptrs.begin(), ptrs.end(),
+            [](const Item* a, const Item* b){ return QString::localeAwareCompare(a->sort_by, b->sort_by) < 0; });
+    }
+}
+
+void bench_SortRanks::sort_collator_compare()
+{
+    const std::vector<Item*> input = shuffled_ptrs(m_items);
+    const QCollator collator = model::sort_collator();
+
+    QBENCHMARK {
+        std::vector<Item*> ptrs = input;
+        std::sort(ptrs.begin(), ptrs.end(),
+            [&collator](const Item* a, const Item* b){ return collator.compare(a->sort_by, b->sort_by) < 0; });
+    }
+}
+
+// Done once per scan, for all games
+void bench_SortRanks::assign_ranks()
+{
+    const std::vector<Item*> input = shuffled_ptrs(m_items);
+
+    QBENCHMARK {
+        std::vector<Item*> ptrs = input;
+        model::assign_sort_ranks(ptrs);
+    }
+
+    std::vector<Item*> ptrs = input;
+    model::assign_sort_ranks(ptrs);
+    const QCollator collator = model::sort_collator();
+    for (size_t i = 1; i < ptrs.size(); i++) {
+        QVERIFY(ptrs[i - 1]->sort_rank <= ptrs[i]->sort_rank);
+        QVERIFY(collator.compare(ptrs[i - 1]->sort_by, ptrs[i]->sort_by) <= 0);
+    }
+}
+
+// Done for every collection
+void bench_SortRanks::sort_by_ranks()
+{
+    std::vector<Item*> input = shuffled_ptrs(m_items);
+    model::assign_sort_ranks(input);
+    std::shuffle(input.begin(), input.end(), std::mt19937(7));
+
+    QBENCHMARK {
+        std::vector<Item*> ptrs = input;
+        std::sort(ptrs.begin(), ptrs.end(),
+            [](const Item* a, const Item* b){ return a->sort_rank < b->sort_rank; });
+    }
+}
+
+
+QTEST_MAIN(bench_SortRanks)
+#include "bench_SortRanks.moc"
@@ -0,0 +1,13 @@
+TARGET = test_ApngCache
+SOURCES = $${TARGET}.cpp
+RESOURCES += data.qrc
+
+# shares the directory with apng.pro
+OBJECTS_DIR = .obj_cache
+MOC_DIR = .moc_cache
+RCC_DIR = .rcc_cache
+
+INCLUDEPATH += $${TOP_SRCDIR}/thirdparty/apng
+
+include($${TOP_SRCDIR}/tests/cxxtest_common.pri)
+include($${TOP_SRCDIR}/thirdparty/link_to_png.pri)
@@ -0,0 +1,143 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2021  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "apngreader_p.h"
+
+
+// `long.apng` is a 128x128 image with 200 frames. Every 10th frame covers
+// the whole image, the others only one quarter, cycling through them, so
+// the result depends on the previous frames too.
+namespace {
+constexpr int FRAME_COUNT = 200;
+constexpr int IMAGE_SIZE = 128;
+constexpr qint64 FRAME_BYTES = IMAGE_SIZE * IMAGE_SIZE * 4;
+
+QColor frame_color(int frame)
+{
+    return QColor(frame % 256, (frame * 7) % 256, (frame * 13) % 256);
+}
+
+QColor expected_color(int frame, int quarter)
+{
+    const int keyframe = frame - frame % 10;
+    int last_change = keyframe;
+    for (int i = keyframe + 1; i <= frame; i++) {
+        if (i % 4 == quarter)
+            last_change = i;
+    }
+    return frame_color(last_change);
+}
+
+bool frame_correct(const QImage& image, int frame)
+{
+    if (image.size() != QSize(IMAGE_SIZE, IMAGE_SIZE))
+        return false;
+
+    for (int quarter = 0; quarter < 4; quarter++) {
+        const int x = (quarter % 2) * IMAGE_SIZE / 2 + IMAGE_SIZE / 4;
+        const int y = (quarter / 2) * IMAGE_SIZE / 2 + IMAGE_SIZE / 4;
+        if (image.pixelColor(x, y) != expected_color(frame, quarter))
+            return false;
+    }
+    return true;
+}
+} // namespace
+
+
+class test_ApngCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void sequential_loops();
+    void random_access();
+    void unbounded();
+
+private:
+    QFile m_file;
+};
+
+void test_ApngCache::init()
+{
+    m_file.setFileName(QStringLiteral(":/long.apng"));
+    QVERIFY(m_file.open(QIODevice::ReadOnly));
+}
+
+void test_ApngCache::cleanup()
+{
+    m_file.close();
+}
+
+void test_ApngCache::sequential_loops()
+{
+    constexpr qint64 budget = 16 * FRAME_BYTES;
+
+    ApngReader reader;
+    reader.setCacheBudget(budget);
+    QVERIFY(reader.init(&m_file));
+    QVERIFY(reader.isAnimated());
+    QCOMPARE(reader.frames(), static_cast<quint32>(FRAME_COUNT));
+
+    for (int loop = 0; loop < 3; loop++) {
+        for (int frame = 0; frame < FRAME_COUNT; frame++) {
+            const ApngReader::ApngFrame image = reader.readFrame(frame);
+            QVERIFY2(frame_correct(image, frame), qPrintable(QStringLiteral("frame %1").arg(frame)));
+            QCOMPARE(image.delayMsec(), 40);
+        }
+    }
+
+    QVERIFY(reader.cacheBytes() <= budget);
+    // one frame may be over the budget, until the oldest one is dropped
+    QVERIFY(reader.peakCacheBytes() <= budget + FRAME_BYTES);
+}
+
+void test_ApngCache::random_access()
+{
+    constexpr qint64 budget = 4 * FRAME_BYTES;
+
+    ApngReader reader;
+    reader.setCacheBudget(budget);
+    QVERIFY(reader.init(&m_file));
+
+    for (const int frame : { 150, 10, 199, 0, 57, 56, 3, 198 }) {
+        const ApngReader::ApngFrame image = reader.readFrame(frame);
+        QVERIFY2(frame_correct(image, frame), qPrintable(QStringLiteral("frame %1").arg(frame)));
+    }
+
+    QVERIFY(reader.peakCacheBytes() <= budget + FRAME_BYTES);
+    QCOMPARE(reader.frameDelayMsec(5), 40);
+}
+
+void test_ApngCache::unbounded()
+{
+    ApngReader reader;
+    reader.setCacheBudget(0);
+    QVERIFY(reader.init(&m_file));
+
+    for (int frame = 0; frame < FRAME_COUNT; frame++)
+        QVERIFY(frame_correct(reader.readFrame(frame), frame));
+
+    QCOMPARE(reader.cacheBytes(), FRAME_COUNT * FRAME_BYTES);
+}
+
+
+QTEST_MAIN(test_ApngCache)
+#include "test_ApngCache.moc"
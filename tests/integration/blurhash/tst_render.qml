@@ -23,6 +23,12 @@ Rectangle {
     id: root
 
     readonly property int imgSize: 24
+    readonly property var hashes: [
+        "LEHV6nWB2yk8pyoJadR*.7kCMdnj",
+        "LGF5]+Yk^6#M@-5c,1J5@[or[Q6.",
+        "L6Pj0^i_.AyE_3t7t7R**0o#DgR4",
+        "LKO2?U%2Tw=w]~RBVZRi};RPxuwH",
+    ]
 
     width: actual.width + expected.width
     height: actual.height
@@ -33,12 +39,7 @@ Rectangle {
         columns: 2
 
         Repeater {
-            model: [
-                "LEHV6nWB2yk8pyoJadR*.7kCMdnj",
-                "LGF5]+Yk^6#M@-5c,1J5@[or[Q6.",
-                "L6Pj0^i_.AyE_3t7t7R**0o#DgR4",
-                "LKO2?U%2Tw=w]~RBVZRi};RPxuwH",
-            ]
+            model: hashes
             delegate: Image {
                 source: "image://blurhash/" + encodeURIComponent(modelData)
                 width: imgSize
@@ -55,9 +56,35 @@ Rectangle {
     }
 
 
+    Image {
+        id: benchImage
+        asynchronous: false
+        cache: false
+        visible: false
+    }
+
+
     TestCase {
         when: windowShown
 
+        function loadBenchImage(hash, width, height) {
+            benchImage.source = "";
+            benchImage.sourceSize = Qt.size(width, height);
+            benchImage.source = "image://blurhash/" + encodeURIComponent(hash);
+            compare(benchImage.status, Image.Ready);
+        }
+
+        // every size is different, so nothing comes from the provider's cache
+        function benchmark_once_decode_256() {
+            for (let i = 0; i < 64; i++)
+                loadBenchImage(hashes[i % hashes.length], 256, 256 - i);
+        }
+
+        function benchmark_cached_256() {
+            for (let i = 0; i < hashes.length; i++)
+                loadBenchImage(hashes[i], 256, 256);
+        }
+
         function test_render() {
             const actual_img = grabImage(actual);
             const expected_img = grabImage(expected);
@@ -5,4 +5,8 @@ SUBDIRS += \
     blurhash \
 
 !isEmpty(USE_SDL_GAMEPAD): SUBDIRS += sdl_gamepad
-!isEmpty(ENABLE_APNG): SUBDIRS += apng
+!isEmpty(ENABLE_APNG) {
+    SUBDIRS += apng apng_cache
+    apng_cache.file = apng/apng_cache.pro
+    apng_cache.makefile = Makefile.cache
+}
@@ -17,6 +17,9 @@
 
 #include <QtTest/QtTest>
 
+#include "CliArgs.h"
+#include "model/internal/GamepadManagerSDL2.h"
+
 #include <SDL.h>
 
 
@@ -25,6 +28,7 @@ class test_SdlGamepad : public QObject {
 
 private slots:
     void inits();
+    void virtual_button();
 };
 
 void test_SdlGamepad::inits()
@@ -33,6 +37,47 @@ void test_SdlGamepad::inits()
     SDL_Quit();
 }
 
+void test_SdlGamepad::virtual_button()
+{
+#if SDL_VERSION_ATLEAST(2, 0, 14)
+    model::GamepadManagerSDL2 manager(nullptr);
+    QSignalSpy connected_spy(&manager, &model::GamepadManagerBackend::connected);
+
+    std::vector<std::pair<GamepadButton, bool>> button_events;
+    connect(&manager, &model::GamepadManagerBackend::buttonChanged,
+        [&button_events](int, GamepadButton button, bool pressed){ button_events.emplace_back(button, pressed); });
+
+    backend::CliArgs args;
+    args.enable_gamepad_autoconfig = false;
+    manager.start(args);
+
+    // the events of the virtual device go through the input thread like real ones
+    const int device_idx = SDL_JoystickAttachVirtual(SDL_JOYSTICK_TYPE_GAMECONTROLLER, 6, 16, 0);
+    QVERIFY(device_idx >= 0);
+    QVERIFY(connected_spy.wait());
+
+    SDL_Joystick* const joystick = SDL_JoystickOpen(device_idx);
+    QVERIFY(joystick);
+    QCOMPARE(SDL_JoystickSetVirtualButton(joystick, SDL_CONTROLLER_BUTTON_A, SDL_PRESSED), 0);
+    QTRY_COMPARE(button_events.size(), size_t(1));
+    QCOMPARE(button_events.front().first, GamepadButton::SOUTH);
+    QCOMPARE(button_events.front().second, true);
+
+    QCOMPARE(SDL_JoystickSetVirtualButton(joystick, SDL_CONTROLLER_BUTTON_A, SDL_RELEASED), 0);
+    QTRY_COMPARE(button_events.size(), size_t(2));
+    QCOMPARE(button_events.back().second, false);
+
+    QVERIFY(manager.input_latency().count() >= 3);
+    QVERIFY(manager.input_latency().percentile(0) <= manager.input_latency().percentile(100));
+
+    SDL_JoystickClose(joystick);
+    SDL_JoystickDetachVirtual(device_idx);
+    manager.stop();
+#else
+    QSKIP("Virtual joysticks require SDL 2.0.14");
+#endif
+}
+
 
 QTEST_MAIN(test_SdlGamepad)
 #include "test_SdlGamepad.moc"
@@ -101,7 +101,7 @@ int ApngImageHandler::nextImageDelay() const
 	if(_index == 0 || _index > _reader->frames())
 		return 0;
 	else
-		return _reader->readFrame(_index - 1).delayMsec();
+		return _reader->frameDelayMsec(_index - 1);
 }
 
 int ApngImageHandler::currentImageNumber() const
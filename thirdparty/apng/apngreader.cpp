@@ -11,13 +11,15 @@ ApngReader::ApngReader(QObject *parent) :
 
 ApngReader::~ApngReader()
 {
-	if(_png)
-		png_destroy_read_struct(&_png, &_info, nullptr);
+	resetDecoder();
+}
 
-	if (_frame.rows)
-		delete[] _frame.rows;
-	if (_frame.p)
-		delete[] _frame.p;
+qint64 ApngReader::defaultCacheBudget()
+{
+	// PEGASUS_APNG_CACHE_MB=0 keeps every frame
+	bool ok = false;
+	const int megabytes = qEnvironmentVariableIntValue("PEGASUS_APNG_CACHE_MB", &ok);
+	return static_cast<qint64>(ok ? qMax(0, megabytes) : 32) * 1024 * 1024;
 }
 
 bool ApngReader::checkPngSig(QIODevice *device)
@@ -34,7 +36,7 @@ bool ApngReader::init(QIODevice *device)
 {
 	if (_device == device) {
 		if (_device->pos() < _infoOffset) {
-			_allFrames.clear();
+			clearCache();
 			_device->seek(_infoOffset);
 		}
 		return _infoOffset > 0;
@@ -46,8 +48,21 @@ bool ApngReader::init(QIODevice *device)
 	else
 		return false;
 
-	// clear cached frames
-	_allFrames.clear();
+	// restarting keeps the frame delays, but a new image starts from scratch
+	_delaysMsec.clear();
+	_peakCacheBytes = 0;
+
+	// without seeking back, dropped frames could not be decoded again
+	_streamStart = _device->pos();
+	if (_device->isSequential())
+		_cacheBudget = 0;
+
+	return startDecoding();
+}
+
+bool ApngReader::startDecoding()
+{
+	resetDecoder();
 
 	//init png structs
 	_png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
@@ -79,6 +94,53 @@ bool ApngReader::init(QIODevice *device)
 	return _infoOffset > 0;
 }
 
+bool ApngReader::restart()
+{
+	if (!_device->seek(_streamStart))
+		return false;
+	return startDecoding();
+}
+
+void ApngReader::resetDecoder()
+{
+	if(_png)
+		png_destroy_read_struct(&_png, &_info, nullptr);
+
+	if (_frame.rows)
+		delete[] _frame.rows;
+	if (_frame.p)
+		delete[] _frame.p;
+	_frame = Frame{};
+
+	_infoOffset = 0;
+	_nextFrame = 0;
+	clearCache();
+}
+
+void ApngReader::clearCache()
+{
+	_cache.clear();
+	_cacheBytes = 0;
+}
+
+void ApngReader::storeFrame(const ApngFrame &frame)
+{
+	const int index = _nextFrame++;
+	if (index >= _delaysMsec.size())
+		_delaysMsec.append(frame.delayMsec());
+
+	_cache.insert(index, frame);
+	_cacheBytes += frame.sizeInBytes();
+	_peakCacheBytes = qMax(_peakCacheBytes, _cacheBytes);
+
+	// drop the oldest frames, but always keep the newest one
+	while (_cacheBudget > 0 && _cacheBytes > _cacheBudget && _cache.size() > 1) {
+		auto oldest = _cache.begin();
+		_cacheBytes -= oldest->sizeInBytes();
+		_cache.erase(oldest);
+	}
+}
+
 ApngReader::ApngFrame ApngReader::readFrame(quint32 index)
 {
 	return readFrame(static_cast<int>(index));
@@ -86,8 +148,16 @@ ApngReader::ApngFrame ApngReader::readFrame(quint32 index)
 
 ApngReader::ApngFrame ApngReader::readFrame(int index)
 {
-	if(index < _allFrames.size())
-		return _allFrames[index];
+	if (index < 0)
+		return {};
+
+	auto cached = _cache.constFind(index);
+	if (cached != _cache.constEnd())
+		return *cached;
+
+	// the frame was dropped already, decode the stream again from the start
+	if (index < _nextFrame && !restart())
+		return {};
 
 	if (setjmp(png_jmpbuf(_png)))
 		return {};
@@ -95,12 +165,36 @@ ApngReader::ApngFrame ApngReader::readFrame(int index)
 	auto valid = false;
 	do {
 		valid = readChunk();
-	} while(valid && index >= _allFrames.size());
+	} while(valid && index >= _nextFrame);
 
-	if(index < _allFrames.size())
-		return _allFrames[index];
-	else
-		return {};
+	return _cache.value(index);
+}
+
+int ApngReader::frameDelayMsec(quint32 index)
+{
+	if (index < static_cast<quint32>(_delaysMsec.size()))
+		return _delaysMsec.at(static_cast<int>(index));
+	return readFrame(index).delayMsec();
+}
+
+void ApngReader::setCacheBudget(qint64 bytes)
+{
+	_cacheBudget = qMax(Q_INT64_C(0), bytes);
+}
+
+qint64 ApngReader::cacheBudget() const
+{
+	return _cacheBudget;
+}
+
+qint64 ApngReader::cacheBytes() const
+{
+	return _cacheBytes;
+}
+
+qint64 ApngReader::peakCacheBytes() const
+{
+	return _peakCacheBytes;
 }
 
 bool ApngReader::isAnimated() const
@@ -191,7 +285,7 @@ void ApngReader::end_fn(png_structp png_ptr, png_infop info_ptr)
 
 	if(!reader->_animated) {
 		reader->copyOver();
-		reader->_allFrames.append(reader->_lastImg);
+		reader->storeFrame(reader->_lastImg);
 	}
 
 	if (frame.rows) {
@@ -246,7 +340,7 @@ void ApngReader::frame_end_fn(png_structp png_ptr, png_uint_32 frame_num)
 	else
 		reader->copyOver();
 
-	reader->_allFrames.append({image, frame.delay_num, frame.delay_den});
+	reader->storeFrame({image, frame.delay_num, frame.delay_den});
 
 	if (frame.dop == PNG_DISPOSE_OP_PREVIOUS)
 		image = temp;
@@ -5,6 +5,8 @@
 #include <QIODevice>
 #include <png.h>
 #include <QImage>
+#include <QMap>
+#include <QVector>
 
 #ifndef PNG_APNG_SUPPORTED
 #error libpng with APNG patch is required
@@ -37,6 +39,14 @@ public:
 	bool init(QIODevice *device);
 	ApngFrame readFrame(quint32 index);
 	ApngFrame readFrame(int index);
+	int frameDelayMsec(quint32 index);
+
+	// Composited frames are kept up to this many bytes, older ones are
+	// decoded again when needed. 0 keeps every frame.
+	void setCacheBudget(qint64 bytes);
+	qint64 cacheBudget() const;
+	qint64 cacheBytes() const;
+	qint64 peakCacheBytes() const;
 
 	bool isAnimated() const;
 	QSize size() const;
@@ -50,6 +60,7 @@ private:
 	png_infop _info = nullptr;
 
 	//image info
+	qint64 _streamStart = 0;
 	qint64 _infoOffset = 0;
 	bool _animated = false;
 	bool _skipFirst = false;
@@ -76,7 +87,14 @@ private:
 
 	QImage _lastImg;
 
-	QList<ApngFrame> _allFrames;
+	QMap<int, ApngFrame> _cache;
+	QVector<int> _delaysMsec;
+	int _nextFrame = 0;
+	qint64 _cacheBudget = defaultCacheBudget();
+	qint64 _cacheBytes = 0;
+	qint64 _peakCacheBytes = 0;
+
+	static qint64 defaultCacheBudget();
 
 	static void info_fn(png_structp png_ptr, png_infop info_ptr);
 	static void row_fn(png_structp png_ptr, png_bytep new_row, png_uint_32 row_num, int pass);
@@ -85,6 +103,12 @@ private:
 	static void frame_info_fn(png_structp png_ptr, png_uint_32 frame_num);
 	static void frame_end_fn(png_structp png_ptr, png_uint_32 frame_num);
 
+	bool startDecoding();
+	bool restart();
+	void resetDecoder();
+	void clearCache();
+	void storeFrame(const ApngFrame &frame);
+
 	bool readChunk(quint32 len = 0);
 	void copyOver();
 	void blendOver();